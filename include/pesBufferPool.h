@@ -0,0 +1,72 @@
+/**
+ * @file pesBufferPool.h
+ * @brief Size-classed pool of PES assembly buffers shared by several assemblers
+ *
+ * Buffers are grouped in power-of-two size classes starting at 1 KiB. A released
+ * buffer is kept on the free list of its class and handed out again by the next
+ * Acquire() of that class, so a steady stream of PES units is assembled without
+ * touching the heap once every class in use holds enough buffers.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <vector>
+
+/**
+ * @class xPES_BufferPool
+ * @brief Free lists of assembly buffers in power-of-two size classes
+ *
+ * Requests above the largest class are served directly from the heap and freed on
+ * Release(). The pool is not thread safe; it must outlive every assembler using it.
+ */
+class xPES_BufferPool
+{
+public:
+  /** @brief Capacity of the smallest size class (1 KiB) */
+  static constexpr uint32_t MinClassSize = 1024;
+
+  /** @brief Number of size classes (1 KiB ... 16 MiB) */
+  static constexpr uint32_t NumClasses   = 15;
+
+protected:
+  std::vector<uint8_t*> m_FreeLists[NumClasses]; ///< Released buffers per size class
+
+  // === Statistics ===
+  uint64_t m_NumAllocations;  ///< Buffers obtained from the heap
+  uint64_t m_NumReuses;       ///< Acquire() calls served from a free list
+
+public:
+  xPES_BufferPool() : m_NumAllocations(0), m_NumReuses(0) {}
+  ~xPES_BufferPool();
+
+  /**
+   * @brief Get a buffer of at least MinSize bytes
+   * @param MinSize  Requested size in bytes
+   * @param Capacity Receives the actual buffer capacity (class size)
+   * @return Buffer, or nullptr if the allocation failed
+   */
+  uint8_t* Acquire(uint32_t MinSize, uint32_t& Capacity);
+
+  /**
+   * @brief Return a buffer obtained from Acquire()
+   * @param Buffer   Buffer to return (nullptr is ignored)
+   * @param Capacity Capacity reported by Acquire()
+   */
+  void     Release(uint8_t* Buffer, uint32_t Capacity);
+
+  /** @brief Get number of buffers obtained from the heap */
+  uint64_t getNumAllocations() const { return m_NumAllocations; }
+
+  /** @brief Get number of requests served from a free list */
+  uint64_t getNumReuses() const { return m_NumReuses; }
+
+  /** @brief Get capacity of the size class serving MinSize bytes (0 if above all classes) */
+  static uint32_t getClassSize(uint32_t MinSize);
+
+protected:
+  static int32_t xGetClassIdx(uint32_t Capacity);
+};
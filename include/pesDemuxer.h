@@ -0,0 +1,147 @@
+/**
+ * @file pesDemuxer.h
+ * @brief Single pass PES assembly for all elementary streams of a multiplex
+ *
+ * xPES_Assembler follows exactly one PID. xPES_Demuxer keeps one assembler per active
+ * PID, so a whole multiplex is assembled in a single pass over the input. Completed
+ * PES units are handed to a user callback.
+ *
+ * PID lookup uses a flat table of 8192 slot indices (one per 13-bit PID, 16 KiB,
+ * cache line aligned). Assemblers are created only when a PID becomes active, so the
+ * remaining memory is proportional to the number of active PIDs.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+#include "pesParse.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+/**
+ * @class xPES_Demuxer
+ * @brief Routes TS packets to per-PID PES assemblers and reports completed PES units
+ *
+ * PIDs are activated explicitly with AddPID(), or automatically (setAutoAdd(true))
+ * when a packet with payload_unit_start_indicator carries a PES start code prefix.
+ *
+ * A PES unit is reported through the callback when:
+ * - a bounded unit (PES_packet_length > 0) is complete (AssemblingFinished), or
+ * - an unbounded unit (PES_packet_length = 0, typical for video) is followed by the
+ *   next payload_unit_start_indicator on its PID, or the input ends (Flush()).
+ */
+class xPES_Demuxer
+{
+public:
+  /** @brief Number of possible PID values (13 bits) */
+  static constexpr uint32_t NumPIDs = 8192;
+
+  /**
+   * @brief Callback invoked for every completed PES unit
+   * @param PID       PID carrying the unit
+   * @param Assembler Assembler holding the unit (header in m_PESH, data in getPacket())
+   */
+  typedef std::function<void(int32_t PID, const xPES_Assembler& Assembler)> tUnitCallback;
+
+protected:
+  /** @brief Per PID assembly state */
+  struct xEntry
+  {
+    xPES_Assembler Assembler;     ///< PES assembler for the PID
+    bool           Pending;       ///< Started unbounded unit not reported yet
+    uint64_t       NumUnits;      ///< Reported PES units
+  };
+
+  alignas(64) uint16_t m_SlotIdx[NumPIDs];   ///< PID -> index into m_Entries + 1 (0 = inactive)
+  std::vector<std::unique_ptr<xEntry>> m_Entries; ///< Active PIDs, in activation order
+  tUnitCallback    m_Callback;               ///< Completed unit consumer (may be empty)
+  xPES_BufferPool* m_BufferPool;             ///< Buffer pool handed to new assemblers (may be null)
+  bool             m_ZeroCopy;               ///< New assemblers collect payload slices
+  bool             m_AutoAdd;                ///< Activate PIDs on first PES start
+  uint64_t         m_NumUnits;               ///< Reported PES units (all PIDs)
+
+public:
+  xPES_Demuxer();
+
+  /**
+   * @brief Deactivate all PIDs and clear statistics
+   */
+  void Reset();
+
+  /**
+   * @brief Activate PES assembly for a PID
+   * @param PID Packet identifier (0-8191)
+   * @return True if the PID is active after the call
+   */
+  bool AddPID(int32_t PID);
+
+  /** @brief Enable or disable automatic activation of PIDs carrying PES */
+  void setAutoAdd(bool AutoAdd) { m_AutoAdd = AutoAdd; }
+
+  /**
+   * @brief Share a buffer pool between the assemblers of PIDs activated later
+   * @param BufferPool Pool (must outlive the demuxer), nullptr for private buffers
+   */
+  void setBufferPool(xPES_BufferPool* BufferPool) { m_BufferPool = BufferPool; }
+
+  /** @brief Select zero-copy (slice) mode for assemblers of PIDs activated later */
+  void setZeroCopy(bool ZeroCopy) { m_ZeroCopy = ZeroCopy; }
+
+  /** @brief Set completed unit callback */
+  void setCallback(tUnitCallback Callback) { m_Callback = std::move(Callback); }
+
+  /**
+   * @brief Check whether packets of a PID are processed by AbsorbPacket()
+   * @return True if the PID is active, or may become active in auto mode
+   */
+  bool isInterested(uint16_t PID) const { return m_SlotIdx[PID] != 0 || (m_AutoAdd && PID != (uint16_t)xTS_PacketHeader::ePID::NuLL); }
+
+  /**
+   * @brief Route a TS packet to the assembler of its PID
+   *
+   * @param TransportStreamPacket Pointer to complete 188-byte TS packet
+   * @param PacketHeader          Parsed TS packet header
+   * @param AdaptationField       Parsed adaptation field
+   * @param Block                 Reference to the input block holding the packet (zero-copy mode)
+   * @return Assembler result, UnexpectedPID if the PID is not active
+   */
+  xPES_Assembler::eResult AbsorbPacket(const uint8_t* TransportStreamPacket,
+                                       const xTS_PacketHeader* PacketHeader,
+                                       const xTS_AdaptationField* AdaptationField,
+                                       const xBlockRef* Block = nullptr);
+
+  /**
+   * @brief Report unbounded units still being assembled (call at end of input)
+   */
+  void Flush();
+
+  /**
+   * @brief Get assembler of an active PID
+   * @return Assembler, or nullptr if the PID is not active
+   */
+  const xPES_Assembler* getAssembler(uint16_t PID) const { return m_SlotIdx[PID] ? &m_Entries[m_SlotIdx[PID] - 1]->Assembler : nullptr; }
+
+  /** @brief Get number of active PIDs */
+  uint32_t getNumActivePIDs() const { return static_cast<uint32_t>(m_Entries.size()); }
+
+  /** @brief Get PID of the Idx-th activated stream */
+  int32_t  getActivePID(uint32_t Idx) const { return m_Entries[Idx]->Assembler.getPID(); }
+
+  /** @brief Get number of reported units of the Idx-th activated stream */
+  uint64_t getNumUnits(uint32_t Idx) const { return m_Entries[Idx]->NumUnits; }
+
+  /** @brief Get number of reported units of all streams */
+  uint64_t getNumUnits() const { return m_NumUnits; }
+
+  /** @brief Get number of assembly buffer allocations of all streams */
+  uint64_t getNumBufferAllocations() const;
+
+protected:
+  void xReportUnit(xEntry& Entry);
+  static bool xStartsPES(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField);
+};
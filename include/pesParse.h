@@ -21,6 +21,8 @@
 #pragma once
 #include "tsCommon.h"
 #include "tsTransportStream.h"
+#include "pesBufferPool.h"
+#include <vector>
 
 /**
  * @class xPES_PacketHeader
@@ -191,6 +193,18 @@ public:
   uint8_t   getPESHeaderDataLength() const { return m_PES_header_data_length; }
 };
 
+/**
+ * @struct xPES_Slice
+ * @brief Contiguous part of a PES packet inside an input block
+ *
+ * Layout matches POSIX struct iovec, so a slice list can be passed to writev() directly.
+ */
+struct xPES_Slice
+{
+  const uint8_t* Data;  ///< Start of the payload range
+  size_t         Size;  ///< Number of bytes
+};
+
 /**
  * @class xPES_Assembler
  * @brief Assembles complete PES packets from multiple Transport Stream packets
@@ -232,9 +246,16 @@ protected:
   int32_t m_PID;               ///< Target PID for packet assembly
   
   // === Buffer management ===
-  uint8_t* m_Buffer;           ///< Assembly buffer for PES packet data
+  uint8_t* m_Buffer;           ///< Assembly buffer for PES packet data (kept between packets)
   uint32_t m_BufferSize;       ///< Total buffer size in bytes
   uint32_t m_DataOffset;       ///< Current data offset in buffer
+  xPES_BufferPool* m_BufferPool; ///< Shared buffer pool (nullptr = private heap buffer)
+
+  // === Zero-copy mode ===
+  bool                    m_ZeroCopy;     ///< Collect payload slices instead of copying payload
+  std::vector<xPES_Slice> m_Slices;       ///< Payload ranges of the current PES packet
+  std::vector<xBlockRef>  m_SliceBlocks;  ///< Blocks referenced by m_Slices (keeps them alive)
+  const xBlockRef*        m_CurrentBlock; ///< Block of the packet being absorbed
   
   // === Assembly state ===
   uint8_t   m_LastContinuityCounter; ///< Last processed continuity counter
@@ -242,6 +263,7 @@ protected:
   
   // === Statistics ===
   uint32_t  m_TotalStuffingBytes;    ///< Total stuffing bytes encountered
+  uint64_t  m_NumAllocations;        ///< Number of times the buffer had to grow
 
 public:
   /**
@@ -268,6 +290,28 @@ public:
    * @param PID Transport Stream Packet Identifier to monitor
    */
   void Init(int32_t PID);
+
+  /**
+   * @brief Draw assembly buffers from a shared pool
+   *
+   * Must be called before the first packet is absorbed. The pool must outlive
+   * the assembler.
+   *
+   * @param BufferPool Pool to use, nullptr for a private heap buffer
+   */
+  void setBufferPool(xPES_BufferPool* BufferPool);
+
+  /**
+   * @brief Select zero-copy mode
+   * 
+   * In zero-copy mode payload is not copied into an assembly buffer. The assembler
+   * records the payload ranges inside the input blocks (getSlices()) and holds a
+   * reference to every block involved, so the ranges stay valid until the next PES
+   * packet starts. getPacket() returns nullptr in this mode.
+   * 
+   * @param ZeroCopy True to collect slices, false to copy payload (default)
+   */
+  void setZeroCopy(bool ZeroCopy) { m_ZeroCopy = ZeroCopy; xBufferReset(); }
   
   /**
    * @brief Process a Transport Stream packet
@@ -278,6 +322,8 @@ public:
    * @param TransportStreamPacket Pointer to complete 188-byte TS packet
    * @param PacketHeader Parsed TS packet header information
    * @param AdaptationField Parsed adaptation field (may be nullptr)
+   * @param Block Reference to the input block holding the packet (zero-copy mode; if
+   *              nullptr the caller guarantees that the block outlives the slices)
    * @return Assembly result indicating current state or error condition
    * 
    * @note Packets with unexpected PID are rejected
@@ -286,7 +332,8 @@ public:
    */
   eResult AbsorbPacket(const uint8_t* TransportStreamPacket, 
                       const xTS_PacketHeader* PacketHeader, 
-                      const xTS_AdaptationField* AdaptationField);
+                      const xTS_AdaptationField* AdaptationField,
+                      const xBlockRef* Block = nullptr);
 
   // === Information access methods ===
   
@@ -297,11 +344,29 @@ public:
    */
   void PrintPESH() const { m_PESH.Print(); }
   
+  /**
+   * @brief Get PID processed by the assembler
+   * @return PID passed to Init()
+   */
+  int32_t getPID() const { return m_PID; }
+
   /**
    * @brief Get assembled packet buffer
    * @return Pointer to internal buffer containing assembled PES packet
    */
   uint8_t* getPacket() const { return m_Buffer; }
+
+  /** @brief Check whether the assembler collects slices instead of copying payload */
+  bool isZeroCopy() const { return m_ZeroCopy; }
+
+  /**
+   * @brief Get payload slices of the assembled packet (zero-copy mode)
+   * @return Slice list covering getNumPacketBytes() bytes in order
+   */
+  const xPES_Slice* getSlices() const { return m_Slices.data(); }
+
+  /** @brief Get number of payload slices (zero-copy mode) */
+  uint32_t getNumSlices() const { return static_cast<uint32_t>(m_Slices.size()); }
   
   /**
    * @brief Get number of bytes in assembled packet
@@ -315,13 +380,29 @@ public:
    */
   uint32_t getTotalStuffingBytes() const { return m_TotalStuffingBytes; }
 
+  /**
+   * @brief Get number of buffer (re)allocations
+   * @return Number of times the assembly buffer was allocated or grown
+   */
+  uint64_t getNumAllocations() const { return m_NumAllocations; }
+
 protected:
   /**
    * @brief Reset internal assembly buffer
    * 
-   * Clears the assembly buffer and resets data offset for new packet assembly.
+   * Resets data offset for new packet assembly. The buffer capacity is kept.
    */
   void xBufferReset();
+
+  /**
+   * @brief Ensure buffer capacity
+   * 
+   * Grows the buffer (preserving its content) to hold at least Size bytes.
+   * 
+   * @param Size Required capacity in bytes
+   * @return True if the buffer holds at least Size bytes
+   */
+  bool xBufferReserve(uint32_t Size);
   
   /**
    * @brief Append data to assembly buffer
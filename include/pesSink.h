@@ -0,0 +1,67 @@
+/**
+ * @file pesSink.h
+ * @brief Elementary stream file output for assembled PES packets
+ *
+ * In zero-copy mode an assembled PES packet is a list of payload slices pointing into
+ * the input blocks; the sink hands that list to writev() directly, so elementary
+ * streams are written without any intermediate copy. Assemblers in copy mode are
+ * written from their assembly buffer.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "pesParse.h"
+#include <cstdio>
+
+/**
+ * @class xPES_FileSink
+ * @brief Writes complete PES packets of one stream to a file
+ */
+class xPES_FileSink
+{
+protected:
+  int         m_FileDescriptor; ///< Output file (POSIX)
+  std::FILE*  m_File;           ///< Output file (platforms without writev)
+  uint64_t    m_NumBytes;       ///< Bytes written
+  uint64_t    m_NumPackets;     ///< PES packets written
+  uint64_t    m_NumCalls;       ///< Write system calls issued
+
+public:
+  xPES_FileSink();
+  ~xPES_FileSink();
+
+  /**
+   * @brief Create (truncate) output file
+   * @param FileName Path of the output file
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /**
+   * @brief Flush and close output file
+   */
+  void Close();
+
+  /**
+   * @brief Write the PES packet currently held by an assembler
+   * @param Assembler Assembler reporting a complete packet
+   * @return True on success
+   */
+  bool Write(const xPES_Assembler& Assembler);
+
+  /** @brief Get number of bytes written */
+  uint64_t getNumBytes() const { return m_NumBytes; }
+
+  /** @brief Get number of PES packets written */
+  uint64_t getNumPackets() const { return m_NumPackets; }
+
+  /** @brief Get number of write system calls */
+  uint64_t getNumCalls() const { return m_NumCalls; }
+
+protected:
+  bool xWriteSlices(const xPES_Slice* Slices, uint32_t NumSlices);
+};
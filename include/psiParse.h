@@ -0,0 +1,308 @@
+/**
+ * @file psiParse.h
+ * @brief Program Specific Information (PSI) section assembly and PAT/PMT parsing
+ *
+ * PSI tables are carried in sections which may start anywhere inside a TS payload
+ * (located by the pointer_field of packets with payload_unit_start_indicator), span
+ * several packets, or share one packet with further sections.
+ *
+ * Long form section header (8 bytes):
+ * ```
+ *   0 | table_id (8) | SSI(1) 0(1) rsv(2) section_length (12) | table_id_extension (16)
+ *   5 | rsv(2) version_number (5) current_next (1) | section_number (8) | last_section_number (8)
+ * ```
+ *
+ * Broadcasters repeat PAT and PMT every 100 ms or so while their content changes
+ * rarely. Every assembler remembers the 8-byte header of each accepted section; a
+ * repetition with an identical header (same table, version_number and length) is
+ * recognised as soon as the header has arrived and is skipped without copying or
+ * parsing the rest of the section.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+#include "tsCRC32.h"
+#include <functional>
+#include <memory>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xPSI_SectionHeader
+ * @brief Common (long form) PSI section header
+ */
+class xPSI_SectionHeader
+{
+public:
+  /** @brief Table identifiers (ISO/IEC 13818-1 Table 2-31) */
+  enum class eTableId : uint8_t
+  {
+    PAT      = 0x00, ///< Program Association Table
+    CAT      = 0x01, ///< Conditional Access Table
+    PMT      = 0x02, ///< Program Map Table
+    Stuffing = 0xFF, ///< Not a section - remainder of the payload is stuffing
+  };
+
+  /** @brief Length of the long form section header */
+  static constexpr uint32_t HeaderLength    = 8;
+  /** @brief Bytes preceding the section_length field value (table_id + length field) */
+  static constexpr uint32_t PrefixLength    = 3;
+  /** @brief Length of CRC_32 closing a long form section */
+  static constexpr uint32_t CRC_Length      = 4;
+  /** @brief Largest section_length of private sections (PSI tables are limited to 1021) */
+  static constexpr uint32_t MaxSectionLength = 4093;
+
+protected:
+  uint8_t  m_TableId;
+  uint8_t  m_SectionSyntaxIndicator;
+  uint16_t m_SectionLength;
+  uint16_t m_TableIdExtension;
+  uint8_t  m_VersionNumber;
+  uint8_t  m_CurrentNextIndicator;
+  uint8_t  m_SectionNumber;
+  uint8_t  m_LastSectionNumber;
+
+public:
+  void Reset();
+
+  /**
+   * @brief Parse section header
+   * @param Section Pointer to the first byte of the section (table_id)
+   * @param Size    Number of available bytes
+   * @return Number of parsed bytes (8, or 3 for short form sections), NOT_VALID if the header is incomplete
+   */
+  int32_t Parse(const uint8_t* Section, uint32_t Size);
+
+  uint8_t  getTableId() const { return m_TableId; }
+  uint8_t  getSectionSyntaxIndicator() const { return m_SectionSyntaxIndicator; }
+  uint16_t getSectionLength() const { return m_SectionLength; }
+  uint16_t getTableIdExtension() const { return m_TableIdExtension; }
+  uint8_t  getVersionNumber() const { return m_VersionNumber; }
+  uint8_t  getCurrentNextIndicator() const { return m_CurrentNextIndicator; }
+  uint8_t  getSectionNumber() const { return m_SectionNumber; }
+  uint8_t  getLastSectionNumber() const { return m_LastSectionNumber; }
+
+  /** @brief Get total section size in bytes (header prefix + section_length) */
+  uint32_t getSectionSize() const { return PrefixLength + m_SectionLength; }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xPSI_SectionAssembler
+ * @brief Assembles complete PSI sections of one PID
+ *
+ * Handles pointer_field, sections spanning several packets, several sections in one
+ * packet, stuffing bytes after the last section, duplicated packets and continuity
+ * errors (the incomplete section is dropped). CRC_32 of long form sections is
+ * verified, corrupted sections are dropped. Complete sections are handed to a
+ * callback which reports whether the section was accepted; only accepted sections
+ * enter the version cache.
+ */
+class xPSI_SectionAssembler
+{
+public:
+  /**
+   * @brief Callback invoked for every complete section which is not a cached repetition
+   * @param PID     PID carrying the section
+   * @param Section Section bytes, starting with table_id
+   * @param Size    Section size (3 + section_length)
+   * @return True if the section was valid and its header may be cached
+   */
+  typedef std::function<bool(int32_t PID, const uint8_t* Section, uint32_t Size)> tSectionCallback;
+
+protected:
+  int32_t               m_PID;
+  std::vector<uint8_t>  m_Section;        ///< Section being assembled
+  uint32_t              m_SectionSize;    ///< Expected section size, 0 until the length field arrived
+  uint32_t              m_NumReceived;    ///< Bytes of the current section received so far
+  bool                  m_Started;        ///< Section assembly in progress
+  bool                  m_Skip;           ///< Current section is a cached repetition - bytes are counted, not copied
+  int8_t                m_LastCC;         ///< Continuity counter of the last payload packet (NOT_VALID before first)
+  std::vector<uint64_t> m_HeaderCache;    ///< Raw 8-byte headers of accepted sections
+  tSectionCallback      m_Callback;
+  xTS_CRC32             m_CRC32;          ///< CRC_32 verification engine
+  uint64_t              m_NumSections;    ///< Sections handed to the callback
+  uint64_t              m_NumCRCErrors;   ///< Sections dropped because of CRC_32 mismatch
+  uint64_t              m_NumSkipped;     ///< Repetitions skipped after the header compare
+  uint64_t              m_NumDropped;     ///< Incomplete or malformed sections dropped
+
+public:
+  xPSI_SectionAssembler();
+
+  /**
+   * @brief Initialize assembler for a PID, clears the version cache
+   */
+  void Init(int32_t PID);
+
+  /** @brief Set complete section callback */
+  void setCallback(tSectionCallback Callback) { m_Callback = std::move(Callback); }
+
+  /**
+   * @brief Process TS packet of the assembler's PID
+   * @param TransportStreamPacket Pointer to complete 188-byte TS packet
+   * @param PacketHeader          Parsed TS packet header
+   * @param AdaptationField       Parsed adaptation field
+   */
+  void AbsorbPacket(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField);
+
+  /** @brief Forget cached section headers (forces the next repetition to be parsed) */
+  void InvalidateCache() { m_HeaderCache.clear(); }
+
+  int32_t  getPID() const { return m_PID; }
+  uint64_t getNumSections() const { return m_NumSections; }
+  uint64_t getNumSkipped() const { return m_NumSkipped; }
+  uint64_t getNumDropped() const { return m_NumDropped; }
+  uint64_t getNumCRCErrors() const { return m_NumCRCErrors; }
+
+protected:
+  void xAbort();
+  void xFeed(const uint8_t* Data, uint32_t Size, bool CanStart);
+  void xComplete();
+  bool xIsCached() const;
+  void xCacheHeader();
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xPSI_PAT
+ * @brief Program Association Table section (program_number -> PMT PID)
+ */
+class xPSI_PAT
+{
+public:
+  struct xProgram
+  {
+    uint16_t ProgramNumber; ///< 0 denotes the network PID
+    uint16_t PID;           ///< PMT PID (network_PID for program 0)
+  };
+
+protected:
+  xPSI_SectionHeader    m_Header;
+  std::vector<xProgram> m_Programs;
+
+public:
+  /**
+   * @brief Parse complete PAT section
+   * @return Number of programs, NOT_VALID if the section is not a PAT or is malformed
+   */
+  int32_t Parse(const uint8_t* Section, uint32_t Size);
+
+  const xPSI_SectionHeader&    getHeader() const { return m_Header; }
+  uint16_t                     getTransportStreamId() const { return m_Header.getTableIdExtension(); }
+  const std::vector<xProgram>& getPrograms() const { return m_Programs; }
+};
+
+/**
+ * @class xPSI_PMT
+ * @brief Program Map Table section (PCR PID and elementary streams of one program)
+ */
+class xPSI_PMT
+{
+public:
+  struct xStream
+  {
+    uint8_t  StreamType;    ///< stream_type (ISO/IEC 13818-1 Table 2-34)
+    uint16_t PID;           ///< elementary_PID
+  };
+
+protected:
+  xPSI_SectionHeader   m_Header;
+  uint16_t             m_PCR_PID;
+  std::vector<xStream> m_Streams;
+
+public:
+  /**
+   * @brief Parse complete PMT section
+   * @return Number of elementary streams, NOT_VALID if the section is not a PMT or is malformed
+   */
+  int32_t Parse(const uint8_t* Section, uint32_t Size);
+
+  const xPSI_SectionHeader&   getHeader() const { return m_Header; }
+  uint16_t                    getProgramNumber() const { return m_Header.getTableIdExtension(); }
+  uint16_t                    getPCR_PID() const { return m_PCR_PID; }
+  const std::vector<xStream>& getStreams() const { return m_Streams; }
+
+  /**
+   * @brief Check whether a stream type is carried in PES packets
+   * @return False for private sections (0x05) and DSM-CC sections (0x0A-0x0D)
+   */
+  static bool isPES(uint8_t StreamType);
+
+  /** @brief Get readable stream type name */
+  static const char* getStreamTypeName(uint8_t StreamType);
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xPSI_ProgramTracker
+ * @brief Follows PAT and PMTs of a multiplex and reports program structure changes
+ *
+ * Starts with the PAT PID only; PMT PIDs are activated as the PAT lists them. Every
+ * new or changed PAT/PMT section is parsed and reported through the callbacks, so a
+ * consumer learns programs, PCR PIDs and elementary streams without prior knowledge
+ * of the multiplex.
+ */
+class xPSI_ProgramTracker
+{
+public:
+  static constexpr uint32_t NumPIDs = 8192;
+
+  typedef std::function<void(const xPSI_PAT& PAT)>               tPATCallback;
+  typedef std::function<void(int32_t PID, const xPSI_PMT& PMT)>  tPMTCallback;
+
+protected:
+  alignas(64) uint16_t m_SlotIdx[NumPIDs];      ///< PID -> index into m_Assemblers + 1 (0 = not PSI)
+  std::vector<std::unique_ptr<xPSI_SectionAssembler>> m_Assemblers;
+  std::vector<xPSI_PMT> m_PMTs;                 ///< Latest PMT of each program, in discovery order
+  xPSI_PAT              m_PAT;
+  xPSI_PMT              m_PMT;
+  tPATCallback          m_PATCallback;
+  tPMTCallback          m_PMTCallback;
+  uint64_t              m_NumInvalid;           ///< Sections rejected by the table parsers
+
+public:
+  xPSI_ProgramTracker();
+
+  /**
+   * @brief Clear all discovered programs, follow the PAT PID only
+   */
+  void Reset();
+
+  void setPATCallback(tPATCallback Callback) { m_PATCallback = std::move(Callback); }
+  void setPMTCallback(tPMTCallback Callback) { m_PMTCallback = std::move(Callback); }
+
+  /** @brief Check whether a PID carries PAT or a known PMT */
+  bool isInterested(uint16_t PID) const { return m_SlotIdx[PID] != 0; }
+
+  /**
+   * @brief Process TS packet of a PSI PID
+   * @param TransportStreamPacket Pointer to complete 188-byte TS packet
+   * @param PacketHeader          Parsed TS packet header
+   * @param AdaptationField       Parsed adaptation field
+   */
+  void AbsorbPacket(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField);
+
+  /** @brief Get latest PMT of each discovered program */
+  const std::vector<xPSI_PMT>& getPMTs() const { return m_PMTs; }
+
+  /** @brief Get number of elementary streams of all discovered programs */
+  uint32_t getNumStreams() const;
+
+  uint64_t getNumSections() const;
+  uint64_t getNumSkipped() const;
+  uint64_t getNumCRCErrors() const;
+  uint64_t getNumInvalid() const { return m_NumInvalid; }
+
+protected:
+  void xAddPID(int32_t PID);
+  bool xOnSection(int32_t PID, const uint8_t* Section, uint32_t Size);
+};
@@ -0,0 +1,144 @@
+/**
+ * @file tsBitrate.h
+ * @brief Per-PID and multiplex bitrate over PCR timed windows
+ *
+ * Time base: the PCRs of the first PID carrying PCRs. Packets are counted per PID
+ * between PCRs of that PID; a window closes at the first PCR at least Window ms after
+ * its start, so every window spans an exact PCR interval and
+ * bitrate = packets * 188 * 8 / (PCR delta / 27 MHz).
+ *
+ * Windows form NumLevels levels, each LevelFactor times longer than the previous one
+ * (100 ms / 1 s / 10 s by default). Closed windows of a level are summed into the next
+ * one until that reaches its length, so the per packet cost is a single counter
+ * increment (and a flag test for the PCR).
+ * The last RingSize windows of every level are kept in ring buffers for live queries;
+ * closed windows are written to a text time series, one row per window listing only the
+ * PIDs present in it.
+ *
+ * PCR discontinuities (flagged, backward or over MaxPCRGap) drop the window in progress.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsRecordFile.h"
+#include "tsPCRAnalyzer.h"
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_BitrateMeter
+ * @brief Windowed per-PID bitrate measurement on the PCR time line
+ */
+class xTS_BitrateMeter
+{
+public:
+  static constexpr uint32_t NumPIDs       = 8192;
+  static constexpr uint32_t NumLevels     = 3;
+  static constexpr uint32_t LevelFactor   = 10;    ///< Length of a level's windows relative to the previous level
+  static constexpr uint32_t DefaultWindow = 100;   ///< Shortest window [ms]
+  static constexpr uint32_t RingSize      = 64;    ///< Windows kept per level
+  static constexpr uint32_t MaxPCRGap     = 100;   ///< Larger PCR steps are discontinuities [ms]
+
+  /** @brief Closed window */
+  struct xWindow
+  {
+    uint64_t Start      = 0;   ///< Time since the first PCR [27 MHz]
+    uint64_t Duration   = 0;   ///< [27 MHz]
+    uint64_t NumPackets = 0;
+    std::vector<std::pair<uint16_t, uint32_t>> PIDs; ///< PID, packets (PIDs present in the window)
+
+    /** @brief Get bitrate of a packet count [bit/s] */
+    double getBitrate(uint64_t Packets) const { return Duration ? static_cast<double>(Packets) * 188 * 8 * 27e6 / static_cast<double>(Duration) : 0; }
+    double getBitrate() const { return getBitrate(NumPackets); }
+  };
+
+protected:
+  /** @brief Windows of one level - counters of the window in progress and the ring of closed ones */
+  struct xLevel
+  {
+    uint32_t             Counts[NumPIDs]; ///< Packets per PID of the window in progress
+    uint64_t             Start      = 0;
+    uint64_t             Duration   = 0;
+    uint32_t             NumParts   = 0;  ///< Windows of the previous level summed so far
+    uint64_t             NumWindows = 0;  ///< Closed windows (ring: the last RingSize of them)
+    std::vector<xWindow> Ring;
+    xTS_RunningStats     Total;           ///< Multiplex bitrate of closed windows [bit/s]
+  };
+
+  // === Configuration ===
+  std::FILE*             m_File;
+  uint64_t               m_Window;           ///< Shortest window [27 MHz]
+
+  // === Time base ===
+  int32_t                m_RefPID;           ///< PID whose PCRs time the windows (NOT_VALID until the first PCR)
+  uint64_t               m_RefPCR;           ///< Last PCR of m_RefPID
+  uint64_t               m_Now;              ///< Time of that PCR since the first PCR (discontinuities do not step it)
+  uint64_t               m_NumDropped;       ///< Windows dropped at PCR discontinuities
+
+  // === Counters ===
+  std::vector<xLevel>    m_Levels;
+  uint64_t               m_Total[NumPIDs];   ///< Packets per PID of all closed shortest windows
+  uint64_t               m_TotalDuration;    ///< Duration of all closed shortest windows [27 MHz]
+
+public:
+  xTS_BitrateMeter();
+  ~xTS_BitrateMeter();
+
+  /**
+   * @brief Start measuring a stream
+   * @param FileName Time series path (nullptr: statistics only)
+   * @param Window   Shortest window [ms]
+   * @return True on success
+   */
+  bool Open(const char* FileName, uint32_t Window = DefaultWindow);
+
+  /**
+   * @brief Close the time series (the window in progress has no closing PCR and is not written)
+   * @return True if the time series was written completely
+   */
+  bool Close();
+
+  /** @brief Push the time series rows to the file (live input) */
+  bool Flush() { return m_File == nullptr || std::fflush(m_File) == 0; }
+
+  /**
+   * @brief Count a packet record
+   * @param Record Packet record
+   */
+  void AddPacket(const xTS_PacketRecord& Record)
+  {
+    if(Record.hasPCR() && (Record.PID == m_RefPID || m_RefPID == NOT_VALID)) xAddPCR(Record);
+    m_Levels[0].Counts[Record.PID]++;
+  }
+
+  int32_t  getRefPID    () const { return m_RefPID; }
+  uint64_t getNumDropped() const { return m_NumDropped; }
+  uint64_t getNumWindows(uint32_t Level) const { return m_Levels[Level].NumWindows; }
+
+  /** @brief Get nominal window length of a level [ms] */
+  uint64_t getWindowLength(uint32_t Level) const;
+
+  /** @brief Get multiplex bitrate statistics of the closed windows of a level [bit/s] */
+  const xTS_RunningStats& getTotalStats(uint32_t Level) const { return m_Levels[Level].Total; }
+
+  /**
+   * @brief Get a closed window from the ring
+   * @param Level Window level
+   * @param Age   0 for the latest window, up to min(getNumWindows(Level), RingSize) - 1
+   */
+  const xWindow& getWindow(uint32_t Level, uint32_t Age) const;
+
+  /** @brief Get mean bitrate of a PID over all closed shortest windows [bit/s] */
+  double getMeanBitrate(uint16_t PID) const;
+
+protected:
+  void xAddPCR     (const xTS_PacketRecord& Record);
+  void xCloseWindow(uint32_t Level);
+};
@@ -0,0 +1,84 @@
+/**
+ * @file tsCRC32.h
+ * @brief CRC32/MPEG-2 calculation (PSI section CRC_32)
+ *
+ * CRC32/MPEG-2 parameters: polynomial 0x04C11DB7, initial value 0xFFFFFFFF, input and
+ * output not reflected, no final XOR. A section is intact when the CRC over the whole
+ * section including its CRC_32 field equals 0.
+ *
+ * Kernels:
+ * - Bytewise:  one 256-entry table lookup per byte (reference).
+ * - Slicing8:  eight 256-entry tables, 8 bytes per iteration.
+ * - PCLMUL:    carry-less multiplication folding of four 128-bit lanes (64 bytes per
+ *              iteration), final 16 bytes and tail reduced with Slicing8 tables.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+
+/**
+ * @class xTS_CRC32
+ * @brief CRC32/MPEG-2 engine with runtime kernel selection
+ */
+class xTS_CRC32
+{
+public:
+  /** @brief CRC register value at the start of a section */
+  static constexpr uint32_t InitialValue = 0xFFFFFFFF;
+
+  /** @brief Generator polynomial (x^32 term implicit) */
+  static constexpr uint32_t Polynomial   = 0x04C11DB7;
+
+  /**
+   * @enum eKernel
+   * @brief Implementation of the CRC kernel
+   */
+  enum class eKernel : int32_t
+  {
+    Auto   = 0,  ///< Best kernel supported by the CPU
+    Bytewise  ,  ///< 1 byte per table lookup
+    Slicing8  ,  ///< 8 bytes per iteration
+    PCLMUL    ,  ///< 64 bytes per iteration (carry-less multiplication)
+  };
+
+protected:
+  eKernel m_Kernel;
+
+public:
+  /**
+   * @brief Constructor
+   * @param Kernel CRC kernel (Auto selects the fastest supported one)
+   */
+  explicit xTS_CRC32(eKernel Kernel = eKernel::Auto);
+
+  /**
+   * @brief Calculate CRC of a buffer
+   * @param Data Input bytes
+   * @param Size Number of bytes
+   * @param CRC  CRC register value to continue from (InitialValue for a new calculation)
+   * @return CRC register value after the last byte
+   */
+  uint32_t Calculate(const uint8_t* Data, size_t Size, uint32_t CRC = InitialValue) const;
+
+  /**
+   * @brief Check CRC_32 of a complete section
+   * @param Section Section bytes including the trailing CRC_32 field
+   * @param Size    Section size
+   * @return True if the section is intact
+   */
+  bool Verify(const uint8_t* Section, size_t Size) const { return Size >= 4 && Calculate(Section, Size) == 0; }
+
+  /** @brief Get selected kernel */
+  eKernel getKernel() const { return m_Kernel; }
+
+  /** @brief Get readable name of the selected kernel */
+  const char* getKernelName() const;
+
+  static uint32_t CalculateBytewise(const uint8_t* Data, size_t Size, uint32_t CRC);
+  static uint32_t CalculateSlicing8(const uint8_t* Data, size_t Size, uint32_t CRC);
+  static uint32_t CalculatePCLMUL  (const uint8_t* Data, size_t Size, uint32_t CRC);
+};
@@ -4,6 +4,7 @@
 #include <cfloat>
 #include <climits>
 #include <cstddef>
+#include <memory>
 
 #define NOT_VALID  -1
 
@@ -33,3 +34,44 @@ static inline  int64_t xSwapBytes64( int64_t Value) { return __builtin_bswap64(V
 #else
 #error Unrecognized compiler
 #endif
+
+//=============================================================================================================================================================================
+// CPU features (runtime dispatch of SIMD kernels)
+//=============================================================================================================================================================================
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define X_ARCH_X86 1
+#define X_ATTR_TARGET(Target) __attribute__((target(Target)))
+static inline bool xCpuHasSSE2  () { return __builtin_cpu_supports("sse2"  ); }
+static inline bool xCpuHasSSE41 () { return __builtin_cpu_supports("sse4.1"); }
+static inline bool xCpuHasAVX2  () { return __builtin_cpu_supports("avx2"  ); }
+static inline bool xCpuHasPCLMUL() { return __builtin_cpu_supports("pclmul") && __builtin_cpu_supports("ssse3"); }
+static inline uint32_t xCountTrailingZeros32(uint32_t Value) { return __builtin_ctz(Value); }
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_AMD64) || defined(_M_IX86))
+#define X_ARCH_X86 1
+#define X_ATTR_TARGET(Target)
+static inline bool xCpuHasSSE2  () { int Regs[4]; __cpuid(Regs, 1); return (Regs[3] & (1 << 26)) != 0; }
+static inline bool xCpuHasSSE41 () { int Regs[4]; __cpuid(Regs, 1); return (Regs[2] & (1 << 19)) != 0; }
+static inline bool xCpuHasPCLMUL() { int Regs[4]; __cpuid(Regs, 1); return (Regs[2] & (1 << 1)) != 0 && (Regs[2] & (1 << 9)) != 0; }
+static inline bool xCpuHasAVX2  ()
+{
+  int Regs[4]; __cpuid(Regs, 1);
+  if((Regs[2] & (1 << 27)) == 0 || (_xgetbv(0) & 0x6) != 0x6) return false; // OSXSAVE + YMM state enabled
+  __cpuidex(Regs, 7, 0); return (Regs[1] & (1 << 5)) != 0;
+}
+static inline uint32_t xCountTrailingZeros32(uint32_t Value) { unsigned long Index; _BitScanForward(&Index, Value); return Index; }
+#else
+#define X_ARCH_X86 0
+#define X_ATTR_TARGET(Target)
+static inline bool xCpuHasSSE2  () { return false; }
+static inline bool xCpuHasSSE41 () { return false; }
+static inline bool xCpuHasAVX2  () { return false; }
+static inline bool xCpuHasPCLMUL() { return false; }
+static inline uint32_t xCountTrailingZeros32(uint32_t Value) { uint32_t Count = 0; while(!(Value & 1)) { Value >>= 1; Count++; } return Count; }
+#endif
+
+//=============================================================================================================================================================================
+// Block references (zero-copy consumers of input blocks)
+//=============================================================================================================================================================================
+
+/** @brief Shared ownership of an input block - keeps the referenced bytes valid and unmodified while held */
+typedef std::shared_ptr<const uint8_t> xBlockRef;
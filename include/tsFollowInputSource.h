@@ -0,0 +1,76 @@
+/**
+ * @file tsFollowInputSource.h
+ * @brief Input source following a file which is still being written (like tail -f)
+ *
+ * Recorders append to their capture files continuously. Instead of parsing such a file
+ * again from the start on every check, this source keeps reading it: when the reader
+ * reaches the current end of the file it waits for the file to grow (inotify on Linux,
+ * periodic polling elsewhere) and continues with the appended bytes. The parser keeps
+ * all its state (sync lock, continuity counters, PES assemblers, indexes) across waits,
+ * so the cost of monitoring is proportional to the new data.
+ *
+ * Before every wait the idle callback is invoked, which lets the application flush its
+ * output and indexes so they reflect everything parsed so far.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsInputSource.h"
+
+/**
+ * @class xTS_FollowInputSource
+ * @brief Buffered reader which waits for appended data at the end of the file
+ *
+ * Request() returns fewer bytes than requested only when following stops: after
+ * RequestStop() (e.g. from a signal handler), after the file did not grow for the idle
+ * timeout, or when the file was truncated (see xTS_InputSource::isLive()).
+ */
+class xTS_FollowInputSource : public xTS_BufferedInputSource
+{
+public:
+  /** @brief Longest single wait for a change before the stop flag and timeout are checked [ms] */
+  static constexpr uint32_t PollInterval = 100;
+
+protected:
+  const char*   m_FileName;
+  uint32_t      m_IdleTimeout;     ///< Stop after the file did not grow for this long [s] (0: never)
+  int           m_NotifyFd;        ///< inotify instance watching the file (-1 if not available)
+
+  // === Statistics ===
+  uint64_t      m_NumWaits;        ///< Times the reader caught up with the writer
+  uint64_t      m_NumEvents;       ///< File change notifications received
+
+public:
+  /**
+   * @brief Constructor
+   * @param BlockSize   Size of a single read
+   * @param IdleTimeout Stop after the file did not grow for this many seconds (0: follow until stopped)
+   */
+  xTS_FollowInputSource(size_t BlockSize, uint32_t IdleTimeout);
+  ~xTS_FollowInputSource() override;
+
+  bool        Open(const char* FileName) override;
+  void        Close() override;
+  size_t      Request(size_t MinBytes) override;
+  const char* getName() const override { return m_NotifyFd >= 0 ? "follow+inotify" : "follow"; }
+  bool        isLive() const override { return true; }
+
+  /** @brief Get number of times the reader waited for the writer */
+  uint64_t getNumWaits() const { return m_NumWaits; }
+
+  /** @brief Get number of file change notifications */
+  uint64_t getNumEvents() const { return m_NumEvents; }
+
+protected:
+  /**
+   * @brief Wait until the file grows beyond FileEnd
+   * @return False if following stops
+   */
+  bool xWaitForData(uint64_t FileEnd);
+
+  /** @brief Get current size of the followed file */
+  uint64_t xGetFileSize() const;
+};
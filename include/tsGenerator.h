@@ -0,0 +1,161 @@
+/**
+ * @file tsGenerator.h
+ * @brief Deterministic synthetic Transport Stream generator for load tests and benchmarks
+ *
+ * Produces a single program multiplex of configurable elementary streams: PES packets of
+ * random size (within per-stream bounds) with PTS/DTS, PCRs at most a configured interval
+ * apart on the PCR PID, PAT/PMT repetitions with valid CRC_32, null packets, and optionally adaptation
+ * field stuffing, continuity counter errors and sync loss (garbage bytes between packets).
+ *
+ * All randomness comes from a splitmix64 generator seeded by the configuration, so a
+ * given seed and configuration always produce the same bytes - on every platform and
+ * standard library (std::uniform_*_distribution is implementation defined).
+ *
+ * Time advances by one packet duration at the configured multiplex bitrate per packet;
+ * PCR, PTS and the PSI/PCR schedule follow this clock.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @struct xTS_GeneratorStream
+ * @brief Elementary stream of the generated program
+ */
+struct xTS_GeneratorStream
+{
+  uint16_t PID          = 0x0100;
+  uint8_t  StreamType   = 0x1B;    ///< PMT stream_type (0x1B H.264, 0x0F AAC, 0x06 private data)
+  uint8_t  StreamId     = 0xE0;    ///< PES stream_id (0xE0 video, 0xC0 audio, 0xBD private stream 1)
+  uint32_t Weight       = 1;       ///< Share of the non-PSI, non-null packets
+  uint32_t MinPESSize   = 1024;    ///< Smallest PES payload [bytes]
+  uint32_t MaxPESSize   = 1024;    ///< Largest PES payload [bytes]
+  bool     Bounded      = true;    ///< Write PES_packet_length (false: 0, unbounded video)
+  bool     DTS          = false;   ///< Write DTS next to PTS
+  bool     RandomAccess = false;   ///< Set random_access_indicator on PES starts
+};
+
+/**
+ * @struct xTS_GeneratorConfig
+ * @brief Multiplex layout and impairments
+ */
+struct xTS_GeneratorConfig
+{
+  uint64_t Seed            = 1;
+  uint64_t Bitrate         = 20000000;  ///< Multiplex bitrate [bit/s] (time base of PCR/PTS)
+  std::vector<xTS_GeneratorStream> Streams;
+  int32_t  PCR_PID         = NOT_VALID; ///< PID carrying PCR (NOT_VALID: first stream)
+  uint32_t PCR_Interval    = 40;        ///< Maximum time between PCRs [ms] (0: every packet of the PCR PID)
+  uint32_t PSI_Interval    = 100;       ///< Time between PAT/PMT repetitions [ms] (0: no PSI)
+  uint16_t PMT_PID         = 0x1000;
+  double   NullRate        = 0;         ///< Probability of a null packet (PID 0x1FFF)
+  double   StuffingRate    = 0;         ///< Probability of extra adaptation field stuffing in a stream packet
+  uint32_t MaxStuffing     = 64;        ///< Largest extra stuffing [bytes]
+  double   CC_ErrorRate    = 0;         ///< Probability of a continuity counter jump in a stream packet
+  double   SyncLossRate    = 0;         ///< Probability of garbage bytes before a packet
+  uint32_t MaxSyncLoss     = 1000;      ///< Largest run of garbage bytes
+
+  /** @brief Default multiplex: H.264 video (PID 0x100, PCR) and AAC audio (PID 0x101) */
+  static xTS_GeneratorConfig getDefault();
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_Generator
+ * @brief Emits the packets of a synthetic multiplex one by one
+ */
+class xTS_Generator
+{
+public:
+  /** @brief Largest number of bytes a single Generate() call writes */
+  static constexpr uint32_t MaxOutputSize = xTS::TS_PacketLength + 65535;
+
+protected:
+  struct xStreamState
+  {
+    std::vector<uint8_t> PES;        ///< PES packet being packetized
+    size_t               Offset;     ///< Bytes of PES already packetized
+    uint8_t              CC;
+  };
+
+  xTS_GeneratorConfig       m_Config;
+  std::vector<xStreamState> m_States;
+  uint64_t                  m_RandomState;
+  uint32_t                  m_TotalWeight;
+  int32_t                   m_PCR_Stream;       ///< Index of the stream carrying PCR, NOT_VALID if none
+  uint64_t                  m_Time;             ///< Clock [27 MHz] of the next packet
+  uint64_t                  m_TimeFraction;     ///< Remainder of the packet duration (units of 1/Bitrate ticks)
+  uint64_t                  m_NextPCR;          ///< Deadline of the next PCR (previous PCR + PCR_Interval)
+  uint64_t                  m_NextPSI;          ///< Clock of the next PAT/PMT pair
+  bool                      m_PMT_Pending;      ///< PAT was sent, PMT follows
+  uint8_t                   m_PAT_CC, m_PMT_CC, m_NullCC;
+  uint8_t                   m_PAT[xTS::TS_PacketLength];
+  uint8_t                   m_PMT[xTS::TS_PacketLength];
+
+  // === Statistics ===
+  uint64_t                  m_NumPackets;
+  uint64_t                  m_NumPES;
+  uint64_t                  m_NumNull;
+  uint64_t                  m_NumCC_Errors;
+  uint64_t                  m_NumSyncLosses;
+
+public:
+  xTS_Generator();
+
+  /**
+   * @brief Start a new multiplex
+   * @param Config Multiplex layout
+   * @return False if the configuration is inconsistent (no stream, PID clash, PES size bounds, unknown PCR PID)
+   */
+  bool Init(const xTS_GeneratorConfig& Config);
+
+  /**
+   * @brief Write the next packet (preceded by garbage bytes on sync loss)
+   * @param Output Buffer of at least MaxOutputSize bytes
+   * @return Number of bytes written
+   */
+  uint32_t Generate(uint8_t* Output);
+
+  uint64_t getNumPackets   () const { return m_NumPackets;    }
+  uint64_t getNumPES       () const { return m_NumPES;        }
+  uint64_t getNumNull      () const { return m_NumNull;       }
+  uint64_t getNumCC_Errors () const { return m_NumCC_Errors;  }
+  uint64_t getNumSyncLosses() const { return m_NumSyncLosses; }
+
+  /** @brief Clock of the next packet [27 MHz] */
+  uint64_t getTime() const { return m_Time; }
+
+protected:
+  /** @brief splitmix64 */
+  uint64_t xRandom();
+
+  /** @brief Uniform value in [Min, Max] */
+  uint32_t xRandomRange(uint32_t Min, uint32_t Max) { return Min + static_cast<uint32_t>(xRandom() % (static_cast<uint64_t>(Max) - Min + 1)); }
+
+  /** @brief True with the given probability */
+  bool xRandomEvent(double Probability) { return Probability > 0 && (xRandom() >> 11) * (1.0 / 9007199254740992.0) < Probability; }
+
+  /** @brief True if the PCR must go into this packet - the next slot could be past the deadline */
+  bool xPCR_Due() const;
+
+  /** @brief Build the next PES packet of a stream */
+  void xBuildPES(uint32_t StreamIdx);
+
+  /** @brief Write the next packet of a stream */
+  void xStreamPacket(uint32_t StreamIdx, uint8_t* Packet);
+
+  /** @brief Build PAT and PMT sections (payload of the PSI packets) */
+  void xBuildPSI();
+
+  /** @brief Write a PSI packet with the next continuity counter */
+  static void xPSIPacket(uint8_t* Packet, const uint8_t* Template, uint8_t& CC);
+};
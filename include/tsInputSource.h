@@ -0,0 +1,283 @@
+/**
+ * @file tsInputSource.h
+ * @brief Block oriented input sources feeding raw Transport Stream bytes to the parser
+ *
+ * The parser never copies individual packets out of the input. Instead an input source
+ * exposes a window of contiguous bytes (a block) and the packet loop walks that window
+ * with a fixed stride, handing pointers straight into the block to xTS_PacketHeader::Parse
+ * and xPES_Assembler::AbsorbPacket. Once the loop is done with a part of the window it
+ * calls Consume() and asks for more data with Request().
+ *
+ * Available implementations:
+ * - xTS_BufferedInputSource : large block fread() into a private buffer (works for any stream, "-" reads stdin)
+ * - xTS_MmapInputSource     : read-only memory mapping of a regular file (zero copy)
+ * - xTS_UringInputSource    : queue of asynchronous io_uring reads (see tsUringInputSource.h)
+ * - xTS_FollowInputSource   : buffered reader following a growing file (see tsFollowInputSource.h)
+ * - xTS_UdpInputSource      : batched UDP/RTP datagram receiver (see tsUdpInputSource.h)
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <atomic>
+#include <cstdio>
+#include <functional>
+#include <memory>
+
+/**
+ * @struct xTS_InputConfig
+ * @brief Tuning parameters passed to xTS_InputSource::Create()
+ */
+struct xTS_InputConfig
+{
+  size_t   BlockSize  = 4 * 1024 * 1024; ///< Size of a single read (buffered and io_uring backends)
+  uint32_t QueueDepth = 8;               ///< Number of reads kept in flight (io_uring backend)
+  bool     DirectIO   = false;           ///< Bypass the page cache with O_DIRECT (io_uring backend)
+  bool     Follow     = false;           ///< Keep reading a growing file (see tsFollowInputSource.h)
+  uint32_t IdleTimeout = 0;              ///< Live sources stop after no data arrived for this long [s] (0: never)
+  uint32_t RecvBufferSize = 8 * 1024 * 1024; ///< Socket receive buffer (UDP backend)
+  const char* Interface = nullptr;       ///< Address of the interface joining a multicast group (UDP backend, nullptr: any)
+};
+
+/**
+ * @class xTS_InputSource
+ * @brief Abstract block reader interface used by the packet processing loop
+ *
+ * The base class owns the current window (data pointer + number of available bytes) and
+ * the absolute stream position, so the hot path (getData/getAvailable/Consume) is inline
+ * and non-virtual. Derived classes only implement opening, closing and window refilling.
+ *
+ * Typical usage:
+ * ```
+ * while(Source->Request(BlockSize) >= xTS::TS_PacketLength)
+ * {
+ *   const uint8_t* Block     = Source->getData();
+ *   size_t         NumBytes  = Source->getAvailable() / xTS::TS_PacketLength * xTS::TS_PacketLength;
+ *   ... walk Block with 188-byte stride ...
+ *   Source->Consume(NumBytes);
+ * }
+ * ```
+ */
+class xTS_InputSource
+{
+public:
+  /**
+   * @enum eType
+   * @brief Selectable input backends
+   */
+  enum class eType : int32_t
+  {
+    Auto     = 0,  ///< Memory mapping for regular files, buffered reader otherwise
+    Buffered    ,  ///< Large block fread() into a private buffer
+    Mmap        ,  ///< Read-only memory mapping of the whole file
+    Uring       ,  ///< Asynchronous io_uring reads with a deep queue
+  };
+
+  /** @brief Default block size requested by the packet loop (4 MiB) */
+  static constexpr size_t DefaultBlockSize = 4 * 1024 * 1024;
+
+  /** @brief Function called by live sources before they wait for data */
+  typedef std::function<void()> tIdleCallback;
+
+  /** @brief File name selecting the standard input */
+  static constexpr const char* StdinName = "-";
+
+protected:
+  const uint8_t* m_Data;      ///< Start of the currently available window
+  size_t         m_Available; ///< Number of bytes available at m_Data
+  uint64_t       m_Position;  ///< Absolute stream offset of m_Data
+  tIdleCallback  m_IdleCallback;
+
+  static std::atomic<bool> ms_StopRequested;
+
+public:
+  xTS_InputSource() : m_Data(nullptr), m_Available(0), m_Position(0) {}
+  virtual ~xTS_InputSource() {}
+
+  /**
+   * @brief Open the input
+   * @param FileName Path of the input file
+   * @return True on success
+   */
+  virtual bool Open(const char* FileName) = 0;
+
+  /**
+   * @brief Close the input and release all resources
+   */
+  virtual void Close() = 0;
+
+  /**
+   * @brief Make at least MinBytes contiguous bytes available at getData()
+   *
+   * Fewer bytes are returned only when the end of the input has been reached.
+   * Bytes which were not consumed yet are preserved (they may be moved, so any
+   * pointer obtained from getData() before the call is invalidated).
+   *
+   * @param MinBytes Minimal number of contiguous bytes requested
+   * @return Number of bytes available after the call (0 at end of input)
+   */
+  virtual size_t Request(size_t MinBytes) = 0;
+
+  /**
+   * @brief Get a reference keeping the current window alive
+   *
+   * While the reference is held, the bytes currently exposed through getData() stay
+   * valid and unmodified, even after Consume(), Request() or Close(). Sources which
+   * reuse their buffers continue in a fresh buffer while an old one is referenced.
+   * Zero-copy consumers (e.g. PES payload slices) hold these references.
+   *
+   * @return Reference to the block holding the window (empty when no data is exposed)
+   */
+  virtual xBlockRef getBlockRef() const = 0;
+
+  /**
+   * @brief Get backend name (for statistics output)
+   */
+  virtual const char* getName() const = 0;
+
+  /**
+   * @brief Get total size of the input in bytes
+   * @return Input size, or 0 when unknown (pipes, sockets)
+   */
+  virtual uint64_t getSize() const { return 0; }
+
+  /**
+   * @brief Continue reading at an absolute offset (drops the current window)
+   * @param Position Absolute offset of the next byte to read
+   * @return False if the source cannot seek (streams, asynchronous reads in flight)
+   */
+  virtual bool Seek(uint64_t Position) { (void)Position; return false; }
+
+  /**
+   * @brief Check whether the source delivers data as it is produced (growing file, network)
+   *
+   * Request() of a live source waits until MinBytes arrived, so the packet loop asks
+   * only for more than it has left unprocessed. Before waiting, the idle callback is
+   * invoked (e.g. to flush output). Live sources end on RequestStop() or when no data
+   * arrived for the configured idle timeout.
+   */
+  virtual bool isLive() const { return false; }
+
+  /** @brief Set function called before a live source waits for data */
+  void setIdleCallback(const tIdleCallback& IdleCallback) { m_IdleCallback = IdleCallback; }
+
+  /** @brief Make all live sources finish with the data received so far (async-signal-safe) */
+  static void RequestStop() { ms_StopRequested.store(true, std::memory_order_relaxed); }
+
+  /** @brief Check whether RequestStop() was called */
+  static bool isStopRequested() { return ms_StopRequested.load(std::memory_order_relaxed); }
+
+  /** @brief Get pointer to the currently available window */
+  const uint8_t* getData() const { return m_Data; }
+
+  /** @brief Get number of bytes in the currently available window */
+  size_t getAvailable() const { return m_Available; }
+
+  /** @brief Get absolute stream offset of the first available byte */
+  uint64_t getPosition() const { return m_Position; }
+
+  /**
+   * @brief Mark bytes at the start of the window as processed
+   * @param NumBytes Number of bytes to drop (must not exceed getAvailable())
+   */
+  void Consume(size_t NumBytes) { m_Data += NumBytes; m_Available -= NumBytes; m_Position += NumBytes; }
+
+  /**
+   * @brief Create an input source of the requested type
+   *
+   * eType::Auto selects the memory mapped reader for regular files and the buffered
+   * reader for everything else. The mapped and io_uring readers fall back to the
+   * buffered one when they are not supported on the platform (or the input is not
+   * a regular file). Following a growing file (Config.Follow) always uses the
+   * buffered reader, udp:// and rtp:// names the network receiver.
+   *
+   * @param Type     Requested backend
+   * @param FileName Path of the input file (used to resolve eType::Auto)
+   * @param Config   Backend tuning parameters
+   * @return Newly created (not yet opened) input source
+   */
+  static std::unique_ptr<xTS_InputSource> Create(eType Type, const char* FileName, const xTS_InputConfig& Config = xTS_InputConfig());
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_BufferedInputSource
+ * @brief Input source reading large blocks with fread() into a private buffer
+ *
+ * Unconsumed bytes are moved to the front of the buffer before every refill, so a
+ * partial packet at a block boundary is always presented contiguously. Pipes and FIFOs
+ * deliver short reads, which are repeated until a whole block is buffered, so the
+ * parser sees the same large blocks as from a file and memory use stays constant.
+ * The file name "-" selects the standard input.
+ */
+class xTS_BufferedInputSource : public xTS_InputSource
+{
+protected:
+  std::FILE* m_File;        ///< Input stream
+  std::shared_ptr<uint8_t> m_BufferRef; ///< Ownership of the block buffer (shared with block references)
+  uint8_t*   m_Buffer;      ///< Private block buffer (m_BufferRef.get())
+  size_t     m_BufferSize;  ///< Allocated buffer size in bytes
+  uint64_t   m_FileSize;    ///< Input size (0 if unknown)
+  bool       m_EndOfInput;  ///< Set once fread() reported end of file or error
+  bool       m_OwnsFile;    ///< m_File was opened by the source (not stdin)
+
+public:
+  /**
+   * @brief Constructor
+   * @param BlockSize Size of a single read (the buffer is allocated lazily in Open())
+   */
+  explicit xTS_BufferedInputSource(size_t BlockSize = DefaultBlockSize);
+  ~xTS_BufferedInputSource() override;
+
+  bool        Open(const char* FileName) override;
+  void        Close() override;
+  size_t      Request(size_t MinBytes) override;
+  bool        Seek(uint64_t Position) override;
+  xBlockRef   getBlockRef() const override { return m_BufferRef; }
+  const char* getName() const override { return m_OwnsFile ? "buffered" : "buffered stdin"; }
+  uint64_t    getSize() const override { return m_FileSize; }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_MmapInputSource
+ * @brief Input source exposing a read-only memory mapping of a regular file
+ *
+ * The whole file is mapped once and the window simply advances through the mapping,
+ * so packets are never copied. The kernel is told that access is sequential
+ * (MADV_SEQUENTIAL), transparent huge pages are requested where supported and the
+ * next window is prefetched with MADV_WILLNEED as the loop advances.
+ */
+class xTS_MmapInputSource : public xTS_InputSource
+{
+public:
+  /** @brief Size of the window exposed (and prefetched) per Request() call (16 MiB) */
+  static constexpr size_t WindowSize = 16 * 1024 * 1024;
+
+protected:
+  int       m_FileDescriptor; ///< Descriptor of the mapped file
+  uint8_t*  m_Mapping;        ///< Start of the mapping
+  xBlockRef m_MappingRef;     ///< Ownership of the mapping (unmapped when the last reference is dropped)
+  uint64_t  m_MappingSize;    ///< Size of the mapping (file size)
+  uint64_t  m_PrefetchEnd;    ///< Offset up to which MADV_WILLNEED was already issued
+
+public:
+  xTS_MmapInputSource();
+  ~xTS_MmapInputSource() override;
+
+  bool        Open(const char* FileName) override;
+  void        Close() override;
+  size_t      Request(size_t MinBytes) override;
+  bool        Seek(uint64_t Position) override;
+  xBlockRef   getBlockRef() const override { return m_MappingRef; }
+  const char* getName() const override { return "mmap"; }
+  uint64_t    getSize() const override { return m_MappingSize; }
+
+  /** @brief Check whether memory mapped input is supported on this platform */
+  static bool isSupported();
+};
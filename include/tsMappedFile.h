@@ -0,0 +1,50 @@
+/**
+ * @file tsMappedFile.h
+ * @brief Read-only access to a whole file (memory mapping, read() fallback)
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <vector>
+
+/**
+ * @class xTS_MappedFile
+ * @brief Whole file contents for index and sidecar readers
+ *
+ * The file is mapped read-only where mmap() is available, so only the pages a lookup
+ * touches are read. Other platforms read the file into memory.
+ */
+class xTS_MappedFile
+{
+protected:
+  const uint8_t*       m_Data;        ///< File contents
+  size_t               m_Size;
+  bool                 m_Mapped;      ///< m_Data is a memory mapping (otherwise m_Buffer)
+  std::vector<uint8_t> m_Buffer;      ///< File contents on platforms without mmap
+
+public:
+  xTS_MappedFile();
+  ~xTS_MappedFile();
+
+  xTS_MappedFile(const xTS_MappedFile&) = delete;
+  xTS_MappedFile& operator=(const xTS_MappedFile&) = delete;
+
+  /**
+   * @brief Map file
+   * @param FileName Path of the file
+   * @param MinSize  Smallest acceptable file size
+   * @return True on success
+   */
+  bool Open(const char* FileName, size_t MinSize = 0);
+
+  /** @brief Unmap file */
+  void Close();
+
+  bool           isOpen() const { return m_Data != nullptr; }
+  const uint8_t* getData() const { return m_Data; }
+  size_t         getSize() const { return m_Size; }
+};
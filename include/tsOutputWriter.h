@@ -0,0 +1,284 @@
+/**
+ * @file tsOutputWriter.h
+ * @brief Asynchronous buffered text output for analysis results
+ *
+ * Formatting through std::ofstream and snprintf dominates the run time on large
+ * inputs. xTS_OutputWriter formats integers with a hand-rolled two-digits-per-step
+ * converter directly into large pre-allocated chunks. Full chunks are handed to a
+ * writer thread which flushes them with write(2) while the parser fills the next
+ * chunk; the producer only blocks when all chunks are queued for writing.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <condition_variable>
+#include <cstdio>
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class xTS_TextFormatter
+ * @brief Formats text and numbers into a chunk of memory
+ *
+ * Put*() calls append at the write position; a derived class decides what happens
+ * when the chunk is full (hand it off for writing or grow it).
+ */
+class xTS_TextFormatter
+{
+public:
+  /** @brief Space guaranteed before formatting one number (20 digits + sign) */
+  static constexpr size_t   MaxNumberLength  = 24;
+
+protected:
+  char*       m_Begin;            ///< Chunk being filled
+  char*       m_Cur;              ///< Write position in the current chunk
+  char*       m_End;              ///< End of the current chunk
+
+public:
+  xTS_TextFormatter() : m_Begin(nullptr), m_Cur(nullptr), m_End(nullptr) {}
+  virtual ~xTS_TextFormatter() {}
+
+  // === Formatting ===
+
+  /** @brief Append single character */
+  void Put(char Char)
+  {
+    if(m_Cur == m_End) xSubmit();
+    *m_Cur++ = Char;
+  }
+
+  /** @brief Append characters */
+  void Put(const char* Text, size_t Length)
+  {
+    while(Length > static_cast<size_t>(m_End - m_Cur))
+    {
+      const size_t Part = static_cast<size_t>(m_End - m_Cur);
+      memcpy(m_Cur, Text, Part);
+      m_Cur  += Part;
+      Text   += Part;
+      Length -= Part;
+      xSubmit();
+    }
+    memcpy(m_Cur, Text, Length);
+    m_Cur += Length;
+  }
+
+  /** @brief Append zero terminated string */
+  void Put(const char* Text) { Put(Text, strlen(Text)); }
+
+  /** @brief Append unsigned decimal number (printf %u) */
+  void PutUInt(uint64_t Value) { PutUInt(Value, 0, ' '); }
+
+  /**
+   * @brief Append unsigned decimal number padded to a minimum width (printf %0<Width>u / %<Width>u)
+   * @param Value Number
+   * @param Width Minimum number of characters
+   * @param Fill  Padding character ('0' or ' ')
+   */
+  void PutUInt(uint64_t Value, uint32_t Width, char Fill)
+  {
+    xReserve(MaxNumberLength + Width);
+    char     Digits[MaxNumberLength];
+    uint32_t NumDigits = xFormatDecimal(Digits + sizeof(Digits), Value);
+    for(uint32_t Idx = NumDigits; Idx < Width; Idx++) { *m_Cur++ = Fill; }
+    memcpy(m_Cur, Digits + sizeof(Digits) - NumDigits, NumDigits);
+    m_Cur += NumDigits;
+  }
+
+  /** @brief Append signed decimal number (printf %d) */
+  void PutInt(int64_t Value)
+  {
+    if(Value < 0)
+    {
+      Put('-');
+      PutUInt(static_cast<uint64_t>(0) - static_cast<uint64_t>(Value));
+    }
+    else
+    {
+      PutUInt(static_cast<uint64_t>(Value));
+    }
+  }
+
+  /**
+   * @brief Append upper case hexadecimal number zero padded to a minimum width (printf %0<Width>X)
+   */
+  void PutHex(uint64_t Value, uint32_t Width)
+  {
+    xReserve(MaxNumberLength + Width);
+    static const char HexDigits[] = "0123456789ABCDEF";
+    char     Digits[16];
+    uint32_t NumDigits = 0;
+    do { Digits[15 - NumDigits++] = HexDigits[Value & 0xF]; Value >>= 4; } while(Value);
+    for(uint32_t Idx = NumDigits; Idx < Width; Idx++) { *m_Cur++ = '0'; }
+    memcpy(m_Cur, Digits + 16 - NumDigits, NumDigits);
+    m_Cur += NumDigits;
+  }
+
+protected:
+  void xReserve(size_t Size) { if(static_cast<size_t>(m_End - m_Cur) < Size) xSubmit(); }
+
+  /** @brief Makes room after the current chunk is full (at least 4 * MaxNumberLength bytes) */
+  virtual void xSubmit() = 0;
+
+  /**
+   * @brief Converts a number to decimal digits ending at End, two digits per step
+   * @return Number of digits
+   */
+  static uint32_t xFormatDecimal(char* End, uint64_t Value)
+  {
+    static const char DigitPairs[] =
+      "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+      "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+      "8081828384858687888990919293949596979899";
+    char* Cur = End;
+    while(Value >= 100)
+    {
+      const uint32_t Pair = static_cast<uint32_t>(Value % 100) * 2;
+      Value /= 100;
+      *--Cur = DigitPairs[Pair + 1];
+      *--Cur = DigitPairs[Pair    ];
+    }
+    if(Value >= 10)
+    {
+      const uint32_t Pair = static_cast<uint32_t>(Value) * 2;
+      *--Cur = DigitPairs[Pair + 1];
+      *--Cur = DigitPairs[Pair    ];
+    }
+    else
+    {
+      *--Cur = static_cast<char>('0' + Value);
+    }
+    return static_cast<uint32_t>(End - Cur);
+  }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TextBuffer
+ * @brief Growing in-memory text (formats output off the writer, e.g. per parallel chunk)
+ */
+class xTS_TextBuffer : public xTS_TextFormatter
+{
+protected:
+  std::vector<char> m_Storage;
+
+public:
+  /** @brief Get formatted text */
+  const char* getData() const { return m_Begin; }
+
+  /** @brief Get number of formatted bytes */
+  size_t getSize() const { return static_cast<size_t>(m_Cur - m_Begin); }
+
+  /** @brief Discard text, keep memory */
+  void Clear() { m_Cur = m_Begin; }
+
+protected:
+  void xSubmit() override
+  {
+    const size_t Size = getSize();
+    m_Storage.resize(std::max<size_t>(m_Storage.size() * 2, 64 * 1024));
+    m_Begin = m_Storage.data();
+    m_Cur   = m_Begin + Size;
+    m_End   = m_Begin + m_Storage.size();
+  }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_OutputWriter
+ * @brief Chunked text output with a dedicated writer thread
+ *
+ * Put*() calls append to the current chunk. Chunk boundaries do not follow line
+ * boundaries - the file is a plain byte stream, written in submission order.
+ */
+class xTS_OutputWriter : public xTS_TextFormatter
+{
+public:
+  /** @brief Default size of one output chunk */
+  static constexpr size_t   DefaultChunkSize = 4 * 1024 * 1024;
+
+  /** @brief Default number of chunks (one being filled, the others queued or being written) */
+  static constexpr uint32_t DefaultNumChunks = 4;
+
+protected:
+  struct xChunk
+  {
+    char*  Data;
+    size_t Size;
+  };
+
+  // === File ===
+  int         m_FileDescriptor;   ///< Output file (POSIX)
+  std::FILE*  m_File;             ///< Output file (platforms without write(2))
+
+  // === Producer side ===
+  std::vector<std::unique_ptr<char[]>> m_Storage; ///< Chunk memory
+  size_t      m_ChunkSize;
+
+  // === Hand-off to the writer thread ===
+  std::mutex              m_Mutex;
+  std::condition_variable m_FullCondition;  ///< Signalled when a chunk is queued or on close
+  std::condition_variable m_FreeCondition;  ///< Signalled when a chunk was written
+  std::deque<xChunk>      m_FullChunks;     ///< Chunks queued for writing
+  std::vector<char*>      m_FreeChunks;     ///< Chunks ready to be filled
+  std::thread             m_Thread;
+  bool                    m_Stop;
+  bool                    m_Failed;         ///< A write failed - remaining output is discarded
+
+  // === Statistics ===
+  uint64_t    m_NumBytes;         ///< Bytes written to the file
+  uint64_t    m_NumCalls;         ///< Write system calls issued
+  uint64_t    m_NumStalls;        ///< Submissions which waited for a free chunk
+
+public:
+  xTS_OutputWriter();
+  ~xTS_OutputWriter() override;
+
+  /**
+   * @brief Create (truncate) output file and start writer thread
+   * @param FileName  Path of the output file
+   * @param ChunkSize Size of one output chunk
+   * @param NumChunks Number of chunks (at least 2)
+   * @return True on success
+   */
+  bool Open(const char* FileName, size_t ChunkSize = DefaultChunkSize, uint32_t NumChunks = DefaultNumChunks);
+
+  /**
+   * @brief Write pending output, stop writer thread and close file
+   * @return True if all output was written
+   */
+  bool Close();
+
+  /** @brief Hand the partially filled chunk to the writer thread (output becomes visible without waiting for a full chunk) */
+  void Flush() { if(m_Cur != m_Begin) xSubmit(); }
+
+  /** @brief Check whether output file is open */
+  bool isOpen() const { return m_Begin != nullptr; }
+
+  // === Statistics ===
+
+  /** @brief Get number of bytes written to the file */
+  uint64_t getNumBytes() const { return m_NumBytes; }
+
+  /** @brief Get number of write system calls */
+  uint64_t getNumCalls() const { return m_NumCalls; }
+
+  /** @brief Get number of times the producer waited for the writer thread */
+  uint64_t getNumStalls() const { return m_NumStalls; }
+
+protected:
+  void xSubmit() override;
+  void xWriterLoop();
+  bool xWrite(const char* Data, size_t Size);
+};
@@ -0,0 +1,233 @@
+/**
+ * @file tsPCRAnalyzer.h
+ * @brief PCR interval, jitter, frequency offset and drift analysis with streaming statistics
+ *
+ * Every PCR of a PCR PID is paired with its arrival position:
+ * - M2TS input: the arrival timestamp (ATS, 27 MHz) of the packet. The slope of PCR
+ *   against arrival time is the frequency offset of the encoder clock relative to the
+ *   recorder clock (ppm), its change over time the drift (ppm/h).
+ * - Other input: the byte offset of the packet, i.e. arrival at a constant bitrate. The
+ *   slope is the measured multiplex bitrate; no clock is available to measure ppm.
+ *
+ * An online least squares fit (Welford style co-moments, stable over days of samples)
+ * of PCR against arrival is kept per PID. The residual of each PCR against the fit is
+ * its overall jitter (PCR_OJ). The fit restarts at PCR discontinuities.
+ *
+ * All statistics are O(1) in memory: running min/max/mean/variance and HDR-style
+ * log-linear histograms (32 linear sub-buckets per power of two, ~3 % resolution) for
+ * percentiles, so multi-day captures do not accumulate state.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsRecordFile.h"
+#include <cmath>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RunningStats
+ * @brief Streaming count, min, max, mean and variance (Welford)
+ */
+class xTS_RunningStats
+{
+protected:
+  uint64_t m_Count = 0;
+  double   m_Min   = 0;
+  double   m_Max   = 0;
+  double   m_Mean  = 0;
+  double   m_M2    = 0;   ///< Sum of squared distances from the mean
+
+public:
+  void Add(double Value)
+  {
+    m_Count++;
+    if(m_Count == 1 || Value < m_Min) m_Min = Value;
+    if(m_Count == 1 || Value > m_Max) m_Max = Value;
+    const double Delta = Value - m_Mean;
+    m_Mean += Delta / static_cast<double>(m_Count);
+    m_M2   += Delta * (Value - m_Mean);
+  }
+
+  uint64_t getCount   () const { return m_Count; }
+  double   getMin     () const { return m_Min;   }
+  double   getMax     () const { return m_Max;   }
+  double   getMean    () const { return m_Mean;  }
+  double   getVariance() const { return m_Count > 1 ? m_M2 / static_cast<double>(m_Count - 1) : 0; }
+  double   getStdDev  () const { return std::sqrt(getVariance()); }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_LogHistogram
+ * @brief HDR-style histogram of non-negative integers with constant relative resolution
+ *
+ * Values below 2^SubBucketBits have a bucket each; above, every power of two is split
+ * into 2^SubBucketBits linear sub-buckets. Percentiles are reported as the midpoint of
+ * the bucket holding the requested rank, clamped to the exact minimum and maximum of the
+ * added values (a percentile never lies outside the observed range).
+ */
+class xTS_LogHistogram
+{
+public:
+  static constexpr uint32_t SubBucketBits = 5;
+  static constexpr uint32_t SubBuckets    = 1u << SubBucketBits;
+  static constexpr uint32_t NumBuckets    = (64 - SubBucketBits + 1) * SubBuckets;
+
+protected:
+  std::vector<uint64_t> m_Counts;
+  uint64_t              m_Total;
+  uint64_t              m_Min;
+  uint64_t              m_Max;
+
+public:
+  xTS_LogHistogram() : m_Counts(NumBuckets, 0), m_Total(0), m_Min(0), m_Max(0) {}
+
+  void Add(uint64_t Value)
+  {
+    if(m_Total == 0 || Value < m_Min) m_Min = Value;
+    if(m_Total == 0 || Value > m_Max) m_Max = Value;
+    m_Counts[xBucket(Value)]++;
+    m_Total++;
+  }
+
+  uint64_t getTotal() const { return m_Total; }
+  uint64_t getMin  () const { return m_Min;   }
+  uint64_t getMax  () const { return m_Max;   }
+
+  /**
+   * @brief Get value at a percentile
+   * @param Percentile 0-100
+   * @return Midpoint of the bucket clamped to [getMin(), getMax()], 0 if the histogram is empty
+   */
+  uint64_t getPercentile(double Percentile) const;
+
+protected:
+  static uint32_t xFloorLog2(uint64_t Value);
+  static uint32_t xBucket(uint64_t Value);
+  static uint64_t xLowerBound(uint32_t Bucket);
+  static uint64_t xMidpoint  (uint32_t Bucket);
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_OnlineRegression
+ * @brief Streaming least squares line fit y = a + b * x (co-moments about the running means)
+ */
+class xTS_OnlineRegression
+{
+protected:
+  uint64_t m_Count = 0;
+  double   m_MeanX = 0;
+  double   m_MeanY = 0;
+  double   m_Sxx   = 0;
+  double   m_Sxy   = 0;
+
+public:
+  void Reset() { *this = xTS_OnlineRegression(); }
+
+  void Add(double X, double Y)
+  {
+    m_Count++;
+    const double DeltaX = X - m_MeanX;
+    m_MeanX += DeltaX / static_cast<double>(m_Count);
+    m_MeanY += (Y - m_MeanY) / static_cast<double>(m_Count);
+    m_Sxx   += DeltaX * (X - m_MeanX);
+    m_Sxy   += DeltaX * (Y - m_MeanY);
+  }
+
+  uint64_t getCount    () const { return m_Count; }
+  bool     hasSlope    () const { return m_Count >= 2 && m_Sxx > 0; }
+  double   getSlope    () const { return hasSlope() ? m_Sxy / m_Sxx : 0; }
+  double   getPrediction(double X) const { return m_MeanY + getSlope() * (X - m_MeanX); }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_PCRAnalyzer
+ * @brief Per PCR PID timing analysis
+ */
+class xTS_PCRAnalyzer
+{
+public:
+  static constexpr uint32_t NumPIDs       = 8192;
+  static constexpr uint32_t MinFitPCRs    = 16;     ///< PCRs in the fit before residuals are taken as jitter
+  static constexpr uint32_t BlockDuration = 10;     ///< Span of the per-block slope (frequency offset / bitrate) [s]
+  static constexpr uint32_t MaxPCRGap     = 100;    ///< Larger PCR steps are discontinuities [ms]
+
+  /** @brief Analysis state and results of one PCR PID */
+  struct xStream
+  {
+    uint16_t             PID              = 0;
+    bool                 ATS              = false;  ///< Arrival from M2TS timestamps (false: byte offsets)
+    uint64_t             NumPCRs          = 0;
+    uint64_t             NumDiscontinuities = 0;    ///< Flagged or detected PCR steps (fit restarts)
+
+    // === Previous PCR ===
+    uint64_t             LastPCR          = 0;      ///< [27 MHz]
+    uint64_t             LastATS          = 0;      ///< Unwrapped ATS [27 MHz]
+    uint32_t             LastRawATS       = 0;
+
+    // === Fits ===
+    double               Origin           = 0;      ///< Arrival of the first PCR of the segment (fit origin)
+    uint64_t             PCRTime          = 0;      ///< PCR time since the first PCR of the segment [27 MHz]
+    xTS_OnlineRegression Fit;                       ///< PCR against arrival since the last discontinuity
+    xTS_OnlineRegression BlockFit;                  ///< Same, over the current block
+    double               BlockStart       = 0;      ///< PCR time of the block start [27 MHz]
+    xTS_OnlineRegression Drift;                     ///< Block frequency offset [ppm] against time [h] (ATS)
+    double               DriftTime        = 0;      ///< Hours of completed segments (drift time line)
+
+    // === Statistics ===
+    xTS_RunningStats     Interval;                  ///< PCR interval [ms]
+    xTS_LogHistogram     IntervalHist;              ///< PCR interval [us]
+    xTS_RunningStats     Jitter;                    ///< Overall jitter [ns]
+    xTS_LogHistogram     JitterHist;                ///< |Overall jitter| [ns]
+    xTS_RunningStats     BlockSlope;                ///< Frequency offset [ppm] (ATS) or bitrate [Mbit/s] of each block
+
+    /** @brief Get frequency offset of the current segment [ppm] (ATS) */
+    double getFrequencyOffset() const { return Fit.hasSlope() ? (Fit.getSlope() - 1.0) * 1e6 : 0; }
+
+    /** @brief Get bitrate of the current segment [bit/s] (byte offsets) */
+    double getBitrate() const { return Fit.hasSlope() ? 8.0 * 27e6 / Fit.getSlope() : 0; }
+
+    /** @brief Get drift of the frequency offset [ppm/h] (ATS) */
+    double getDrift() const { return Drift.getSlope(); }
+  };
+
+protected:
+  uint16_t             m_SlotIdx[NumPIDs];   ///< PID -> index into m_Streams + 1 (0 = no PCR seen)
+  std::vector<xStream> m_Streams;
+
+public:
+  xTS_PCRAnalyzer();
+
+  /**
+   * @brief Add the PCR of a packet record (records without PCR are ignored)
+   * @param Record Packet record
+   * @param Offset Byte offset of the (source) packet
+   */
+  void AddRecord(const xTS_PacketRecord& Record, uint64_t Offset)
+  {
+    if(!Record.hasPCR() || Record.Kind != static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet)) return;
+    uint16_t SlotIdx = m_SlotIdx[Record.PID];
+    if(SlotIdx == 0) SlotIdx = xAddStream(Record);
+    xAddPCR(m_Streams[SlotIdx - 1], Record, Offset);
+  }
+
+  /** @brief Get analyzed PCR PIDs in order of their first PCR */
+  const std::vector<xStream>& getStreams() const { return m_Streams; }
+
+protected:
+  uint16_t xAddStream(const xTS_PacketRecord& Record);
+  void     xAddPCR(xStream& Stream, const xTS_PacketRecord& Record, uint64_t Offset);
+  void     xRestart(xStream& Stream, double Arrival);
+  void     xCloseBlock(xStream& Stream, double X, double Y);
+};
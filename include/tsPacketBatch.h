@@ -0,0 +1,119 @@
+/**
+ * @file tsPacketBatch.h
+ * @brief Batch decoding of Transport Stream packet headers into a structure-of-arrays table
+ *
+ * xTS_PacketHeader decodes one packet at a time into an object holding all fields.
+ * xTS_PacketBatch decodes the headers of a whole run of packets at once and stores every
+ * field in its own contiguous column, so per-stream stages (PID filtering, continuity
+ * checking, statistics) become tight loops over small arrays.
+ *
+ * The AVX2 kernel gathers the 4-byte headers (and the adaptation_field_length byte) of
+ * 8 packets at packet stride with a single vpgatherdd each and extracts all fields with
+ * lane-parallel shifts and masks. A scalar kernel is used on CPUs without AVX2.
+ *
+ * Null packets (PID 0x1FFF) are flagged in the same pass (a lane compare per group of
+ * 8 packets), so callers can take them off the per-packet analysis with one flag test.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+#include <vector>
+
+/**
+ * @class xTS_PacketBatch
+ * @brief Structure-of-arrays table of decoded TS packet headers
+ *
+ * Columns (one entry per packet):
+ * - PID           : 13-bit packet identifier
+ * - Flags         : transport_error (0x80), payload_unit_start (0x40), priority (0x20)
+ *                   at their header bit positions, plus SyncValid (0x01) and
+ *                   Null (0x02, sync valid null packet)
+ * - TSC, AFC, CC  : scrambling control, adaptation field control, continuity counter
+ * - PayloadOffset : offset of the payload inside the 188-byte packet
+ *                   (TS_PacketLength when the packet carries no payload)
+ *
+ * Fields of packets without a valid sync byte are decoded anyway; callers check
+ * isSyncValid() before trusting them.
+ */
+class xTS_PacketBatch
+{
+public:
+  /** @brief Default number of packets decoded per batch */
+  static constexpr uint32_t DefaultCapacity = 4096;
+
+  /** @brief Flag bits stored in the Flags column */
+  static constexpr uint8_t FlagTransportError    = 0x80;
+  static constexpr uint8_t FlagPayloadUnitStart  = 0x40;
+  static constexpr uint8_t FlagTransportPriority = 0x20;
+  static constexpr uint8_t FlagSyncValid         = 0x01;
+  static constexpr uint8_t FlagNull              = 0x02;
+
+protected:
+  uint32_t m_Capacity;                  ///< Maximum number of packets per batch
+  uint32_t m_NumPackets;                ///< Number of packets in the current batch
+  bool     m_UseAVX2;                   ///< AVX2 gather kernel selected
+
+  std::vector<uint16_t> m_PID;          ///< PID column
+  std::vector<uint8_t>  m_Flags;        ///< Flags column (see class description)
+  std::vector<uint8_t>  m_TSC;          ///< Transport scrambling control column
+  std::vector<uint8_t>  m_AFC;          ///< Adaptation field control column
+  std::vector<uint8_t>  m_CC;           ///< Continuity counter column
+  std::vector<uint8_t>  m_PayloadOffset;///< Payload offset column
+
+public:
+  /**
+   * @brief Constructor
+   * @param Capacity Maximum number of packets decoded by a single Decode() call
+   */
+  explicit xTS_PacketBatch(uint32_t Capacity = DefaultCapacity);
+
+  /**
+   * @brief Decode headers of consecutive packets
+   *
+   * @param Data       Pointer to the first TS packet (sync byte position)
+   * @param NumPackets Number of packets to decode (clamped to capacity)
+   * @param Stride     Distance between packets in bytes (188, 192 or 204)
+   * @return Number of decoded packets
+   *
+   * @note Data must provide at least (NumPackets - 1) * Stride + TS_PacketLength bytes
+   */
+  uint32_t Decode(const uint8_t* Data, uint32_t NumPackets, uint32_t Stride = xTS::TS_PacketLength);
+
+  /** @brief Get number of packets in the current batch */
+  uint32_t getNumPackets() const { return m_NumPackets; }
+
+  /** @brief Get maximum number of packets per batch */
+  uint32_t getCapacity() const { return m_Capacity; }
+
+  /** @brief Get name of the selected decode kernel */
+  const char* getKernelName() const { return m_UseAVX2 ? "AVX2" : "scalar"; }
+
+  // Column access
+  const uint16_t* getPIDs          () const { return m_PID.data(); }
+  const uint8_t*  getFlags         () const { return m_Flags.data(); }
+  const uint8_t*  getTSCs          () const { return m_TSC.data(); }
+  const uint8_t*  getAFCs          () const { return m_AFC.data(); }
+  const uint8_t*  getCCs           () const { return m_CC.data(); }
+  const uint8_t*  getPayloadOffsets() const { return m_PayloadOffset.data(); }
+
+  // Per packet access
+  bool     isSyncValid                  (uint32_t Idx) const { return (m_Flags[Idx] & FlagSyncValid) != 0; }
+  bool     isNull                       (uint32_t Idx) const { return (m_Flags[Idx] & FlagNull) != 0; }
+  uint8_t  getTransportErrorIndicator   (uint32_t Idx) const { return (m_Flags[Idx] & FlagTransportError   ) ? 1 : 0; }
+  uint8_t  getPayloadUnitStartIndicator (uint32_t Idx) const { return (m_Flags[Idx] & FlagPayloadUnitStart ) ? 1 : 0; }
+  uint8_t  getTransportPriority         (uint32_t Idx) const { return (m_Flags[Idx] & FlagTransportPriority) ? 1 : 0; }
+  uint16_t getPID                       (uint32_t Idx) const { return m_PID[Idx]; }
+  uint8_t  getTransportScramblingControl(uint32_t Idx) const { return m_TSC[Idx]; }
+  uint8_t  getAdaptationFieldControl    (uint32_t Idx) const { return m_AFC[Idx]; }
+  uint8_t  getContinuityCounter         (uint32_t Idx) const { return m_CC[Idx]; }
+  uint8_t  getPayloadOffset             (uint32_t Idx) const { return m_PayloadOffset[Idx]; }
+
+protected:
+  void xDecodeScalar(const uint8_t* Data, uint32_t Begin, uint32_t End, uint32_t Stride);
+  void xDecodeAVX2  (const uint8_t* Data, uint32_t NumPackets, uint32_t Stride);
+};
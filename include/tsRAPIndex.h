@@ -0,0 +1,229 @@
+/**
+ * @file tsRAPIndex.h
+ * @brief Per-PID random access point index sidecar for clip extraction and trick play
+ *
+ * A random access point (RAP) is a packet which starts a PES packet (PUSI) and has the
+ * adaptation field random_access_indicator set, i.e. the first packet of a decodable
+ * position (typically a keyframe). Each RAP is recorded with its byte offset, the PCR
+ * time line at that point and the PTS/DTS of the PES packet it starts.
+ *
+ * File layout (little endian):
+ * ```
+ *   0  | File header (64 bytes): magic, version, entries per block, number of blocks and entries
+ *   64 | Blocks of BlockEntries entries, each owned by one PID, in allocation order:
+ *      |   { uint32 PID, uint32 number of entries, uint64 reserved }
+ *      |   Entries: { Offset, Time, PCR, PTS, DTS } (5 x uint64)
+ * ```
+ * Every PID fills its latest block; a full block is followed by a new one at the end of
+ * the file. A flush writes only the new entries, the headers of the blocks they went into
+ * and the file header, so a live index is updated at a cost proportional to the new
+ * entries. There is no directory: the reader collects the blocks of every PID from the
+ * block headers when it opens the file. Blocks of a PID follow each other in stream order
+ * and the entries of a PID are sorted by offset and time, so lookups binary search the
+ * blocks, then the entries of one block in the mapped file in place.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsMappedFile.h"
+#include "tsTimeIndex.h"
+#include <cstdio>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RAPIndex
+ * @brief RAP index file layout
+ */
+class xTS_RAPIndex
+{
+public:
+  static constexpr char     Magic[8]     = { 'T', 'S', 'R', 'A', 'P', 'I', 'D', 'X' };
+  static constexpr uint32_t Version      = 3;
+  static constexpr uint32_t BlockEntries = 64;            ///< Entries per block
+  static constexpr uint32_t NumPIDs      = 8192;
+  static constexpr uint64_t NoTimestamp  = UINT64_MAX;    ///< Time, PCR, PTS or DTS not available
+
+  /** @brief File header */
+  struct xFileHeader
+  {
+    char     Magic[8];
+    uint32_t Version;
+    uint32_t EntrySize;      ///< sizeof(xEntry)
+    uint32_t BlockEntries;   ///< Entries per block
+    uint32_t PCR_PID;        ///< PID of the PCR time line (0xFFFFFFFF if none)
+    uint64_t NumEntries;     ///< Number of entries of all PIDs
+    uint64_t NumBlocks;      ///< Number of blocks of all PIDs
+    uint8_t  Reserved[24];
+  };
+
+  /** @brief Block header, followed by BlockEntries entry slots */
+  struct xBlockHeader
+  {
+    uint32_t PID;
+    uint32_t NumEntries;     ///< Used entry slots
+    uint64_t Reserved;
+  };
+
+  /** @brief Random access point */
+  struct xEntry
+  {
+    uint64_t Offset;         ///< Byte offset of the (source) packet
+    uint64_t Time;           ///< PCR time line since the first PCR [27 MHz] (0 before the first PCR)
+    uint64_t PCR;            ///< Last PCR of the time line PID (27 MHz), NoTimestamp before the first PCR
+    uint64_t PTS;            ///< PTS of the PES packet (90 kHz), NoTimestamp if absent
+    uint64_t DTS;            ///< DTS of the PES packet (90 kHz), NoTimestamp if absent
+  };
+
+  static_assert(sizeof(xFileHeader)  == 64, "RAP index header must stay 64 bytes");
+  static_assert(sizeof(xBlockHeader) == 16, "RAP index block header must stay 16 bytes");
+
+  /** @brief Size of a block in the file */
+  static constexpr uint64_t BlockSize = sizeof(xBlockHeader) + BlockEntries * sizeof(xEntry);
+
+  /** @brief File offset of a block */
+  static uint64_t getBlockOffset(uint64_t BlockIdx) { return sizeof(xFileHeader) + BlockIdx * BlockSize; }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RAPIndexWriter
+ * @brief Collects random access points during analysis and writes the sidecar file
+ *
+ * New entries are kept per PID in a flat table of 8192 lists until the next flush writes
+ * them PID by PID into the PID's latest block; only the position of that block stays in
+ * memory afterwards.
+ */
+class xTS_RAPIndexWriter
+{
+protected:
+  /** @brief Writer state of one PID */
+  struct xPIDState
+  {
+    std::vector<xTS_RAPIndex::xEntry> Pending;     ///< Entries not flushed yet
+    uint64_t                          Block;       ///< Index of the latest block
+    uint32_t                          BlockFill;   ///< Entries in the latest block (BlockEntries: a new block is needed)
+    uint64_t                          NumEntries;  ///< Entries in the file
+    uint64_t                          LastTime;    ///< Time of the last entry (keeps entries in time order)
+  };
+
+  std::FILE*                                    m_File;
+  xTS_PCRTimeline                               m_Timeline;   ///< PCR time line stored with the entries
+  uint64_t                                      m_FirstTime;  ///< Time line value of the first PCR
+  uint64_t                                      m_NumEntries;
+  uint64_t                                      m_NumFlushed; ///< Entries already in the file
+  uint64_t                                      m_NumBlocks;
+  std::vector<xPIDState>                        m_PIDs;
+
+public:
+  xTS_RAPIndexWriter();
+  ~xTS_RAPIndexWriter();
+
+  /**
+   * @brief Create index file
+   * @param FileName Path of the sidecar file
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /**
+   * @brief Write header, directory and entries, close file
+   * @return True if the index was written completely
+   */
+  bool Close();
+
+  /**
+   * @brief Write entries added since the last flush and update the header (the file is a valid index afterwards)
+   * @return True on success
+   */
+  bool Flush();
+
+  /**
+   * @brief Follow a PCR (the first PID carrying a PCR provides the time line)
+   * @param PID PID of the packet
+   * @param PCR PCR value (base * 300 + extension)
+   */
+  void AddPCR(uint16_t PID, uint64_t PCR)
+  {
+    if(m_Timeline.Update(PID, PCR) && m_FirstTime == xTS_RAPIndex::NoTimestamp) m_FirstTime = m_Timeline.getTime();
+  }
+
+  /**
+   * @brief Record a random access point
+   * @param PID    PID of the packet
+   * @param Offset Byte offset of the packet
+   * @param PTS    PTS of the PES packet started by the packet, NoTimestamp if absent
+   * @param DTS    DTS of the PES packet started by the packet, NoTimestamp if absent
+   */
+  void AddRAP(uint16_t PID, uint64_t Offset, uint64_t PTS, uint64_t DTS);
+
+  uint64_t getNumEntries() const { return m_NumEntries; }
+
+  /** @brief Get number of PIDs with at least one entry */
+  uint32_t getNumPIDs() const;
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RAPIndexReader
+ * @brief Memory mapped RAP index with per-PID lookups
+ */
+class xTS_RAPIndexReader
+{
+public:
+  /** @brief Blocks of one PID, collected from the block headers */
+  struct xPIDEntry
+  {
+    uint16_t                                       PID;
+    uint64_t                                       NumEntries;
+    std::vector<const xTS_RAPIndex::xBlockHeader*> Blocks;      ///< In stream order
+  };
+
+protected:
+  xTS_MappedFile                   m_File;
+  std::vector<xPIDEntry>           m_PIDs;         ///< Sorted by PID
+  uint64_t                         m_NumEntries;
+
+public:
+  xTS_RAPIndexReader();
+
+  /**
+   * @brief Map index file, validate its header and collect the blocks of every PID
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /** @brief Unmap file */
+  void Close();
+
+  uint32_t getNumPIDs() const { return static_cast<uint32_t>(m_PIDs.size()); }
+  uint64_t getNumEntries() const { return m_NumEntries; }
+  const xPIDEntry& getPIDEntry(uint32_t PIDIdx) const { return m_PIDs[PIDIdx]; }
+
+  /** @brief Get PID with the most random access points (normally the video stream), NOT_VALID if empty */
+  int32_t getMainPID() const;
+
+  /**
+   * @brief Find the last random access point of a PID at or before a byte offset
+   * @return Entry, nullptr if the PID has none there
+   */
+  const xTS_RAPIndex::xEntry* FindByOffset(uint16_t PID, uint64_t Offset) const;
+
+  /**
+   * @brief Find the last random access point of a PID at or before a point in time
+   * @param Time Time since the first PCR [27 MHz]
+   * @return Entry, nullptr if the PID has none there
+   */
+  const xTS_RAPIndex::xEntry* FindByTime(uint16_t PID, uint64_t Time) const;
+
+protected:
+  /** @brief Blocks of a PID (binary search), nullptr if the PID has no entries */
+  const xPIDEntry* xFindPID(uint16_t PID) const;
+};
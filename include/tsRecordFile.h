@@ -0,0 +1,283 @@
+/**
+ * @file tsRecordFile.h
+ * @brief Compact binary per-packet analysis records
+ *
+ * The text analysis output needs ~150 bytes per 188-byte packet. The record format
+ * keeps the same information in fixed-width fields (62 bytes per packet) which can
+ * be scanned without parsing text, and renders to the exact text format on demand.
+ *
+ * File layout (all values little endian, every part starts at a 4 KiB boundary so a
+ * mapped file can be addressed directly):
+ * ```
+ *   0      | File header: magic, version, block capacity, block size, column table
+ *   4096   | Block 0: block header (64 bytes), then one array per column
+ *   4096+B | Block 1 ...
+ * ```
+ * Every block has room for BlockCapacity records; the last block may hold fewer.
+ * Column arrays start at 64-byte aligned offsets listed in the column table, so a
+ * consumer interested in a single field (e.g. PID or PCR) touches only that array.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsOutputWriter.h"
+#include <cstdio>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @struct xTS_PacketRecord
+ * @brief Analysis result of one packet (row form of a record)
+ *
+ * Besides packets, records describe sync loss events so a record file covers all
+ * lines of the text output:
+ * - Packet:         regular packet line.
+ * - PacketError:    packet without sync byte (--no-resync), "Error parsing packet" line.
+ * - SyncLoss:       skipped byte range before a re-lock; PCR holds the first skipped
+ *                   byte offset and OPCR the re-lock offset.
+ * - SyncLossFinal:  skipped byte range without re-lock at end of input (PCR/OPCR as above).
+ */
+struct xTS_PacketRecord
+{
+  enum class eKind : uint8_t
+  {
+    Packet        = 0,
+    PacketError   = 1,
+    SyncLoss      = 2,
+    SyncLossFinal = 3,
+  };
+
+  /** @brief PES assembly event (xPES_Assembler::eResult reported for the packet) */
+  enum class ePES_Event : uint8_t
+  {
+    None     = 0,
+    Lost     = 1,
+    Started  = 2,
+    Continue = 3,
+    Finished = 4,
+  };
+
+  // === Header bits ===
+  static constexpr uint8_t HeaderE        = 0x80; ///< transport_error_indicator
+  static constexpr uint8_t HeaderS        = 0x40; ///< payload_unit_start_indicator
+  static constexpr uint8_t HeaderP        = 0x20; ///< transport_priority
+  static constexpr uint8_t HeaderTSCShift = 3;    ///< transport_scrambling_control (2 bits)
+  static constexpr uint8_t HeaderAFCShift = 1;    ///< adaptation_field_control (2 bits)
+
+  // === Adaptation field flag bits (AF_Flags) ===
+  static constexpr uint8_t AF_FlagRA      = 0x40; ///< random_access_indicator
+  static constexpr uint8_t AF_FlagPCR     = 0x10; ///< PCR_flag
+
+  // === Flags ===
+  static constexpr uint8_t FlagAFError    = 0x01; ///< Adaptation field parsing failed
+  static constexpr uint8_t FlagATS        = 0x02; ///< ATS valid (M2TS input)
+  static constexpr uint8_t FlagPTS        = 0x04; ///< PES_PTS valid
+  static constexpr uint8_t FlagDTS        = 0x08; ///< PES_DTS valid
+
+  uint32_t Index;            ///< Packet index
+  uint16_t PID;
+  uint8_t  Kind;             ///< eKind
+  uint8_t  Header;           ///< E, S, P, TSC, AFC (see Header* constants)
+  uint8_t  CC;               ///< continuity_counter
+  uint8_t  Flags;            ///< Flag* bits
+  uint8_t  AF_Length;        ///< adaptation_field_length
+  uint8_t  AF_Flags;         ///< DC RA SP PR OR SF TP EX (adaptation field flag byte)
+  int16_t  AF_Stuffing;      ///< Adaptation field stuffing bytes
+  uint64_t PCR;              ///< PCR base << 9 | PCR extension (SyncLoss: first skipped byte)
+  uint64_t OPCR;             ///< OPCR base << 9 | OPCR extension (SyncLoss: re-lock offset)
+  uint32_t ATS;              ///< M2TS arrival timestamp
+  uint8_t  PES_Event;        ///< ePES_Event
+  uint8_t  PES_StreamId;     ///< stream_id (Started)
+  uint16_t PES_PacketLength; ///< PES_packet_length (Started, Finished)
+  uint64_t PES_PTS;
+  uint64_t PES_DTS;
+  int32_t  PES_Length;       ///< Assembled PES packet size (Finished)
+  uint32_t PES_Stuffing;     ///< Stuffing bytes of the PES packet's TS packets (Finished)
+
+  /** @brief Clear all fields */
+  void Reset() { memset(this, 0, sizeof(*this)); }
+
+  uint8_t  getAFC() const { return (Header >> HeaderAFCShift) & 0x3; }
+  uint8_t  getTSC() const { return (Header >> HeaderTSCShift) & 0x3; }
+  bool     hasAF () const { return getAFC() == 2 || getAFC() == 3; }
+  bool     hasPCR() const { return (AF_Flags & AF_FlagPCR) != 0; }
+
+  /** @brief Get PCR in 27 MHz ticks (base * 300 + extension) */
+  uint64_t getPCR() const { return (PCR >> 9) * 300 + (PCR & 0x1FF); }
+
+  /**
+   * @brief Render record as analysis_output.txt line(s)
+   * @param Output Text output
+   */
+  void Render(xTS_TextFormatter& Output) const;
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RecordFile
+ * @brief Record file layout (file header, column table, block geometry)
+ */
+class xTS_RecordFile
+{
+public:
+  static constexpr char     Magic[8]        = { 'T', 'S', 'R', 'E', 'C', 'O', 'R', 'D' };
+  static constexpr uint32_t Version         = 1;
+  static constexpr uint32_t BlockCapacity   = 4096;   ///< Records per block
+  static constexpr uint32_t FileHeaderSize  = 4096;
+  static constexpr uint32_t BlockHeaderSize = 64;
+  static constexpr uint32_t BlockMagic      = 0x4B4C4254; ///< "TBLK"
+
+  /** @brief Column description (also stored in the file header) */
+  struct xColumn
+  {
+    char     Name[24];       ///< Field name
+    uint32_t ElementSize;    ///< Bytes per record
+    uint32_t BlockOffset;    ///< Offset of the column array inside a block
+  };
+
+  /** @brief File header (followed by NumColumns xColumn entries) */
+  struct xFileHeader
+  {
+    char     Magic[8];
+    uint32_t Version;
+    uint32_t BlockCapacity;
+    uint32_t BlockSize;
+    uint32_t NumColumns;
+    uint32_t RecordSize;     ///< Sum of column element sizes
+    uint32_t Reserved;
+  };
+
+  /** @brief Block header */
+  struct xBlockHeader
+  {
+    uint32_t Magic;
+    uint32_t NumRecords;     ///< Valid records in this block
+    uint64_t FirstRecord;    ///< Record number of the first record
+  };
+
+  /** @brief Get number of columns */
+  static uint32_t getNumColumns();
+
+  /** @brief Get column description */
+  static const xColumn& getColumn(uint32_t ColumnIdx);
+
+  /** @brief Get offset of a column's field inside xTS_PacketRecord */
+  static uint32_t getRecordOffset(uint32_t ColumnIdx);
+
+  /** @brief Get size of a block (header and all column arrays, 4 KiB aligned) */
+  static uint32_t getBlockSize();
+
+  /** @brief Get sum of column element sizes */
+  static uint32_t getRecordSize();
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RecordWriter
+ * @brief Collects records column-wise and writes complete blocks
+ */
+class xTS_RecordWriter
+{
+protected:
+  xTS_OutputWriter     m_Output;
+  std::vector<uint8_t> m_Block;       ///< Block being filled
+  uint32_t             m_NumRecords;  ///< Records in m_Block
+  uint64_t             m_NumWritten;  ///< Records in completed blocks
+
+public:
+  xTS_RecordWriter();
+  ~xTS_RecordWriter();
+
+  /**
+   * @brief Create record file and write its header
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /**
+   * @brief Write the last (partial) block and close file
+   * @return True if all records were written
+   */
+  bool Close();
+
+  /** @brief Append record */
+  void Append(const xTS_PacketRecord& Record);
+
+  /** @brief Write the current block even if it is not full (readers accept partial blocks anywhere) */
+  void Flush() { if(m_NumRecords) xFlushBlock(); m_Output.Flush(); }
+
+  /** @brief Get number of appended records */
+  uint64_t getNumRecords() const { return m_NumWritten + m_NumRecords; }
+
+  /** @brief Get number of bytes written to the file */
+  uint64_t getNumBytes() const { return m_Output.getNumBytes(); }
+
+protected:
+  void xFlushBlock();
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_RecordReader
+ * @brief Memory mapped access to a record file
+ */
+class xTS_RecordReader
+{
+protected:
+  const uint8_t*       m_Data;        ///< File contents
+  size_t               m_Size;
+  bool                 m_Mapped;      ///< m_Data is a memory mapping (otherwise m_Buffer)
+  std::vector<uint8_t> m_Buffer;      ///< File contents on platforms without mmap
+  uint32_t             m_NumBlocks;
+  uint64_t             m_NumRecords;
+
+public:
+  xTS_RecordReader();
+  ~xTS_RecordReader();
+
+  /**
+   * @brief Map record file and validate header and column table
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /** @brief Unmap file */
+  void Close();
+
+  /** @brief Get number of blocks */
+  uint32_t getNumBlocks() const { return m_NumBlocks; }
+
+  /** @brief Get number of records in all blocks */
+  uint64_t getNumRecords() const { return m_NumRecords; }
+
+  /** @brief Get number of records in a block */
+  uint32_t getNumRecords(uint32_t BlockIdx) const { return getBlockHeader(BlockIdx)->NumRecords; }
+
+  /** @brief Get block header */
+  const xTS_RecordFile::xBlockHeader* getBlockHeader(uint32_t BlockIdx) const
+  {
+    return reinterpret_cast<const xTS_RecordFile::xBlockHeader*>(m_Data + xTS_RecordFile::FileHeaderSize + (size_t)BlockIdx * xTS_RecordFile::getBlockSize());
+  }
+
+  /**
+   * @brief Get column array of a block (scan a single field at memory bandwidth)
+   * @return Pointer to BlockCapacity elements of getColumn(ColumnIdx).ElementSize bytes
+   */
+  const uint8_t* getColumnData(uint32_t BlockIdx, uint32_t ColumnIdx) const
+  {
+    return reinterpret_cast<const uint8_t*>(getBlockHeader(BlockIdx)) + xTS_RecordFile::getColumn(ColumnIdx).BlockOffset;
+  }
+
+  /**
+   * @brief Gather one record into row form
+   */
+  void getRecord(uint32_t BlockIdx, uint32_t RecordIdx, xTS_PacketRecord& Record) const;
+};
@@ -0,0 +1,133 @@
+/**
+ * @file tsSPSCRing.h
+ * @brief Bounded lock-free single-producer/single-consumer ring
+ *
+ * Connects two pipeline stages running on their own threads. The producer only
+ * writes the tail index and the consumer only writes the head index, so a transfer
+ * costs two atomic stores and no lock. A stage which finds the ring full (producer)
+ * or empty (consumer) spins briefly, then sleeps in short steps; these waits and the
+ * ring occupancy are counted, which shows the slower side of the ring.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+/**
+ * @class xTS_SPSCRing
+ * @brief Fixed capacity FIFO of items passed from exactly one producer thread to exactly one consumer thread
+ *
+ * @tparam T Item type (typically a pointer to a recycled block)
+ */
+template<class T>
+class xTS_SPSCRing
+{
+protected:
+  /** @brief Busy polls before a waiting side starts to sleep */
+  static constexpr uint32_t NumSpins = 64;
+
+  std::vector<T>                     m_Slots;
+  uint64_t                           m_Mask;             ///< Capacity - 1 (capacity is a power of 2)
+
+  alignas(64) std::atomic<uint64_t>  m_Head;             ///< Next item to pop (written by the consumer)
+  alignas(64) std::atomic<uint64_t>  m_Tail;             ///< Next free slot (written by the producer)
+
+  // === Producer statistics ===
+  alignas(64) uint64_t               m_NumPushed;
+  uint64_t                           m_NumPushWaits;     ///< Pushes which found the ring full
+  uint64_t                           m_OccupancySum;     ///< Sum of occupancies seen by pushes
+
+  // === Consumer statistics ===
+  alignas(64) uint64_t               m_NumPopWaits;      ///< Pops which found the ring empty
+
+public:
+  /**
+   * @brief Constructor
+   * @param Capacity Number of slots (rounded up to a power of 2)
+   */
+  explicit xTS_SPSCRing(uint32_t Capacity)
+    : m_Head(0), m_Tail(0), m_NumPushed(0), m_NumPushWaits(0), m_OccupancySum(0), m_NumPopWaits(0)
+  {
+    uint64_t Size = 1;
+    while(Size < Capacity) Size <<= 1;
+    m_Slots.resize(Size);
+    m_Mask = Size - 1;
+  }
+
+  /**
+   * @brief Append item if there is a free slot (producer)
+   * @return False if the ring is full
+   */
+  bool TryPush(const T& Item)
+  {
+    const uint64_t Tail = m_Tail.load(std::memory_order_relaxed);
+    const uint64_t Head = m_Head.load(std::memory_order_acquire);
+    if(Tail - Head > m_Mask) return false;
+    m_Slots[Tail & m_Mask] = Item;
+    m_Tail.store(Tail + 1, std::memory_order_release);
+    m_NumPushed++;
+    m_OccupancySum += Tail + 1 - Head;
+    return true;
+  }
+
+  /**
+   * @brief Take the oldest item if there is one (consumer)
+   * @return False if the ring is empty
+   */
+  bool TryPop(T& Item)
+  {
+    const uint64_t Head = m_Head.load(std::memory_order_relaxed);
+    const uint64_t Tail = m_Tail.load(std::memory_order_acquire);
+    if(Head == Tail) return false;
+    Item = m_Slots[Head & m_Mask];
+    m_Head.store(Head + 1, std::memory_order_release);
+    return true;
+  }
+
+  /** @brief Append item, waiting while the ring is full (producer) */
+  void Push(const T& Item)
+  {
+    if(TryPush(Item)) return;
+    m_NumPushWaits++;
+    for(uint32_t Attempt = 0; !TryPush(Item); Attempt++) { xBackoff(Attempt); }
+  }
+
+  /** @brief Take the oldest item, waiting while the ring is empty (consumer) */
+  T Pop()
+  {
+    T Item;
+    if(TryPop(Item)) return Item;
+    m_NumPopWaits++;
+    for(uint32_t Attempt = 0; !TryPop(Item); Attempt++) { xBackoff(Attempt); }
+    return Item;
+  }
+
+  /** @brief Get number of slots */
+  uint32_t getCapacity() const { return static_cast<uint32_t>(m_Mask + 1); }
+
+  /** @brief Get number of pushed items */
+  uint64_t getNumPushed() const { return m_NumPushed; }
+
+  /** @brief Get number of pushes which waited for a free slot (consumer slower than producer) */
+  uint64_t getNumPushWaits() const { return m_NumPushWaits; }
+
+  /** @brief Get number of pops which waited for an item (producer slower than consumer) */
+  uint64_t getNumPopWaits() const { return m_NumPopWaits; }
+
+  /** @brief Get mean number of queued items right after a push */
+  double getAverageOccupancy() const { return m_NumPushed ? static_cast<double>(m_OccupancySum) / m_NumPushed : 0.0; }
+
+protected:
+  static void xBackoff(uint32_t Attempt)
+  {
+    if(Attempt < NumSpins) std::this_thread::yield();
+    else                   std::this_thread::sleep_for(std::chrono::microseconds(50));
+  }
+};
@@ -0,0 +1,157 @@
+/**
+ * @file tsSyncScanner.h
+ * @brief Transport Stream sync byte acquisition and re-synchronisation
+ *
+ * A Transport Stream is aligned when the sync byte (0x47) appears at every packet
+ * stride. Truncated, spliced or damaged captures break that alignment; without
+ * re-synchronisation every following packet would fail to parse. The scanner searches
+ * for an offset where the sync byte repeats at packet stride for NumConfirm
+ * consecutive packets (lock) and reports the byte range which had to be skipped.
+ *
+ * The search kernel compares 32 (AVX2) or 16 (SSE2) candidate offsets at once: the
+ * bytes at offsets p, p+Stride, p+2*Stride, ... are loaded as vectors, compared to 0x47
+ * and AND-ed, so a single movemask yields all offsets confirmed by every probe.
+ * The kernel is selected at runtime based on CPU features, with a scalar fallback.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+
+/**
+ * @class xTS_SyncScanner
+ * @brief Finds sync lock positions and tracks lost byte ranges
+ *
+ * Usage in the packet loop: while the stream is locked packets are parsed normally.
+ * When a packet does not start with 0x47, Resync() is called with the remaining
+ * bytes. It either finds a new lock (isLocked() becomes true and getLostRange*()
+ * describe the skipped bytes) or consumes the bytes proven not to contain a lock and
+ * asks for more data.
+ */
+class xTS_SyncScanner
+{
+public:
+  /** @brief Sync byte value of every Transport Stream packet */
+  static constexpr uint8_t SyncByte = 0x47;
+
+  /** @brief Default number of consecutive sync bytes required for lock */
+  static constexpr uint32_t DefaultNumConfirm = 5;
+
+  /**
+   * @enum eKernel
+   * @brief Implementation of the candidate search kernel
+   */
+  enum class eKernel : int32_t
+  {
+    Auto   = 0,  ///< Best kernel supported by the CPU
+    Scalar    ,  ///< Portable byte-by-byte search
+    SSE2      ,  ///< 16 candidates per iteration
+    AVX2      ,  ///< 32 candidates per iteration
+  };
+
+protected:
+  // === Configuration ===
+  uint32_t m_Stride;          ///< Packet stride in bytes (188 for plain TS)
+  uint32_t m_NumConfirm;      ///< Number of consecutive sync bytes required for lock
+  eKernel  m_Kernel;          ///< Selected search kernel
+
+  // === State ===
+  bool     m_Locked;          ///< Stream is aligned
+  uint64_t m_LossBegin;       ///< Absolute offset where the current loss started
+  uint64_t m_LossEnd;         ///< Absolute offset where the last loss ended (lock position)
+
+  // === Statistics ===
+  uint64_t m_NumSyncLosses;   ///< Number of times lock was lost
+  uint64_t m_NumLostBytes;    ///< Total number of skipped bytes
+
+public:
+  /**
+   * @brief Constructor
+   * @param Stride     Packet stride in bytes
+   * @param NumConfirm Number of consecutive sync bytes required for lock (at least 1)
+   * @param Kernel     Search kernel (Auto selects the fastest supported one)
+   */
+  xTS_SyncScanner(uint32_t Stride = 188, uint32_t NumConfirm = DefaultNumConfirm, eKernel Kernel = eKernel::Auto);
+
+  /**
+   * @brief Reset to locked state and clear statistics
+   */
+  void Reset();
+
+  /**
+   * @brief Continue with the state of a scanner which processed the following part of the stream
+   *
+   * Used to join scanners of consecutive chunks parsed in parallel: lock state and
+   * lost range are taken over, statistics are accumulated.
+   *
+   * @param Following Scanner which started locked at the position this scanner stopped
+   */
+  void Append(const xTS_SyncScanner& Following);
+
+  /**
+   * @brief Search for the next lock position
+   *
+   * Must be called with Data pointing to a position which does not carry a sync byte
+   * (or at the start of an unaligned input). If the stream was locked, the loss is
+   * started at Position.
+   *
+   * @param Data       Remaining input bytes
+   * @param Size       Number of bytes at Data
+   * @param Position   Absolute stream offset of Data
+   * @param EndOfInput True if no more data follows (lock may be confirmed by fewer packets)
+   * @return Number of bytes to skip. If isLocked() is true the stream is aligned at
+   *         Data + returned value, otherwise the caller should drop the returned number
+   *         of bytes and call again with more data.
+   */
+  size_t Resync(const uint8_t* Data, size_t Size, uint64_t Position, bool EndOfInput);
+
+  /**
+   * @brief Find the first offset confirmed by NumConfirm sync bytes at Stride
+   *
+   * Only candidates p with p + (NumConfirm-1)*Stride < Size are examined.
+   *
+   * @param Data Input bytes
+   * @param Size Number of bytes at Data
+   * @return Offset of the first lock candidate, or NOT_VALID if there is none
+   */
+  int64_t FindLock(const uint8_t* Data, size_t Size) const;
+
+  /** @brief Check whether stream is aligned */
+  bool     isLocked() const { return m_Locked; }
+
+  /** @brief Get absolute offset of the first byte of the last (or current) loss */
+  uint64_t getLostRangeBegin() const { return m_LossBegin; }
+
+  /** @brief Get absolute offset following the last skipped byte of the last loss */
+  uint64_t getLostRangeEnd() const { return m_LossEnd; }
+
+  /** @brief Get number of sync losses */
+  uint64_t getNumSyncLosses() const { return m_NumSyncLosses; }
+
+  /** @brief Get total number of skipped bytes */
+  uint64_t getNumLostBytes() const { return m_NumLostBytes; }
+
+  /** @brief Get name of the selected search kernel */
+  const char* getKernelName() const;
+
+  /**
+   * @brief Detect packet layout (188/192/204) from the beginning of the input
+   *
+   * For every layout the first sync lock at its stride is searched; the layout whose
+   * first packet starts earliest wins (TS188 on ties and when nothing locks).
+   *
+   * @param Data Start of the input
+   * @param Size Number of bytes at Data (a few kB are sufficient)
+   * @return Detected packet layout
+   */
+  static xTS_PacketFormat ProbeFormat(const uint8_t* Data, size_t Size);
+
+protected:
+  static size_t xFindLockScalar(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm);
+  static size_t xFindLockSSE2  (const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm);
+  static size_t xFindLockAVX2  (const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm);
+};
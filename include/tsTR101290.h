@@ -0,0 +1,270 @@
+/**
+ * @file tsTR101290.h
+ * @brief ETSI TR 101 290 priority 1/2/3 measurement engine
+ *
+ * Evaluates the transport stream indicators of TR 101 290 (section 5.2) in the analysis
+ * pass, from the packet records the parser produces anyway:
+ * ```
+ *   P1  1.1 TS_sync_loss      1.2 Sync_byte_error   1.3 PAT_error          1.4 Continuity_count_error
+ *       1.5 PMT_error         1.6 PID_error
+ *   P2  2.1 Transport_error   2.2 CRC_error         2.3a PCR_repetition_error
+ *       2.3b PCR_discontinuity_indicator_error      2.4 PCR_accuracy_error 2.5 PTS_error  2.6 CAT_error
+ *   P3  3.1 NIT_error         3.4 Unreferenced_PID  3.5 SDT_error          3.6 EIT_error
+ *       3.7 RST_error         3.8 TDT_error
+ * ```
+ * Not evaluated: 3.2 SI_repetition_error, 3.3 Buffer_error, 3.9 Empty_buffer_error and
+ * 3.10 Data_delay_error (they need the T-STD buffer model).
+ *
+ * Time base: a monitor clock advanced by the PCR deltas of the first PID carrying PCRs,
+ * interpolated between PCRs at the byte rate measured over the last PCR interval (the
+ * constant rate model of ISO/IEC 13818-1). PCR discontinuities do not step the clock.
+ * Timing indicators are evaluated once two PCRs have been seen.
+ *
+ * Cost per packet is O(1): a continuity counter check in a flat PID table, a PID slot
+ * lookup and a byte offset compare. Repetition timers are checked when their event
+ * occurs and swept every CheckInterval (so a table which stops completely is reported
+ * too). Only PSI/SI PIDs are assembled into sections; every section is CRC checked
+ * (no repetition cache). DVB SI checks (NIT/SDT/EIT/TDT) start with the first section
+ * on their PID, so plain MPEG-2 multiplexes are not flagged.
+ *
+ * Errors are counted per indicator in total and per window (Window ms of monitor time).
+ * Closed windows are written to a text report as one row of counters.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsTransportStream.h"
+#include "tsRecordFile.h"
+#include "psiParse.h"
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TR101290
+ * @brief Indicators and limits
+ */
+class xTS_TR101290
+{
+public:
+  enum class eIndicator : uint8_t
+  {
+    TS_SyncLoss        = 0,
+    SyncByte           ,
+    PAT                ,
+    ContinuityCount    ,
+    PMT                ,
+    PID                ,
+    Transport          ,
+    CRC                ,
+    PCR_Repetition     ,
+    PCR_Discontinuity  ,
+    PCR_Accuracy       ,
+    PTS                ,
+    CAT                ,
+    NIT                ,
+    UnreferencedPID    ,
+    SDT                ,
+    EIT                ,
+    RST                ,
+    TDT                ,
+    NumIndicators      ,
+  };
+  static constexpr uint32_t NumIndicators = static_cast<uint32_t>(eIndicator::NumIndicators);
+
+  // === Limits [ms] (TR 101 290 section 5.2) ===
+  static constexpr uint32_t PAT_Interval           = 500;
+  static constexpr uint32_t PMT_Interval           = 500;
+  static constexpr uint32_t PID_Interval           = 5000;   ///< user specified period, typical value
+  static constexpr uint32_t PCR_Interval           = 40;
+  static constexpr uint32_t PCR_DiscontinuityLimit = 100;
+  static constexpr uint32_t PTS_Interval           = 700;
+  static constexpr uint32_t NIT_Interval           = 10000;
+  static constexpr uint32_t SDT_Interval           = 2000;
+  static constexpr uint32_t EIT_Interval           = 2000;
+  static constexpr uint32_t TDT_Interval           = 30000;
+  static constexpr uint32_t UnreferencedInterval   = 500;
+  static constexpr uint32_t PCR_AccuracyLimit      = 500;    ///< [ns]
+
+  static constexpr uint32_t CheckInterval          = 100;    ///< Period of the timer sweep [ms]
+  static constexpr uint32_t DefaultWindow          = 1000;   ///< Default report window [ms]
+
+  /** @brief Get indicator name as in TR 101 290 (e.g. "PAT_error") */
+  static const char* getName(eIndicator Indicator);
+
+  /** @brief Get indicator number as in TR 101 290 (e.g. "1.3") */
+  static const char* getNumber(eIndicator Indicator);
+
+  /** @brief Get priority (1, 2 or 3) */
+  static uint32_t getPriority(eIndicator Indicator);
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TR101290Monitor
+ * @brief Evaluates the indicators over the packet records of a stream (in stream order)
+ */
+class xTS_TR101290Monitor
+{
+public:
+  static constexpr uint32_t NumPIDs  = 8192;
+  static constexpr uint64_t NotArmed = UINT64_MAX;
+
+protected:
+  typedef xTS_TR101290::eIndicator eIndicator;
+
+  /** @brief Repetition timer - largest allowed gap between two occurrences */
+  struct xTimer
+  {
+    uint64_t Last     = NotArmed;   ///< Monitor time of the last occurrence [27 MHz] (NotArmed: not started)
+    uint64_t Limit    = 0;          ///< Largest gap [27 MHz]
+    bool     Reported = false;      ///< Current gap already counted by the sweep
+  };
+
+  /** @brief State of a PID seen in the stream */
+  struct xPIDSlot
+  {
+    uint16_t PID;
+    uint16_t RefCount      = 0;     ///< PAT/PMT entries listing the PID
+    bool     ES            = false; ///< Elementary stream carried in PES packets
+    bool     PMT           = false; ///< PMT PID listed in the PAT
+    bool     Reported      = false; ///< Unreferenced_PID counted
+    uint64_t FirstSeen     = NotArmed;
+    xTimer   Section;               ///< PAT/PMT/NIT/SDT/EIT/TDT repetition
+    eIndicator SectionIndicator = eIndicator::PAT; ///< Indicator of a late section
+    xTimer   Occurrence;            ///< PID_error (referenced elementary streams)
+    xTimer   PCR;                   ///< PCR_repetition_error
+    xTimer   PTS;                   ///< PTS_error
+    uint64_t LastPCR       = NotArmed; ///< Previous PCR value [27 MHz]
+    uint64_t LastPCROffset = 0;
+    double   PCRTicksPerByte = 0;   ///< Rate over the previous PCR interval (0: unknown)
+    std::unique_ptr<xPSI_SectionAssembler> Assembler; ///< PSI/SI PIDs only
+    std::vector<uint8_t>  LastTable;   ///< Last PAT/PMT section (change detection)
+    std::vector<uint16_t> Listed;      ///< PIDs this PAT/PMT section references
+  };
+
+  // === Configuration ===
+  std::FILE*             m_File;
+  uint64_t               m_Window;            ///< Report window [27 MHz]
+  uint32_t               m_Stride;            ///< Bytes per packet slot of the input (sync byte spacing)
+
+  // === PID state ===
+  uint8_t                m_CC[NumPIDs];       ///< Last continuity counter (bits 0-3), valid (0x80), duplicate seen (0x40)
+  uint16_t               m_SlotIdx[NumPIDs];  ///< PID -> index into m_Slots + 1 (0 = not seen)
+  std::vector<xPIDSlot>  m_Slots;
+  xTS_PacketHeader       m_Header;            ///< Header of PSI packets (section assembly)
+  xTS_AdaptationField    m_AdaptationField;
+  bool                   m_HasCAT;
+  bool                   m_CATReported;       ///< Scrambling without CAT counted
+  uint32_t               m_BadSyncRun;        ///< Consecutive packets without sync byte (--no-resync)
+
+  // === Monitor clock ===
+  int32_t                m_RefPID;            ///< PID whose PCRs drive the clock (NOT_VALID until the first PCR)
+  uint64_t               m_RefPCR;            ///< Last PCR of m_RefPID
+  uint64_t               m_RefOffset;         ///< Byte offset of that PCR
+  uint64_t               m_RefTime;           ///< Monitor time at that PCR
+  double                 m_TicksPerByte;      ///< Byte rate of the last PCR interval (0: clock not running)
+  uint64_t               m_Now;               ///< Monitor time of the current packet
+  uint64_t               m_NextCheck;         ///< Monitor time of the next sweep
+  uint64_t               m_NextCheckOffset;   ///< Byte offset where the next sweep is due (estimated at the current byte rate)
+
+  // === Counters ===
+  uint64_t               m_WindowStart;       ///< Monitor time of the current window
+  uint64_t               m_NumWindows;
+  uint64_t               m_NumPackets;
+  uint64_t               m_Total [xTS_TR101290::NumIndicators];
+  uint32_t               m_Counts[xTS_TR101290::NumIndicators]; ///< Current window
+
+public:
+  xTS_TR101290Monitor();
+  ~xTS_TR101290Monitor();
+
+  /**
+   * @brief Start monitoring a stream
+   * @param FileName Window report path (nullptr: totals only)
+   * @param Window   Report window [ms]
+   * @return True on success
+   */
+  bool Open(const char* FileName, uint32_t Window = xTS_TR101290::DefaultWindow);
+
+  /**
+   * @brief Write the window in progress and close the report
+   * @return True if the report was written completely
+   */
+  bool Close();
+
+  /** @brief Set the packet slot size of the input (188, 192 or 204 - sync byte spacing) */
+  void setStride(uint32_t Stride) { m_Stride = Stride; }
+
+  /** @brief Push the report rows to the file (live input) */
+  bool Flush() { return m_File == nullptr || std::fflush(m_File) == 0; }
+
+  /**
+   * @brief Evaluate a record
+   * @param Record Packet or sync loss record
+   * @param Packet 188-byte TS packet (packet records)
+   * @param Offset Byte offset of the (source) packet
+   */
+  void AddRecord(const xTS_PacketRecord& Record, const uint8_t* Packet, uint64_t Offset)
+  {
+    if(Record.Kind != static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet)) { xAddEvent(Record); return; }
+    m_NumPackets++;
+    m_BadSyncRun = 0;
+    if(Record.Header & xTS_PacketRecord::HeaderE) xCount(eIndicator::Transport);
+    if(Record.PID == 0x1FFF) return; // null packets carry no continuity and no timing
+
+    if(m_TicksPerByte > 0)
+    {
+      const uint64_t Now = m_RefTime + static_cast<uint64_t>(static_cast<double>(Offset - m_RefOffset) * m_TicksPerByte);
+      if(Now > m_Now) m_Now = Now; // the clock never steps back when the byte rate changes
+    }
+    xCheckContinuity(Record);
+    uint16_t SlotIdx = m_SlotIdx[Record.PID];
+    if(SlotIdx == 0) SlotIdx = xAddSlot(Record.PID);
+    xPIDSlot& Slot = m_Slots[SlotIdx - 1];
+    if(Record.hasPCR()) xAddPCR(Slot, Record, Offset);
+    if(Slot.Assembler || Slot.ES || Record.getTSC()) xAddPacket(Slot, Record, Packet);
+    else if(Slot.Occurrence.Last != NotArmed) xHit(Slot.Occurrence, eIndicator::PID);
+    if(Offset >= m_NextCheckOffset) xSweep();
+  }
+
+  uint64_t getTotal     (eIndicator Indicator) const { return m_Total[static_cast<uint32_t>(Indicator)]; }
+  uint64_t getNumWindows() const { return m_NumWindows; }
+  uint64_t getNumPackets() const { return m_NumPackets; }
+  uint32_t getNumPIDs   () const { return static_cast<uint32_t>(m_Slots.size()); }
+  int32_t  getRefPID    () const { return m_RefPID; }
+
+protected:
+  void xCount(eIndicator Indicator, uint32_t Count = 1) { m_Counts[static_cast<uint32_t>(Indicator)] += Count; m_Total[static_cast<uint32_t>(Indicator)] += Count; }
+
+  bool xIsRunning() const { return m_TicksPerByte > 0; }
+
+  /** @brief Start a timer at the current monitor time (once the clock runs) */
+  void xArm(xTimer& Timer, uint32_t Limit);
+
+  /** @brief Count a gap longer than the limit of an armed timer (unless the sweep did) and restart it */
+  void xHit(xTimer& Timer, eIndicator Indicator);
+
+  /** @brief Count a gap in progress longer than the timer limit once */
+  void xCheck(xTimer& Timer, eIndicator Indicator);
+
+  static uint64_t xTicks(uint32_t Milliseconds) { return static_cast<uint64_t>(Milliseconds) * xTS::ExtendedClockFrequency_Hz / 1000; }
+
+  uint16_t xAddSlot(uint16_t PID);
+  void     xAddEvent(const xTS_PacketRecord& Record);
+  void     xCheckContinuity(const xTS_PacketRecord& Record);
+  void     xAddPCR(xPIDSlot& Slot, const xTS_PacketRecord& Record, uint64_t Offset);
+  void     xStartClock();
+  void     xAddPacket(xPIDSlot& Slot, const xTS_PacketRecord& Record, const uint8_t* Packet);
+  bool     xOnSection(int32_t PID, const uint8_t* Section, uint32_t Size);
+  void     xUpdateReferences(xPIDSlot& Slot, std::vector<uint16_t>&& Listed);
+  void     xSweep();
+  void     xWriteWindow();
+};
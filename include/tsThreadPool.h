@@ -0,0 +1,62 @@
+/**
+ * @file tsThreadPool.h
+ * @brief Fixed size pool of worker threads executing queued tasks
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class xTS_ThreadPool
+ * @brief Worker threads taking tasks from a shared FIFO queue
+ *
+ * Tasks are started in submission order; each submission returns a future which
+ * becomes ready when the task has finished.
+ */
+class xTS_ThreadPool
+{
+protected:
+  std::vector<std::thread>                     m_Threads;
+  std::deque<std::packaged_task<void()>>       m_Tasks;      ///< Queued tasks
+  std::mutex                                   m_Mutex;
+  std::condition_variable                      m_Condition;  ///< Signalled when a task is queued or on stop
+  bool                                         m_Stop;
+
+public:
+  /**
+   * @brief Start worker threads
+   * @param NumThreads Number of worker threads (at least 1)
+   */
+  explicit xTS_ThreadPool(uint32_t NumThreads);
+
+  /**
+   * @brief Finish queued tasks and join worker threads
+   */
+  ~xTS_ThreadPool();
+
+  /**
+   * @brief Queue task for execution
+   * @return Future becoming ready when the task has finished
+   */
+  std::future<void> Submit(std::function<void()> Task);
+
+  /** @brief Get number of worker threads */
+  uint32_t getNumThreads() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+  /** @brief Get number of hardware threads (at least 1) */
+  static uint32_t getNumHardwareThreads();
+
+protected:
+  void xWorkerLoop();
+};
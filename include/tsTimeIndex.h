@@ -0,0 +1,232 @@
+/**
+ * @file tsTimeIndex.h
+ * @brief PCR time index sidecar (time -> byte offset) for random access into captures
+ *
+ * While a capture is analyzed, the PCRs of one PCR PID are recorded against the byte
+ * offsets of the packets carrying them. PCR wraps (every 2^33 * 300 ticks, ~26.5 h)
+ * are unfolded into a continuous 64-bit 27 MHz time line. One entry is kept per
+ * configurable interval, so a multi-hour recording needs a few hundred kB.
+ *
+ * File layout (little endian):
+ * ```
+ *   0  | File header (64 bytes): magic, version, PCR PID, interval, number of entries
+ *   64 | Entries: { uint64 Time (unwrapped PCR, 27 MHz), uint64 Offset (packet start) }
+ * ```
+ * Entries are sorted by time and offset, so a mapped file is binary searched in place.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsCommon.h"
+#include "tsMappedFile.h"
+#include <cstdio>
+#include <vector>
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TimeIndex
+ * @brief Time index file layout and PCR time line constants
+ */
+class xTS_TimeIndex
+{
+public:
+  static constexpr char     Magic[8]        = { 'T', 'S', 'T', 'I', 'M', 'E', 'I', 'X' };
+  static constexpr uint32_t Version         = 1;
+  static constexpr uint64_t ClockRate       = 27000000;            ///< PCR ticks per second
+  static constexpr uint64_t PCR_Range       = (1ull << 33) * 300;  ///< PCR wraps after this many ticks
+  static constexpr uint32_t DefaultInterval = 100;                 ///< Default entry interval [ms]
+
+  /** @brief File header */
+  struct xFileHeader
+  {
+    char     Magic[8];
+    uint32_t Version;
+    uint32_t EntrySize;      ///< sizeof(xEntry)
+    uint32_t PCR_PID;        ///< PID whose PCRs are indexed
+    uint32_t Interval;       ///< Minimal distance between entries [ms]
+    uint64_t NumEntries;
+    uint8_t  Reserved[32];
+  };
+
+  /** @brief Index entry */
+  struct xEntry
+  {
+    uint64_t Time;           ///< Unwrapped PCR (27 MHz)
+    uint64_t Offset;         ///< Byte offset of the packet carrying the PCR
+  };
+
+  static_assert(sizeof(xFileHeader) == 64, "time index header must stay 64 bytes");
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_PCRTimeline
+ * @brief Continuous 27 MHz time line of the PCRs of one PID
+ *
+ * The first PID carrying a PCR is followed unless a PID is selected. A PCR lower than
+ * the previous one by more than half the PCR range is taken as a wrap.
+ */
+class xTS_PCRTimeline
+{
+protected:
+  int32_t  m_PID;      ///< Followed PID (NOT_VALID until the first PCR)
+  uint64_t m_LastPCR;  ///< Previous PCR of the followed PID
+  uint64_t m_Wraps;    ///< Number of PCR wraps seen
+  bool     m_HasPCR;
+
+public:
+  explicit xTS_PCRTimeline(int32_t PID = NOT_VALID) { Reset(PID); }
+
+  /** @brief Forget all PCRs, follow PID (NOT_VALID for the first PID carrying a PCR) */
+  void Reset(int32_t PID = NOT_VALID) { m_PID = PID; m_LastPCR = 0; m_Wraps = 0; m_HasPCR = false; }
+
+  /**
+   * @brief Follow a PCR
+   * @param PID PID of the packet
+   * @param PCR PCR value (base * 300 + extension)
+   * @return False if the PCR belongs to another PID
+   */
+  bool Update(uint16_t PID, uint64_t PCR)
+  {
+    if(m_PID != (int32_t)PID)
+    {
+      if(m_PID != NOT_VALID) return false;
+      m_PID = PID;
+    }
+    if(m_HasPCR && PCR < m_LastPCR && m_LastPCR - PCR > xTS_TimeIndex::PCR_Range / 2) m_Wraps++;
+    m_LastPCR = PCR;
+    m_HasPCR  = true;
+    return true;
+  }
+
+  int32_t  getPID    () const { return m_PID; }
+  bool     hasPCR    () const { return m_HasPCR; }
+  uint64_t getLastPCR() const { return m_LastPCR; }
+
+  /** @brief Get unwrapped time of the last PCR [27 MHz] */
+  uint64_t getTime   () const { return m_Wraps * xTS_TimeIndex::PCR_Range + m_LastPCR; }
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TimeIndexWriter
+ * @brief Collects PCR entries during analysis and writes the sidecar file
+ *
+ * The PCRs of one PID are unwrapped by xTS_PCRTimeline. Backward steps smaller than
+ * a wrap (discontinuities) add no entry until the time line is passed again, which
+ * keeps the entries sorted.
+ */
+class xTS_TimeIndexWriter
+{
+protected:
+  std::FILE*                          m_File;
+  xTS_PCRTimeline                     m_Timeline;     ///< Time line of the indexed PID
+  uint32_t                            m_Interval;     ///< Entry interval [ms]
+  uint64_t                            m_IntervalTicks;
+  std::vector<xTS_TimeIndex::xEntry>  m_Entries;
+  uint64_t                            m_NumFlushed;   ///< Entries already in the file
+
+public:
+  xTS_TimeIndexWriter();
+  ~xTS_TimeIndexWriter();
+
+  /**
+   * @brief Create index file
+   * @param FileName Path of the sidecar file
+   * @param Interval Minimal distance between entries [ms] (0 indexes every PCR)
+   * @param PCR_PID  Indexed PID, NOT_VALID for the first PID carrying a PCR
+   * @return True on success
+   */
+  bool Open(const char* FileName, uint32_t Interval = xTS_TimeIndex::DefaultInterval, int32_t PCR_PID = NOT_VALID);
+
+  /**
+   * @brief Write header and entries, close file
+   * @return True if the index was written completely
+   */
+  bool Close();
+
+  /**
+   * @brief Append entries added since the last flush and update the header (the file is a valid index afterwards)
+   * @return True on success
+   */
+  bool Flush();
+
+  /**
+   * @brief Record a PCR
+   * @param PID    PID of the packet
+   * @param PCR    PCR value (base * 300 + extension)
+   * @param Offset Byte offset of the packet
+   */
+  void AddPCR(uint16_t PID, uint64_t PCR, uint64_t Offset)
+  {
+    if(m_Timeline.Update(PID, PCR)) xAddEntry(m_Timeline.getTime(), Offset);
+  }
+
+  int32_t  getPCR_PID() const { return m_Timeline.getPID(); }
+  uint64_t getNumEntries() const { return m_Entries.size(); }
+
+protected:
+  void xAddEntry(uint64_t Time, uint64_t Offset);
+};
+
+//=============================================================================================================================================================================
+
+/**
+ * @class xTS_TimeIndexReader
+ * @brief Memory mapped time index with time -> offset lookups
+ *
+ * Times given to the lookups are relative to the first indexed PCR.
+ */
+class xTS_TimeIndexReader
+{
+protected:
+  xTS_MappedFile                  m_File;
+  const xTS_TimeIndex::xEntry*    m_Entries;
+  uint64_t                        m_NumEntries;
+  uint32_t                        m_PCR_PID;
+  uint32_t                        m_Interval;
+
+public:
+  xTS_TimeIndexReader();
+
+  /**
+   * @brief Map index file and validate its header
+   * @return True on success
+   */
+  bool Open(const char* FileName);
+
+  /** @brief Unmap file */
+  void Close();
+
+  uint64_t getNumEntries() const { return m_NumEntries; }
+  uint32_t getPCR_PID() const { return m_PCR_PID; }
+  uint32_t getInterval() const { return m_Interval; }
+  const xTS_TimeIndex::xEntry& getEntry(uint64_t EntryIdx) const { return m_Entries[EntryIdx]; }
+
+  /** @brief Get time span between the first and the last entry [27 MHz] */
+  uint64_t getDuration() const { return m_NumEntries ? m_Entries[m_NumEntries - 1].Time - m_Entries[0].Time : 0; }
+
+  /**
+   * @brief Find where to start reading to see everything from a point in time
+   * @param Time Time since the first PCR [27 MHz]
+   * @return Offset of the last entry at or before Time (0 if Time precedes the index)
+   */
+  uint64_t FindStartOffset(uint64_t Time) const;
+
+  /**
+   * @brief Find where to stop reading after a point in time
+   * @param Time Time since the first PCR [27 MHz]
+   * @return Offset of the first entry after Time, UINT64_MAX if there is none
+   */
+  uint64_t FindEndOffset(uint64_t Time) const;
+
+protected:
+  /** @brief Index of the first entry later than Time (binary search) */
+  uint64_t xUpperBound(uint64_t Time) const;
+};
@@ -72,6 +72,15 @@ public:
   /** @brief Length of basic PES packet header in bytes (fixed at 6 bytes) */
   static constexpr uint32_t PES_HeaderLength = 6;
 
+  /** @brief Length of M2TS (Blu-ray/AVCHD) source packet: TP_extra_header followed by TS packet */
+  static constexpr uint32_t M2TS_PacketLength = 192;
+
+  /** @brief Length of M2TS TP_extra_header (copy permission + 30-bit arrival timestamp) */
+  static constexpr uint32_t M2TS_HeaderLength = 4;
+
+  /** @brief Length of TS packet followed by 16 Reed-Solomon parity bytes (DVB-ASI/SPI) */
+  static constexpr uint32_t RS_PacketLength  = 204;
+
   /** @brief Base clock frequency for PCR timestamps in Hz (90 kHz) */
   static constexpr uint32_t BaseClockFrequency_Hz         =    90000;
   
@@ -90,6 +99,71 @@ public:
 
 //=============================================================================================================================================================================
 
+/**
+ * @class xTS_PacketFormat
+ * @brief Layout of the packets stored in a Transport Stream file
+ *
+ * The 188-byte TS packet itself never changes, but recordings may wrap it:
+ * - TS188   : plain ISO/IEC 13818-1 packets
+ * - M2TS192 : Blu-ray/AVCHD source packets - 4-byte TP_extra_header with a 27 MHz
+ *             arrival_time_stamp precedes every TS packet
+ * - RS204   : DVB-ASI/SPI captures - 16 Reed-Solomon parity bytes follow every TS packet
+ *
+ * The packet parsers always receive a pointer to the 188-byte TS packet
+ * (source packet + getPrefixLength()); only the stride between packets differs.
+ */
+class xTS_PacketFormat
+{
+public:
+  /**
+   * @enum eFormat
+   * @brief Supported packet layouts
+   */
+  enum class eFormat : uint8_t
+  {
+    TS188   = 0,  ///< Plain 188-byte packets
+    M2TS192    ,  ///< 4-byte arrival timestamp prefix + 188-byte packet
+    RS204      ,  ///< 188-byte packet + 16 Reed-Solomon bytes
+  };
+
+protected:
+  eFormat m_Format;  ///< Selected layout
+
+public:
+  xTS_PacketFormat(eFormat Format = eFormat::TS188) : m_Format(Format) {}
+
+  /** @brief Get packet layout */
+  eFormat getFormat() const { return m_Format; }
+
+  /** @brief Get distance between consecutive packets in bytes */
+  uint32_t getStride() const
+  {
+    return m_Format == eFormat::M2TS192 ? xTS::M2TS_PacketLength : m_Format == eFormat::RS204 ? xTS::RS_PacketLength : xTS::TS_PacketLength;
+  }
+
+  /** @brief Get number of bytes preceding the TS packet (sync byte offset) */
+  uint32_t getPrefixLength() const { return m_Format == eFormat::M2TS192 ? xTS::M2TS_HeaderLength : 0; }
+
+  /** @brief Get human readable layout name */
+  const char* getName() const
+  {
+    return m_Format == eFormat::M2TS192 ? "M2TS-192" : m_Format == eFormat::RS204 ? "RS-204" : "TS-188";
+  }
+
+  /**
+   * @brief Extract arrival_time_stamp from M2TS TP_extra_header
+   * @param SourcePacket Pointer to the 4-byte TP_extra_header
+   * @return 30-bit arrival timestamp in 27 MHz units
+   */
+  static uint32_t getArrivalTimestamp(const uint8_t* SourcePacket)
+  {
+    return ((uint32_t)(SourcePacket[0] & 0x3F) << 24) | ((uint32_t)SourcePacket[1] << 16) |
+           ((uint32_t)SourcePacket[2] << 8) | (uint32_t)SourcePacket[3];
+  }
+};
+
+//=============================================================================================================================================================================
+
 /**
  * @class xTS_PacketHeader
  * @brief Transport Stream packet header parser and container
@@ -417,4 +491,4 @@ public:
    * packet length when there isn't enough data to fill the entire TS packet.
    */
   int32_t getStuffingBytes() const;
-};
\ No newline at end of file
+};
\ No newline at end of file
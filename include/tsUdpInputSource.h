@@ -0,0 +1,153 @@
+/**
+ * @file tsUdpInputSource.h
+ * @brief Network input source receiving a Transport Stream over UDP (optionally RTP encapsulated)
+ *
+ * IPTV head-ends and contribution links carry TS as UDP datagrams of 7 packets (1316
+ * bytes), either raw or behind an RTP header (RFC 2250 / SMPTE 2022-2). At 100 Mbit/s
+ * this is roughly 10000 datagrams per second, so the receiver pulls up to BatchSize
+ * datagrams with a single recvmmsg() call (Linux; one recv() per datagram elsewhere)
+ * straight into its block buffer and compacts the payloads in place. The packet loop
+ * then walks the block exactly like file input.
+ *
+ * Input names:
+ * ```
+ *   udp://[@][<address>]:<port>   raw TS, RTP is detected per datagram (first byte is not 0x47)
+ *   rtp://[@][<address>]:<port>   RTP header is always stripped
+ * ```
+ * A multicast address joins the group (on Config.Interface if given), a unicast address
+ * selects the local address to bind, no address receives on all interfaces.
+ *
+ * Loss is reported three ways: gaps in the RTP sequence numbers, datagrams the kernel
+ * dropped because the socket receive buffer was full (SO_RXQ_OVFL, Linux) and datagrams
+ * larger than MaxDatagramSize. The receive buffer is sized at Open(); raising it beyond
+ * net.core.rmem_max requires CAP_NET_ADMIN.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#pragma once
+#include "tsInputSource.h"
+#include <vector>
+
+/**
+ * @class xTS_UdpInputSource
+ * @brief Live input source receiving datagrams in batches into a block buffer
+ *
+ * The buffer holds BlockSize bytes plus BatchSize slots of MaxDatagramSize bytes, so a
+ * whole batch can always be received behind the bytes not consumed yet. Payloads are
+ * moved down to the end of the stream data right after each batch.
+ *
+ * Request() waits (in PollInterval slices) until MinBytes arrived. It returns fewer bytes
+ * only after RequestStop() or when nothing arrived for the idle timeout. The idle callback
+ * runs once per wait, after the first PollInterval without data. Datagrams which
+ * arrive out of order are passed on as received (the parser reports the continuity
+ * errors), only counted.
+ */
+class xTS_UdpInputSource : public xTS_InputSource
+{
+public:
+  /** @brief Datagrams received by a single system call */
+  static constexpr uint32_t BatchSize = 256;
+
+  /** @brief Largest datagram accepted (jumbo frame), longer ones are dropped */
+  static constexpr size_t MaxDatagramSize = 9216;
+
+  /** @brief Longest single wait for data before the stop flag and timeout are checked [ms] */
+  static constexpr uint32_t PollInterval = 100;
+
+  /** @brief RTP header length without CSRCs and extension */
+  static constexpr size_t RTP_HeaderLength = 12;
+
+protected:
+  // === Configuration ===
+  size_t      m_BlockSize;         ///< Stream bytes kept in the buffer
+  uint32_t    m_IdleTimeout;       ///< Stop after nothing arrived for this long [s] (0: never)
+  uint32_t    m_RecvBufferSize;    ///< Requested socket receive buffer
+  const char* m_Interface;         ///< Interface address joining a multicast group (nullptr: any)
+  bool        m_ForceRTP;          ///< rtp:// - every datagram carries an RTP header
+
+  // === Socket and buffer ===
+  int         m_Socket;
+  std::shared_ptr<uint8_t> m_BufferRef; ///< Ownership of m_Buffer (shared with block references)
+  uint8_t*    m_Buffer;            ///< BlockSize + BatchSize * MaxDatagramSize bytes
+  size_t      m_BufferSize;
+  bool        m_EndOfInput;
+  std::vector<uint32_t> m_Lengths; ///< Length of each datagram of the last batch
+  std::vector<uint8_t>  m_Truncated; ///< Datagram of the last batch exceeded MaxDatagramSize
+
+  // === RTP state ===
+  bool        m_HasSequence;       ///< An RTP packet was received
+  uint16_t    m_NextSequence;      ///< Expected RTP sequence number
+
+  // === Statistics ===
+  uint32_t    m_ActualBufferSize;  ///< Socket receive buffer reported by the kernel
+  uint64_t    m_NumDatagrams;      ///< Datagrams received
+  uint64_t    m_NumCalls;          ///< Receive system calls returning data
+  uint64_t    m_NumWaits;          ///< Times the receiver waited for data
+  uint64_t    m_NumRTP;            ///< Datagrams carrying an RTP header
+  uint64_t    m_NumLost;           ///< RTP packets missing in the sequence
+  uint64_t    m_NumReordered;      ///< RTP packets arriving behind a later one
+  uint64_t    m_NumInvalid;        ///< Datagrams dropped as truncated or malformed
+  uint64_t    m_NumKernelDrops;    ///< Datagrams dropped by the kernel (full receive buffer)
+
+public:
+  /**
+   * @brief Constructor
+   * @param BlockSize      Stream bytes kept in the buffer
+   * @param IdleTimeout    Stop after nothing arrived for this many seconds (0: receive until stopped)
+   * @param RecvBufferSize Requested socket receive buffer in bytes
+   * @param Interface      Address of the interface joining a multicast group (nullptr: any)
+   */
+  xTS_UdpInputSource(size_t BlockSize, uint32_t IdleTimeout, uint32_t RecvBufferSize, const char* Interface);
+  ~xTS_UdpInputSource() override;
+
+  /** @brief Check whether the platform provides BSD sockets */
+  static bool isSupported();
+
+  /** @brief Check whether an input name selects this source (udp:// or rtp://) */
+  static bool isURL(const char* FileName);
+
+  /**
+   * @brief Create the socket, size its receive buffer, bind and join the multicast group
+   * @param FileName udp:// or rtp:// input name
+   * @return True on success
+   */
+  bool        Open(const char* FileName) override;
+  void        Close() override;
+  size_t      Request(size_t MinBytes) override;
+  xBlockRef   getBlockRef() const override { return m_BufferRef; }
+  const char* getName() const override;
+  bool        isLive() const override { return true; }
+
+  uint32_t getActualBufferSize() const { return m_ActualBufferSize; }
+  uint64_t getNumDatagrams   () const { return m_NumDatagrams;     }
+  uint64_t getNumCalls       () const { return m_NumCalls;         }
+  uint64_t getNumWaits       () const { return m_NumWaits;         }
+  uint64_t getNumRTP         () const { return m_NumRTP;           }
+  uint64_t getNumLost        () const { return m_NumLost;          }
+  uint64_t getNumReordered   () const { return m_NumReordered;     }
+  uint64_t getNumInvalid     () const { return m_NumInvalid;       }
+  uint64_t getNumKernelDrops () const { return m_NumKernelDrops;   }
+
+protected:
+  /**
+   * @brief Receive pending datagrams into the slots behind the stream data (non-blocking)
+   * @param Slots First of BatchSize slots of MaxDatagramSize bytes
+   * @return Number of datagrams received (0 if none is pending)
+   */
+  uint32_t xReceiveBatch(uint8_t* Slots);
+
+  /**
+   * @brief Locate the TS payload of a datagram and follow its RTP sequence number
+   * @param Datagram Received datagram
+   * @param Length   Datagram length
+   * @param Payload  [out] Offset of the TS payload
+   * @return Payload length, 0 if the datagram is malformed
+   */
+  size_t xStripRTP(const uint8_t* Datagram, size_t Length, size_t& Payload);
+
+  /** @brief Wait until a datagram is pending; false once receiving stops */
+  bool xWaitForData();
+};
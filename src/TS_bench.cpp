@@ -0,0 +1,381 @@
+/**
+ * @file TS_bench.cpp
+ * @brief Micro-benchmarks of the per-packet parser hot paths (Google Benchmark)
+ *
+ * Every benchmark walks one of four synthetic packet corpora produced by xTS_Generator
+ * before the measurements, so results do not depend on local capture files:
+ * - pcr      : video PID carrying a PCR in the adaptation field of every packet
+ * - stuffing : short PES packets, one per TS packet, padded with adaptation field stuffing
+ * - video    : 256 KiB unbounded video PES packets (PTS/DTS, random access, PCR every 40 ms)
+ * - audio    : 1.5 KiB bounded audio PES packets (PTS), the last packet of each one stuffed
+ *
+ * The demuxer benchmark walks a separate 12 MiB multiplex resembling a 40 Mbit/s DVB-T2
+ * mux of 40 services: a video (16-64 KiB PES) and an audio (PTS) PID per service, PAT/PMT.
+ *
+ * Benchmarked stages:
+ * - xTS_PacketHeader::Parse
+ * - xTS_AdaptationField::Parse (packets carrying an adaptation field)
+ * - xTS_AdaptationField::getStuffingBytes (adaptation fields parsed beforehand)
+ * - xPES_PacketHeader::Parse (PES headers started in the corpus)
+ * - xPES_Assembler::AbsorbPacket (header + adaptation field + assembly, copying payload)
+ * - xPES_Demuxer::AbsorbPacket over the 80 PES PIDs of the mux (auto activation, private or
+ *   pooled assembly buffers)
+ * - xTS_CRC32 kernels (bytewise, slicing-by-8, PCLMULQDQ) over 188 B, 1 KiB and 4 KiB
+ *   sections of the video corpus
+ * - xTS_InputSource backends (mmap, buffered, io_uring) reading a generated 64 MiB file
+ *   block by block and touching every sync byte (page cache warm after the first pass)
+ *
+ * Throughput is reported as items_per_second (packets/s, PES headers/s or sections/s) and
+ * as ns_per_item, for the CRC kernels also as bytes_per_second and bytes_per_cycle (at the
+ * nominal clock of the CPU), for the input backends also as bytes_per_second. A baseline run is kept in bench/TS-PARSER-bench.json.
+ *
+ * Command line usage: ./TS-PARSER-bench [--benchmark_filter=<regex>] [--benchmark_repetitions=5] [--benchmark_out=<file> --benchmark_out_format=json]
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsCommon.h"
+#include "../include/tsTransportStream.h"
+#include "../include/tsCRC32.h"
+#include "../include/tsInputSource.h"
+#include "../include/pesParse.h"
+#include "../include/pesDemuxer.h"
+#include "../include/pesBufferPool.h"
+#include "../include/tsGenerator.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+//=============================================================================================================================================================================
+// Synthetic corpora
+//=============================================================================================================================================================================
+
+enum class eCorpus : int32_t
+{
+  PCR      = 0,
+  Stuffing ,
+  Video    ,
+  Audio    ,
+};
+
+/** @brief Number of TS packets in every corpus (3 MiB - larger than L2, the parsers stream through it) */
+static constexpr uint32_t CorpusPackets = 16384;
+
+static constexpr uint16_t CorpusPID = 0x0100;
+
+/** @brief Generates (once) and returns the packets of a corpus - a single elementary stream without PSI */
+static const std::vector<uint8_t>& GetCorpus(eCorpus Corpus)
+{
+  static std::vector<uint8_t> Corpora[4];
+  std::vector<uint8_t>& Stream = Corpora[static_cast<int32_t>(Corpus)];
+  if (!Stream.empty()) return Stream;
+
+  xTS_GeneratorConfig Config;
+  xTS_GeneratorStream ES;
+  ES.PID = CorpusPID;
+  Config.PSI_Interval = 0;
+  switch (Corpus) {
+    case eCorpus::PCR:
+      ES.MinPESSize = ES.MaxPESSize = 64 * 1024; ES.Bounded = false; ES.DTS = true; ES.RandomAccess = true;
+      Config.PCR_Interval = 0;
+      break;
+    case eCorpus::Stuffing:
+      ES.StreamType = 0x06; ES.StreamId = 0xBD; ES.MinPESSize = 24; ES.MaxPESSize = 88;
+      break;
+    case eCorpus::Video:
+      ES.MinPESSize = ES.MaxPESSize = 256 * 1024; ES.Bounded = false; ES.DTS = true; ES.RandomAccess = true;
+      break;
+    case eCorpus::Audio:
+      ES.StreamType = 0x0F; ES.StreamId = 0xC0; ES.MinPESSize = ES.MaxPESSize = 1536;
+      break;
+  }
+  Config.Streams = { ES };
+
+  xTS_Generator Generator;
+  Generator.Init(Config);
+  Stream.resize(CorpusPackets * xTS::TS_PacketLength);
+  for (uint32_t PacketIdx = 0; PacketIdx < CorpusPackets; PacketIdx++) {
+    Generator.Generate(Stream.data() + PacketIdx * xTS::TS_PacketLength); // no sync loss configured - always one packet
+  }
+  return Stream;
+}
+
+/** @brief Services of the mux corpus (one video and one audio PID each) */
+static constexpr uint32_t MuxServices = 40;
+
+/** @brief Number of TS packets in the mux corpus (12 MiB) */
+static constexpr uint32_t MuxPackets  = 65536;
+
+/** @brief Generates (once) and returns the packets of the many-PID mux corpus */
+static const std::vector<uint8_t>& GetMuxCorpus()
+{
+  static std::vector<uint8_t> Stream;
+  if (!Stream.empty()) return Stream;
+
+  xTS_GeneratorConfig Config;
+  Config.Bitrate = 40000000;
+  for (uint32_t ServiceIdx = 0; ServiceIdx < MuxServices; ServiceIdx++) {
+    xTS_GeneratorStream Video;
+    Video.PID = static_cast<uint16_t>(0x0100 + ServiceIdx);
+    Video.MinPESSize = 16 * 1024; Video.MaxPESSize = 64 * 1024; Video.Bounded = false; Video.DTS = true; Video.RandomAccess = true; Video.Weight = 9;
+    xTS_GeneratorStream Audio;
+    Audio.PID = static_cast<uint16_t>(0x0200 + ServiceIdx);
+    Audio.StreamType = 0x0F; Audio.StreamId = 0xC0; Audio.MinPESSize = 384; Audio.MaxPESSize = 1536; Audio.Weight = 1;
+    Config.Streams.push_back(Video);
+    Config.Streams.push_back(Audio);
+  }
+
+  xTS_Generator Generator;
+  Generator.Init(Config);
+  Stream.resize(MuxPackets * xTS::TS_PacketLength);
+  for (uint32_t PacketIdx = 0; PacketIdx < MuxPackets; PacketIdx++) {
+    Generator.Generate(Stream.data() + PacketIdx * xTS::TS_PacketLength);
+  }
+  return Stream;
+}
+
+/** @brief Number of TS packets in the input backend file (64 MiB) */
+static constexpr uint32_t InputFilePackets = 64 * 1024 * 1024 / xTS::TS_PacketLength;
+
+/** @brief Temporary file read by the input backend benchmarks, removed at exit */
+struct xInputFile
+{
+  std::string Path;
+  ~xInputFile() { if (!Path.empty()) std::remove(Path.c_str()); }
+};
+
+/** @brief Writes (once) the default generator multiplex to a temporary file and returns its path, empty on failure */
+static const std::string& GetInputFile()
+{
+  static xInputFile File;
+  if (!File.Path.empty()) return File.Path;
+
+  std::error_code Error;
+  const std::string Path = (std::filesystem::temp_directory_path(Error) / "TS-PARSER-bench-input.ts").string();
+  std::FILE* Output = Error ? nullptr : std::fopen(Path.c_str(), "wb");
+  if (Output == nullptr) return File.Path;
+
+  xTS_Generator Generator;
+  Generator.Init(xTS_GeneratorConfig::getDefault());
+  std::vector<uint8_t> Packet(xTS_Generator::MaxOutputSize);
+  bool Written = true;
+  for (uint32_t PacketIdx = 0; PacketIdx < InputFilePackets && Written; PacketIdx++) {
+    const uint32_t NumBytes = Generator.Generate(Packet.data());
+    Written = std::fwrite(Packet.data(), 1, NumBytes, Output) == NumBytes;
+  }
+  Written = std::fclose(Output) == 0 && Written;
+  if (!Written) { std::remove(Path.c_str()); return File.Path; }
+  File.Path = Path;
+  return File.Path;
+}
+
+/** @brief Reports the items processed per second and the time per item */
+static void SetItemCounters(benchmark::State& State, uint64_t ItemsPerIteration)
+{
+  const double NumItems = static_cast<double>(ItemsPerIteration) * static_cast<double>(State.iterations());
+  State.SetItemsProcessed(static_cast<int64_t>(NumItems));
+  State.counters["ns_per_item"] = benchmark::Counter(NumItems * 1e-9, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+//=============================================================================================================================================================================
+// Benchmarks
+//=============================================================================================================================================================================
+
+static void BM_PacketHeaderParse(benchmark::State& State, eCorpus Corpus)
+{
+  const std::vector<uint8_t>& Stream = GetCorpus(Corpus);
+  xTS_PacketHeader PacketHeader;
+  for (auto _ : State) {
+    for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+      PacketHeader.Parse(Stream.data() + Offset);
+      benchmark::DoNotOptimize(PacketHeader);
+    }
+  }
+  SetItemCounters(State, CorpusPackets);
+}
+
+static void BM_AdaptationFieldParse(benchmark::State& State, eCorpus Corpus)
+{
+  const std::vector<uint8_t>& Stream = GetCorpus(Corpus);
+  std::vector<const uint8_t*> Packets;
+  for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+    if (Stream[Offset + 3] & 0x20) Packets.push_back(Stream.data() + Offset);
+  }
+  xTS_AdaptationField AdaptationField;
+  for (auto _ : State) {
+    for (const uint8_t* Packet : Packets) {
+      AdaptationField.Reset();
+      AdaptationField.Parse(Packet + xTS::TS_HeaderLength, Packet[3] >> 4 & 0x3);
+      benchmark::DoNotOptimize(AdaptationField);
+    }
+  }
+  SetItemCounters(State, Packets.size());
+}
+
+static void BM_StuffingBytes(benchmark::State& State, eCorpus Corpus)
+{
+  const std::vector<uint8_t>& Stream = GetCorpus(Corpus);
+  std::vector<xTS_AdaptationField> AdaptationFields;
+  for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+    if (!(Stream[Offset + 3] & 0x20)) continue;
+    AdaptationFields.emplace_back();
+    AdaptationFields.back().Reset();
+    AdaptationFields.back().Parse(Stream.data() + Offset + xTS::TS_HeaderLength, Stream[Offset + 3] >> 4 & 0x3);
+  }
+  for (auto _ : State) {
+    int32_t Sum = 0;
+    for (const xTS_AdaptationField& AdaptationField : AdaptationFields) Sum += AdaptationField.getStuffingBytes();
+    benchmark::DoNotOptimize(Sum);
+  }
+  SetItemCounters(State, AdaptationFields.size());
+}
+
+static void BM_PESHeaderParse(benchmark::State& State, eCorpus Corpus)
+{
+  const std::vector<uint8_t>& Stream = GetCorpus(Corpus);
+  std::vector<const uint8_t*> Headers;
+  for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+    const uint8_t* Packet = Stream.data() + Offset;
+    if (!(Packet[1] & 0x40)) continue;
+    const size_t PayloadOffset = Packet[3] & 0x20 ? xTS::TS_HeaderLength + 1 + Packet[4] : xTS::TS_HeaderLength;
+    if (PayloadOffset + xTS::PES_HeaderLength + 13 <= xTS::TS_PacketLength) Headers.push_back(Packet + PayloadOffset);
+  }
+  xPES_PacketHeader PESH;
+  for (auto _ : State) {
+    for (const uint8_t* Header : Headers) {
+      PESH.Reset();
+      PESH.Parse(Header);
+      benchmark::DoNotOptimize(PESH);
+    }
+  }
+  SetItemCounters(State, Headers.size());
+}
+
+static void BM_AbsorbPacket(benchmark::State& State, eCorpus Corpus)
+{
+  const std::vector<uint8_t>& Stream = GetCorpus(Corpus);
+  xTS_PacketHeader    PacketHeader;
+  xTS_AdaptationField AdaptationField;
+  xPES_Assembler      Assembler;
+  Assembler.Init(CorpusPID);
+  for (auto _ : State) {
+    for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+      const uint8_t* Packet = Stream.data() + Offset;
+      PacketHeader.Parse(Packet);
+      AdaptationField.Reset();
+      if (PacketHeader.hasAdaptationField()) AdaptationField.Parse(Packet + xTS::TS_HeaderLength, PacketHeader.getAdaptationFieldControl());
+      benchmark::DoNotOptimize(Assembler.AbsorbPacket(Packet, &PacketHeader, &AdaptationField));
+    }
+  }
+  SetItemCounters(State, CorpusPackets);
+}
+
+/** @brief Size of the data the CRC sections are taken from (cache resident - the kernel, not memory, is measured) */
+static constexpr size_t CRC_DataSize = 64 * 1024;
+
+static void BM_CRC32(benchmark::State& State, xTS_CRC32::eKernel Kernel)
+{
+  const xTS_CRC32 CRC32(Kernel);
+  if (CRC32.getKernel() != Kernel) {
+    State.SkipWithError("kernel not supported by the CPU");
+    return;
+  }
+  const std::vector<uint8_t>& Stream = GetCorpus(eCorpus::Video);
+  const size_t SectionSize = static_cast<size_t>(State.range(0));
+  const size_t NumSections = CRC_DataSize / SectionSize;
+  for (auto _ : State) {
+    for (size_t SectionIdx = 0; SectionIdx < NumSections; SectionIdx++) {
+      benchmark::DoNotOptimize(CRC32.Calculate(Stream.data() + SectionIdx * SectionSize, SectionSize));
+    }
+  }
+  SetItemCounters(State, NumSections);
+  const double NumBytes = static_cast<double>(NumSections * SectionSize) * static_cast<double>(State.iterations());
+  State.SetBytesProcessed(static_cast<int64_t>(NumBytes));
+  State.counters["bytes_per_cycle"] = benchmark::Counter(NumBytes / benchmark::CPUInfo::Get().cycles_per_second, benchmark::Counter::kIsRate);
+}
+
+#define TS_BENCHMARK_CORPORA(Function)                     \
+  BENCHMARK_CAPTURE(Function, pcr,      eCorpus::PCR);      \
+  BENCHMARK_CAPTURE(Function, stuffing, eCorpus::Stuffing); \
+  BENCHMARK_CAPTURE(Function, video,    eCorpus::Video);    \
+  BENCHMARK_CAPTURE(Function, audio,    eCorpus::Audio)
+
+TS_BENCHMARK_CORPORA(BM_PacketHeaderParse);
+TS_BENCHMARK_CORPORA(BM_AdaptationFieldParse);
+TS_BENCHMARK_CORPORA(BM_StuffingBytes);
+TS_BENCHMARK_CORPORA(BM_PESHeaderParse);
+TS_BENCHMARK_CORPORA(BM_AbsorbPacket);
+
+static void BM_Demuxer(benchmark::State& State, bool Pool)
+{
+  const std::vector<uint8_t>& Stream = GetMuxCorpus();
+  xTS_PacketHeader    PacketHeader;
+  xTS_AdaptationField AdaptationField;
+  xPES_BufferPool     BufferPool;
+  xPES_Demuxer        Demuxer;
+  uint64_t            NumBytes = 0;
+  Demuxer.setAutoAdd(true);
+  Demuxer.setBufferPool(Pool ? &BufferPool : nullptr);
+  Demuxer.setCallback([&NumBytes](int32_t, const xPES_Assembler& Assembler) { NumBytes += static_cast<uint64_t>(Assembler.getNumPacketBytes()); });
+  for (auto _ : State) {
+    for (size_t Offset = 0; Offset < Stream.size(); Offset += xTS::TS_PacketLength) {
+      const uint8_t* Packet = Stream.data() + Offset;
+      PacketHeader.Parse(Packet);
+      if (!Demuxer.isInterested(PacketHeader.getPID())) continue;
+      AdaptationField.Reset();
+      if (PacketHeader.hasAdaptationField()) AdaptationField.Parse(Packet + xTS::TS_HeaderLength, PacketHeader.getAdaptationFieldControl());
+      benchmark::DoNotOptimize(Demuxer.AbsorbPacket(Packet, &PacketHeader, &AdaptationField));
+    }
+  }
+  benchmark::DoNotOptimize(NumBytes);
+  SetItemCounters(State, MuxPackets);
+  State.counters["pids"]           = Demuxer.getNumActivePIDs();
+  State.counters["pes_per_second"] = benchmark::Counter(static_cast<double>(Demuxer.getNumUnits()), benchmark::Counter::kIsRate);
+}
+
+static void BM_InputSource(benchmark::State& State, xTS_InputSource::eType Type, const char* Name)
+{
+  const std::string& Path = GetInputFile();
+  if (Path.empty()) {
+    State.SkipWithError("could not write the input file");
+    return;
+  }
+  uint64_t NumBytes = 0;
+  for (auto _ : State) {
+    std::unique_ptr<xTS_InputSource> Source = xTS_InputSource::Create(Type, Path.c_str());
+    if (!Source->Open(Path.c_str()) || strcmp(Source->getName(), Name) != 0) {
+      State.SkipWithError("backend not supported");
+      return;
+    }
+    uint8_t SyncBytes = 0;
+    while (Source->Request(xTS_InputSource::DefaultBlockSize) >= xTS::TS_PacketLength) {
+      const uint8_t* Block = Source->getData();
+      const size_t   Size  = Source->getAvailable() / xTS::TS_PacketLength * xTS::TS_PacketLength;
+      for (size_t Offset = 0; Offset < Size; Offset += xTS::TS_PacketLength) SyncBytes ^= Block[Offset];
+      Source->Consume(Size);
+      NumBytes += Size;
+    }
+    benchmark::DoNotOptimize(SyncBytes);
+    Source->Close();
+  }
+  SetItemCounters(State, InputFilePackets);
+  State.SetBytesProcessed(static_cast<int64_t>(NumBytes));
+}
+
+BENCHMARK_CAPTURE(BM_Demuxer, mux40,      false);
+BENCHMARK_CAPTURE(BM_Demuxer, mux40_pool, true);
+
+BENCHMARK_CAPTURE(BM_CRC32, bytewise, xTS_CRC32::eKernel::Bytewise)->Arg(188)->Arg(1024)->Arg(4096);
+BENCHMARK_CAPTURE(BM_CRC32, slicing8, xTS_CRC32::eKernel::Slicing8)->Arg(188)->Arg(1024)->Arg(4096);
+BENCHMARK_CAPTURE(BM_CRC32, pclmul,   xTS_CRC32::eKernel::PCLMUL  )->Arg(188)->Arg(1024)->Arg(4096);
+
+BENCHMARK_CAPTURE(BM_InputSource, mmap,     xTS_InputSource::eType::Mmap,     "mmap"    )->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_InputSource, buffered, xTS_InputSource::eType::Buffered, "buffered")->Unit(benchmark::kMillisecond);
+BENCHMARK_CAPTURE(BM_InputSource, uring,    xTS_InputSource::eType::Uring,    "io_uring")->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
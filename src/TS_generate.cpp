@@ -0,0 +1,181 @@
+/**
+ * @file TS_generate.cpp
+ * @brief Companion generator writing deterministic synthetic Transport Streams
+ *
+ * Writes a single program multiplex built by xTS_Generator (see tsGenerator.h) of a
+ * requested size. The same seed and options always produce identical files, so load
+ * tests and performance regressions can be reproduced exactly without shipping captures.
+ *
+ * Command line usage: ./TS-GENERATE <output_file> [options]   ("-" writes the standard output)
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsCommon.h"
+#include "../include/tsGenerator.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <vector>
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+//=============================================================================================================================================================================
+
+static void PrintUsage(const char* ProgramName)
+{
+  printf("Usage: %s <output_file> [options]   (\"-\" writes the standard output)\n", ProgramName);
+  printf("  --seed=<N>                  Random seed (default: 1)\n");
+  printf("  --size=<MiB>                Output size (default: 64)\n");
+  printf("  --packets=<N>               Output size in packets (overrides --size)\n");
+  printf("  --bitrate=<Mbit/s>          Multiplex bitrate, time base of PCR/PTS (default: 20)\n");
+  printf("  --stream=<PID>:video|audio|data[:<weight>[:<min>-<max>]]\n");
+  printf("                              Add an elementary stream with PES payload sizes in bytes (repeatable,\n");
+  printf("                              default: 256:video:9:16384-131072 and 257:audio:1:384-1536)\n");
+  printf("  --pcr-pid=<PID>             PID carrying PCR (default: first stream)\n");
+  printf("  --pcr-interval=<ms>         Maximum time between PCRs, 0 = every packet of the PCR PID (default: 40)\n");
+  printf("  --psi-interval=<ms>         Time between PAT/PMT repetitions, 0 = no PSI (default: 100)\n");
+  printf("  --nulls=<p>                 Probability of a null packet (default: 0)\n");
+  printf("  --stuffing=<p>[:<max>]      Probability of extra adaptation field stuffing of up to <max> bytes (default: 0:64)\n");
+  printf("  --cc-errors=<p>             Probability of a continuity counter jump (default: 0)\n");
+  printf("  --sync-loss=<p>[:<max>]     Probability of up to <max> garbage bytes before a packet (default: 0:1000)\n");
+}
+
+/**
+ * @brief Parses <PID>:video|audio|data[:<weight>[:<min>-<max>]]
+ */
+static bool ParseStream(const char* Arg, xTS_GeneratorStream& Stream)
+{
+  char* End = nullptr;
+  Stream.PID = static_cast<uint16_t>(strtoul(Arg, &End, 0));
+  if (*End != ':') return false;
+  const char* Kind = End + 1;
+  if (strncmp(Kind, "video", 5) == 0) {
+    Stream.StreamType = 0x1B; Stream.StreamId = 0xE0; Stream.Bounded = false; Stream.DTS = true; Stream.RandomAccess = true;
+    Stream.MinPESSize = 16 * 1024; Stream.MaxPESSize = 128 * 1024; Stream.Weight = 9; End = const_cast<char*>(Kind + 5);
+  } else if (strncmp(Kind, "audio", 5) == 0) {
+    Stream.StreamType = 0x0F; Stream.StreamId = 0xC0; Stream.MinPESSize = 384; Stream.MaxPESSize = 1536; End = const_cast<char*>(Kind + 5);
+  } else if (strncmp(Kind, "data", 4) == 0) {
+    Stream.StreamType = 0x06; Stream.StreamId = 0xBD; Stream.MinPESSize = 64; Stream.MaxPESSize = 1024; End = const_cast<char*>(Kind + 4);
+  } else {
+    return false;
+  }
+  if (*End == '\0') return true;
+  if (*End != ':') return false;
+  Stream.Weight = strtoul(End + 1, &End, 10);
+  if (*End == '\0') return true;
+  if (*End != ':') return false;
+  Stream.MinPESSize = strtoul(End + 1, &End, 10);
+  if (*End != '-') return false;
+  Stream.MaxPESSize = strtoul(End + 1, &End, 10);
+  return *End == '\0';
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2)
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char* OutputFileName = argv[1];
+  xTS_GeneratorConfig Config = xTS_GeneratorConfig::getDefault();
+  bool     CustomStreams = false;
+  uint64_t NumPackets    = 0;
+  uint64_t Size          = 64ull * 1024 * 1024;
+  for (int i = 2; i < argc; i++)
+  {
+    const char* Arg = argv[i];
+    char* End = nullptr;
+    if     (strncmp(Arg, "--seed=", 7) == 0) { Config.Seed = strtoull(Arg + 7, nullptr, 0); }
+    else if(strncmp(Arg, "--size=", 7) == 0) { Size = strtoull(Arg + 7, nullptr, 10) * 1024 * 1024; }
+    else if(strncmp(Arg, "--packets=", 10) == 0) { NumPackets = strtoull(Arg + 10, nullptr, 10); }
+    else if(strncmp(Arg, "--bitrate=", 10) == 0) { Config.Bitrate = static_cast<uint64_t>(strtod(Arg + 10, nullptr) * 1e6); }
+    else if(strncmp(Arg, "--pcr-pid=", 10) == 0) { Config.PCR_PID = static_cast<int32_t>(strtol(Arg + 10, nullptr, 0)); }
+    else if(strncmp(Arg, "--pcr-interval=", 15) == 0) { Config.PCR_Interval = strtoul(Arg + 15, nullptr, 10); }
+    else if(strncmp(Arg, "--psi-interval=", 15) == 0) { Config.PSI_Interval = strtoul(Arg + 15, nullptr, 10); }
+    else if(strncmp(Arg, "--nulls=", 8) == 0) { Config.NullRate = strtod(Arg + 8, nullptr); }
+    else if(strncmp(Arg, "--cc-errors=", 12) == 0) { Config.CC_ErrorRate = strtod(Arg + 12, nullptr); }
+    else if(strncmp(Arg, "--stuffing=", 11) == 0)
+    {
+      Config.StuffingRate = strtod(Arg + 11, &End);
+      if (*End == ':') Config.MaxStuffing = strtoul(End + 1, nullptr, 10);
+    }
+    else if(strncmp(Arg, "--sync-loss=", 12) == 0)
+    {
+      Config.SyncLossRate = strtod(Arg + 12, &End);
+      if (*End == ':') Config.MaxSyncLoss = strtoul(End + 1, nullptr, 10);
+    }
+    else if(strncmp(Arg, "--stream=", 9) == 0)
+    {
+      xTS_GeneratorStream Stream;
+      if (!ParseStream(Arg + 9, Stream))
+      {
+        printf("Error: Invalid stream %s\n", Arg + 9);
+        return EXIT_FAILURE;
+      }
+      if (!CustomStreams) Config.Streams.clear();
+      CustomStreams = true;
+      Config.Streams.push_back(Stream);
+    }
+    else
+    {
+      printf("Error: Unknown option %s\n", Arg);
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (NumPackets == 0) NumPackets = Size / xTS::TS_PacketLength;
+
+  xTS_Generator Generator;
+  if (!Generator.Init(Config))
+  {
+    printf("Error: Inconsistent stream configuration (PIDs, PES sizes or PCR PID)\n");
+    return EXIT_FAILURE;
+  }
+
+  const bool ToStdout = strcmp(OutputFileName, "-") == 0;
+  std::FILE* OutputFile = ToStdout ? stdout : std::fopen(OutputFileName, "wb");
+  if (OutputFile == nullptr)
+  {
+    printf("Error: Could not open file %s for writing\n", OutputFileName);
+    return EXIT_FAILURE;
+  }
+#if defined(_WIN32)
+  if (ToStdout) _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+  // Packets are collected into large blocks - one fwrite() per 4 MiB
+  constexpr size_t BlockSize = 4 * 1024 * 1024;
+  std::vector<uint8_t> Block(BlockSize + xTS_Generator::MaxOutputSize);
+  size_t   Filled   = 0;
+  uint64_t NumBytes = 0;
+  bool     Written  = true;
+  for (uint64_t PacketIdx = 0; PacketIdx < NumPackets && Written; PacketIdx++) {
+    Filled += Generator.Generate(Block.data() + Filled);
+    if (Filled >= BlockSize || PacketIdx + 1 == NumPackets) {
+      Written   = std::fwrite(Block.data(), 1, Filled, OutputFile) == Filled;
+      NumBytes += Filled;
+      Filled    = 0;
+    }
+  }
+  Written = std::fflush(OutputFile) == 0 && Written;
+  if (!ToStdout) Written = std::fclose(OutputFile) == 0 && Written;
+  if (!Written)
+  {
+    fprintf(stderr, "Error: Could not write %s\n", OutputFileName);
+    return EXIT_FAILURE;
+  }
+
+  // Summary goes to stderr, the standard output may carry the stream
+  fprintf(stderr, "Generated: packets: %" PRIu64 ", bytes: %" PRIu64 ", duration: %.3f s, PES packets: %" PRIu64
+          ", null packets: %" PRIu64 ", CC errors: %" PRIu64 ", sync losses: %" PRIu64 "\n",
+          Generator.getNumPackets(), NumBytes, Generator.getTime() / static_cast<double>(xTS::ExtendedClockFrequency_Hz),
+          Generator.getNumPES(), Generator.getNumNull(), Generator.getNumCC_Errors(), Generator.getNumSyncLosses());
+  return EXIT_SUCCESS;
+}
@@ -22,9 +22,36 @@
 #include "../include/tsCommon.h"
 #include "../include/tsTransportStream.h"
 #include "../include/pesParse.h"
+#include "../include/pesDemuxer.h"
+#include "../include/pesSink.h"
+#include "../include/psiParse.h"
+#include "../include/tsInputSource.h"
+#include "../include/tsFollowInputSource.h"
+#include "../include/tsUdpInputSource.h"
+#include "../include/tsSyncScanner.h"
+#include "../include/tsPacketBatch.h"
+#include "../include/tsOutputWriter.h"
+#include "../include/tsRecordFile.h"
+#include "../include/tsThreadPool.h"
+#include "../include/tsSPSCRing.h"
+#include "../include/tsTimeIndex.h"
+#include "../include/tsRAPIndex.h"
+#include "../include/tsTR101290.h"
+#include "../include/tsPCRAnalyzer.h"
+#include "../include/tsBitrate.h"
 #include <fstream>
 #include <iomanip>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <thread>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+#include <map>
+#include <string>
 #include <cinttypes> // For PRIu64 printf format specifier
+#include <csignal>
 
 //=============================================================================================================================================================================
 
@@ -64,6 +91,1011 @@ void SaveBinaryToTextFile(const uint8_t* data, size_t size, const std::string& o
   printf("Binary data saved to %s\n", outputFileName.c_str());
 }
 
+/**
+ * @brief Command line options of the parser application
+ */
+struct xParserOptions
+{
+  const char*                   InputFileName = nullptr;                          ///< Input Transport Stream path
+  xTS_InputSource::eType        InputType     = xTS_InputSource::eType::Auto;     ///< Input backend
+  xTS_InputConfig               InputConfig;                                      ///< Input backend tuning
+  xTS_PacketFormat::eFormat     PacketFormat  = xTS_PacketFormat::eFormat::TS188;  ///< Packet layout (when not probed)
+  bool                          ProbeFormat   = true;                             ///< Detect packet layout at open time
+  bool                          Resync        = true;                             ///< Re-acquire sync lock after sync byte loss
+  uint32_t                      SyncConfirm   = xTS_SyncScanner::DefaultNumConfirm; ///< Sync bytes required for lock
+  std::vector<int32_t>          PES_PIDs      = { 136 };                          ///< PIDs assembled into PES (audio PID, DVB standard)
+  bool                          PES_AllPIDs   = false;                            ///< Assemble every PID carrying PES
+  bool                          PES_AutoPIDs  = false;                            ///< Assemble the elementary streams listed in PMTs
+  bool                          PSI_Print     = false;                            ///< Write discovered PAT/PMT to the analysis output
+  bool                          BinaryOutput  = false;                            ///< Write analysis_output.bin records instead of text
+  bool                          PES_Pool      = false;                            ///< Share size-classed PES buffers between PIDs
+  const char*                   PES_OutPrefix = nullptr;                          ///< Write elementary streams to <prefix>_<PID>.pes
+  uint32_t                      NumThreads    = 1;                                ///< Parallel chunk parsing threads (1 = sequential)
+  bool                          Pipeline      = false;                            ///< Read, parse and format on separate threads
+  const char*                   TimeIndexFile = nullptr;                          ///< PCR time index sidecar (--time-index)
+  uint32_t                      TimeIndexInterval = xTS_TimeIndex::DefaultInterval; ///< Time index entry interval [ms]
+  bool                          TimeWindow    = false;                            ///< Analyze a time window located through the time index
+  double                        TimeFrom      = 0;                                ///< Window start [s since the first PCR]
+  double                        TimeTo        = -1;                               ///< Window end [s], negative for end of input
+  const char*                   RAPIndexFile  = nullptr;                          ///< Random access point index sidecar (--rap-index)
+  int32_t                       RAP_PID       = NOT_VALID;                        ///< PID whose RAPs start a time window (NOT_VALID: most RAPs)
+  bool                          TR101290      = false;                            ///< Evaluate TR 101 290 indicators (--tr101290)
+  const char*                   TR101290File  = nullptr;                          ///< TR 101 290 window report
+  uint32_t                      TR101290Window = xTS_TR101290::DefaultWindow;     ///< TR 101 290 report window [ms]
+  bool                          PCRAnalysis   = false;                            ///< Report PCR interval, jitter, frequency offset and drift
+  bool                          Bitrate       = false;                            ///< Measure per-PID bitrate over PCR timed windows (--bitrate)
+  const char*                   BitrateFile   = nullptr;                          ///< Bitrate time series
+  uint32_t                      BitrateWindow = xTS_BitrateMeter::DefaultWindow;  ///< Shortest bitrate window [ms]
+  bool                          DropNull      = false;                            ///< Leave null packets out of the analysis output
+  bool                          PrintStats    = false;                            ///< Print throughput summary at exit
+};
+
+/**
+ * @brief Prints command line usage
+ * @param ProgramName argv[0]
+ */
+static void PrintUsage(const char* ProgramName)
+{
+  printf("Usage: %s [options] <input_file>   (\"-\" reads the standard input, udp://[@][<addr>]:<port> or rtp://... a network stream)\n", ProgramName);
+  printf("Options:\n");
+  printf("  --input=auto|buffered|mmap|uring\n");
+  printf("                              Input backend (default: auto - mmap for regular files)\n");
+  printf("  --block-size=<KiB>          Read size of buffered/uring backends (default: 4096)\n");
+  printf("  --queue-depth=<N>           Reads kept in flight by the uring backend (default: 8)\n");
+  printf("  --direct                    Open input with O_DIRECT (uring backend)\n");
+  printf("  --follow[=<s>]              Keep parsing data appended to the file (stop on Ctrl+C or after <s> idle seconds)\n");
+  printf("  --udp-rcvbuf=<KiB>          Socket receive buffer of udp:// and rtp:// inputs (default: %u)\n", xTS_InputConfig().RecvBufferSize / 1024);
+  printf("  --udp-interface=<addr>      Address of the interface joining the multicast group (default: any)\n");
+  printf("  --udp-timeout=<s>           Stop receiving after <s> seconds without datagrams (default: on Ctrl+C only)\n");
+  printf("  --format=auto|188|192|204   Packet layout: plain TS, M2TS with timestamp prefix, TS with RS parity (default: auto)\n");
+  printf("  --sync-confirm=<N>          Consecutive sync bytes required to re-lock (default: %u)\n", xTS_SyncScanner::DefaultNumConfirm);
+  printf("  --no-resync                 Do not re-synchronise, report every misaligned packet as error\n");
+  printf("  --pes=all|auto|<PID>[,<PID>...]\n");
+  printf("                              PIDs assembled into PES packets: every PES PID, the streams listed in PMTs, or a list (default: 136)\n");
+  printf("  --pes-pool                  Draw PES buffers from a shared size-classed pool\n");
+  printf("  --pes-out=<prefix>          Write PES packets of each PID to <prefix>_<PID>.pes (zero-copy writev)\n");
+  printf("  --psi                       Write PAT/PMT contents to the analysis output when they appear or change\n");
+  printf("  --output=text|binary        Write analysis_output.txt lines or analysis_output.bin records (default: text)\n");
+  printf("  --threads=<N>               Parse chunks of a memory mapped input on N threads, 0 = all cores (default: 1)\n");
+  printf("  --pipeline                  Run reading, parsing and output formatting on separate threads\n");
+  printf("  --time-index=<file>         Write PCR time index sidecar (with --time-window: read it)\n");
+  printf("  --time-index-interval=<ms>  Time distance between index entries (default: %u)\n", xTS_TimeIndex::DefaultInterval);
+  printf("  --time-window=<from>:[<to>] Analyze only the given seconds (since the first PCR) using the time index\n");
+  printf("  --rap-index=<file>          Write per-PID random access point index (with --time-window: start at a RAP)\n");
+  printf("  --rap-pid=<PID>             PID whose random access points start a time window (default: most RAPs)\n");
+  printf("  --tr101290[=<file>]         Evaluate TR 101 290 priority 1-3 indicators (totals with --stats, per window to <file>)\n");
+  printf("  --tr101290-window=<ms>      Window of the TR 101 290 report (default: %u)\n", xTS_TR101290::DefaultWindow);
+  printf("  --pcr-analysis              Report PCR interval, jitter, frequency offset (M2TS) or bitrate, and drift per PCR PID\n");
+  printf("  --bitrate[=<file>]          Measure per-PID and multiplex bitrate (statistics with --stats, time series to <file>)\n");
+  printf("  --bitrate-window=<ms>       Shortest bitrate window, x10 and x100 windows follow (default: %u)\n", xTS_BitrateMeter::DefaultWindow);
+  printf("  --drop-null                 Leave null packets (PID 0x1FFF) out of the analysis output (still counted)\n");
+  printf("  --stats                     Print throughput summary after processing\n");
+}
+
+/**
+ * @brief Parses command line arguments into xParserOptions
+ * @return True if arguments are valid and an input file was given
+ */
+static bool ParseArguments(int argc, char* argv[], xParserOptions& Options)
+{
+  for(int i = 1; i < argc; i++)
+  {
+    const char* Arg = argv[i];
+    if     (strcmp(Arg, "--input=auto"    ) == 0) { Options.InputType = xTS_InputSource::eType::Auto;     }
+    else if(strcmp(Arg, "--input=buffered") == 0) { Options.InputType = xTS_InputSource::eType::Buffered; }
+    else if(strcmp(Arg, "--input=mmap"    ) == 0) { Options.InputType = xTS_InputSource::eType::Mmap;     }
+    else if(strcmp(Arg, "--input=uring"   ) == 0) { Options.InputType = xTS_InputSource::eType::Uring;    }
+    else if(strncmp(Arg, "--block-size=" , 13) == 0) { Options.InputConfig.BlockSize  = strtoul(Arg + 13, nullptr, 10) * 1024; }
+    else if(strncmp(Arg, "--queue-depth=", 14) == 0) { Options.InputConfig.QueueDepth = strtoul(Arg + 14, nullptr, 10); }
+    else if(strcmp(Arg, "--direct"        ) == 0) { Options.InputConfig.DirectIO = true; }
+    else if(strcmp(Arg, "--follow"        ) == 0) { Options.InputConfig.Follow = true; }
+    else if(strncmp(Arg, "--follow=", 9) == 0) { Options.InputConfig.Follow = true; Options.InputConfig.IdleTimeout = strtoul(Arg + 9, nullptr, 10); }
+    else if(strncmp(Arg, "--udp-rcvbuf=", 13) == 0) { Options.InputConfig.RecvBufferSize = static_cast<uint32_t>(strtoul(Arg + 13, nullptr, 10)) * 1024; }
+    else if(strncmp(Arg, "--udp-interface=", 16) == 0) { Options.InputConfig.Interface = Arg + 16; }
+    else if(strncmp(Arg, "--udp-timeout=", 14) == 0) { Options.InputConfig.IdleTimeout = strtoul(Arg + 14, nullptr, 10); }
+    else if(strcmp(Arg, "--format=auto"   ) == 0) { Options.ProbeFormat = true; }
+    else if(strcmp(Arg, "--format=188"    ) == 0) { Options.ProbeFormat = false; Options.PacketFormat = xTS_PacketFormat::eFormat::TS188;   }
+    else if(strcmp(Arg, "--format=192"    ) == 0) { Options.ProbeFormat = false; Options.PacketFormat = xTS_PacketFormat::eFormat::M2TS192; }
+    else if(strcmp(Arg, "--format=204"    ) == 0) { Options.ProbeFormat = false; Options.PacketFormat = xTS_PacketFormat::eFormat::RS204;   }
+    else if(strncmp(Arg, "--sync-confirm=", 15) == 0) { Options.SyncConfirm = strtoul(Arg + 15, nullptr, 10); }
+    else if(strcmp(Arg, "--no-resync"     ) == 0) { Options.Resync = false; }
+    else if(strcmp(Arg, "--stats"         ) == 0) { Options.PrintStats = true; }
+    else if(strcmp(Arg, "--pipeline"      ) == 0) { Options.Pipeline = true; }
+    else if(strncmp(Arg, "--time-index-interval=", 22) == 0) { Options.TimeIndexInterval = strtoul(Arg + 22, nullptr, 10); }
+    else if(strncmp(Arg, "--time-index=", 13) == 0) { Options.TimeIndexFile = Arg + 13; }
+    else if(strncmp(Arg, "--rap-index=", 12) == 0) { Options.RAPIndexFile = Arg + 12; }
+    else if(strncmp(Arg, "--rap-pid=", 10) == 0) { Options.RAP_PID = atoi(Arg + 10); }
+    else if(strcmp(Arg, "--tr101290"      ) == 0) { Options.TR101290 = true; }
+    else if(strncmp(Arg, "--tr101290=", 11) == 0) { Options.TR101290 = true; Options.TR101290File = Arg + 11; }
+    else if(strncmp(Arg, "--tr101290-window=", 18) == 0) { Options.TR101290Window = strtoul(Arg + 18, nullptr, 10); }
+    else if(strcmp(Arg, "--pcr-analysis"  ) == 0) { Options.PCRAnalysis = true; }
+    else if(strcmp(Arg, "--drop-null"     ) == 0) { Options.DropNull = true; }
+    else if(strcmp(Arg, "--bitrate"       ) == 0) { Options.Bitrate = true; }
+    else if(strncmp(Arg, "--bitrate=", 10) == 0) { Options.Bitrate = true; Options.BitrateFile = Arg + 10; }
+    else if(strncmp(Arg, "--bitrate-window=", 17) == 0) { Options.BitrateWindow = strtoul(Arg + 17, nullptr, 10); }
+    else if(strncmp(Arg, "--time-window=", 14) == 0)
+    {
+      char* End = nullptr;
+      Options.TimeWindow = true;
+      Options.TimeFrom   = strtod(Arg + 14, &End);
+      if(*End != ':' || Options.TimeFrom < 0)
+      {
+        printf("Error: Invalid time window %s\n", Arg + 14);
+        return false;
+      }
+      Options.TimeTo = End[1] ? strtod(End + 1, nullptr) : -1;
+    }
+    else if(strncmp(Arg, "--threads=", 10) == 0)
+    {
+      Options.NumThreads = strtoul(Arg + 10, nullptr, 10);
+      if(Options.NumThreads == 0) Options.NumThreads = xTS_ThreadPool::getNumHardwareThreads();
+    }
+    else if(strcmp(Arg, "--pes-pool"      ) == 0) { Options.PES_Pool = true; }
+    else if(strncmp(Arg, "--pes-out=", 10) == 0) { Options.PES_OutPrefix = Arg + 10; }
+    else if(strcmp(Arg, "--psi"           ) == 0) { Options.PSI_Print = true; }
+    else if(strcmp(Arg, "--output=text"   ) == 0) { Options.BinaryOutput = false; }
+    else if(strcmp(Arg, "--output=binary" ) == 0) { Options.BinaryOutput = true;  }
+    else if(strcmp(Arg, "--pes=all"       ) == 0) { Options.PES_AllPIDs = true;  Options.PES_AutoPIDs = false; Options.PES_PIDs.clear(); }
+    else if(strcmp(Arg, "--pes=auto"      ) == 0) { Options.PES_AllPIDs = false; Options.PES_AutoPIDs = true;  Options.PES_PIDs.clear(); }
+    else if(strncmp(Arg, "--pes=", 6) == 0)
+    {
+      Options.PES_AllPIDs  = false;
+      Options.PES_AutoPIDs = false;
+      Options.PES_PIDs.clear();
+      for(const char* List = Arg + 6; *List; )
+      {
+        char* End = nullptr;
+        long  PID = strtol(List, &End, 0);
+        if(End == List || PID < 0 || PID >= (long)xPES_Demuxer::NumPIDs || (*End != ',' && *End != '\0'))
+        {
+          printf("Error: Invalid PID list %s\n", Arg + 6);
+          return false;
+        }
+        Options.PES_PIDs.push_back((int32_t)PID);
+        List = *End ? End + 1 : End;
+      }
+    }
+    else if(strncmp(Arg, "--", 2) == 0)
+    {
+      printf("Error: Unknown option %s\n", Arg);
+      return false;
+    }
+    else { Options.InputFileName = Arg; }
+  }
+  if(Options.SyncConfirm == 0 || Options.InputConfig.BlockSize < (Options.SyncConfirm + 1) * xTS::RS_PacketLength || Options.InputConfig.QueueDepth == 0)
+  {
+    printf("Error: Invalid block size, queue depth or sync confirmation count\n");
+    return false;
+  }
+  if(Options.TimeWindow && Options.TimeIndexFile == nullptr)
+  {
+    printf("Error: --time-window requires --time-index=<file>\n");
+    return false;
+  }
+  return Options.InputFileName != nullptr;
+}
+
+/**
+ * @brief Checks whether a record describes a null packet (PID 0x1FFF)
+ */
+static inline bool isNullRecord(const xTS_PacketRecord& Record)
+{
+  return Record.Kind == static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet) && Record.PID == static_cast<uint16_t>(xTS_PacketHeader::ePID::NuLL);
+}
+
+/**
+ * @brief Renders records as text, each followed by its PAT/PMT lines (--psi)
+ * @param Output   Text output
+ * @param Records  Records in stream order
+ * @param PSI_Logs Index of the preceding record and text of PAT/PMT lines, ascending
+ * @param DropNull Skip null packet records (--drop-null)
+ */
+static void RenderRecords(xTS_TextFormatter& Output, const std::vector<xTS_PacketRecord>& Records,
+                          const std::vector<std::pair<size_t, std::string>>& PSI_Logs, bool DropNull = false)
+{
+  size_t LogIdx = 0;
+  for (size_t RecordIdx = 0; RecordIdx < Records.size(); RecordIdx++) {
+    if (!DropNull || !isNullRecord(Records[RecordIdx])) Records[RecordIdx].Render(Output);
+    if (LogIdx < PSI_Logs.size() && PSI_Logs[LogIdx].first == RecordIdx) {
+      Output.Put(PSI_Logs[LogIdx].second.data(), PSI_Logs[LogIdx].second.size());
+      LogIdx++;
+    }
+  }
+}
+
+/**
+ * @brief Input bytes passed from the reader stage to the parse stage (--pipeline)
+ *
+ * Bytes a block leaves unprocessed (partial packet, unconfirmed sync candidates) are
+ * copied into the carry area in front of the next block's data, so the parser always
+ * sees contiguous input without copying whole blocks.
+ */
+struct xInputBlock
+{
+  std::unique_ptr<uint8_t[]> Storage;         ///< Carry area followed by the data area
+  uint8_t*            Data        = nullptr;  ///< Data area (block read from the input)
+  size_t              Size        = 0;        ///< Number of bytes in the data area
+  uint64_t            Position    = 0;        ///< Absolute stream offset of Data
+  bool                EndOfInput  = false;    ///< Last block of the input
+};
+
+/**
+ * @brief Analysis records passed from the parse stage to the formatter stage (--pipeline)
+ */
+struct xRecordBlock
+{
+  /** @brief Records per block */
+  static constexpr uint32_t Capacity = 8192;
+
+  std::vector<xTS_PacketRecord>               Records;
+  std::vector<std::pair<size_t, std::string>> PSI_Logs;  ///< PAT/PMT lines following a record (--psi)
+};
+
+/**
+ * @brief Reader -> parser -> formatter pipeline (--pipeline)
+ *
+ * Blocks circulate between neighbouring stages: filled blocks travel downstream,
+ * processed blocks return upstream for reuse, so no memory is allocated while
+ * running. Every ring has exactly one producer and one consumer thread.
+ */
+struct xAnalysisPipeline
+{
+  static constexpr uint32_t NumInputBlocks  = 8;
+  static constexpr uint32_t NumRecordBlocks = 8;
+
+  xTS_SPSCRing<xInputBlock*>  FilledInput   { NumInputBlocks  }; ///< Reader -> parser
+  xTS_SPSCRing<xInputBlock*>  FreeInput     { NumInputBlocks  }; ///< Parser -> reader
+  xTS_SPSCRing<xRecordBlock*> FilledRecords { NumRecordBlocks }; ///< Parser -> formatter (nullptr ends the stream)
+  xTS_SPSCRing<xRecordBlock*> FreeRecords   { NumRecordBlocks }; ///< Formatter -> parser
+  std::vector<std::unique_ptr<xInputBlock>>  InputBlocks;
+  std::vector<std::unique_ptr<xRecordBlock>> RecordBlocks;
+  xRecordBlock*               Current = nullptr;                 ///< Record block being filled by the parser
+  size_t                      BlockSize;                         ///< Data area size of input blocks
+  size_t                      CarrySize;                         ///< Carry area size of input blocks
+
+  /**
+   * @param BlockSize Bytes read into one input block
+   * @param CarrySize Largest number of bytes a block may leave unprocessed
+   */
+  xAnalysisPipeline(size_t BlockSize, size_t CarrySize)
+    : BlockSize(BlockSize), CarrySize(CarrySize)
+  {
+    for (uint32_t BlockIdx = 0; BlockIdx < NumInputBlocks; BlockIdx++) {
+      InputBlocks.emplace_back(new xInputBlock());
+      InputBlocks.back()->Storage.reset(new uint8_t[CarrySize + BlockSize]);
+      InputBlocks.back()->Data = InputBlocks.back()->Storage.get() + CarrySize;
+      FreeInput.Push(InputBlocks.back().get());
+    }
+    for (uint32_t BlockIdx = 0; BlockIdx < NumRecordBlocks; BlockIdx++) {
+      RecordBlocks.emplace_back(new xRecordBlock());
+      RecordBlocks.back()->Records.reserve(xRecordBlock::Capacity);
+      FreeRecords.Push(RecordBlocks.back().get());
+    }
+  }
+};
+
+/**
+ * @brief Per-run analysis state shared by all packets
+ */
+struct xAnalysisContext
+{
+  xTS_OutputWriter*   Output      = nullptr;  ///< Analysis output file (text output)
+  xTS_RecordWriter*   Records     = nullptr;  ///< Analysis record file (--output=binary)
+  xAnalysisPipeline*  Pipeline    = nullptr;  ///< Records are handed to the formatter stage (--pipeline)
+  xTS_TimeIndexWriter* TimeIndex  = nullptr;  ///< PCR time index being built (--time-index)
+  xTS_RAPIndexWriter*  RAPIndex   = nullptr;  ///< Random access point index being built (--rap-index)
+  xTS_TR101290Monitor* Monitor    = nullptr;  ///< TR 101 290 indicators (--tr101290)
+  xTS_PCRAnalyzer*     PCRAnalyzer = nullptr; ///< PCR timing analysis (--pcr-analysis)
+  xTS_BitrateMeter*    Bitrate    = nullptr;  ///< Windowed bitrate (--bitrate)
+  xTS_PacketRecord    Record;                 ///< Record of the packet being analyzed
+  xTS_PacketBatch     TS_PacketBatch;         ///< Column table of headers decoded per block
+  xTS_PacketHeader    TS_PacketHeader;        ///< TS packet header parser (PES assembler input)
+  xTS_AdaptationField TS_AdaptationField;     ///< Adaptation field parser
+  xPES_BufferPool     PES_BufferPool;         ///< Shared PES buffers (--pes-pool), outlives the demuxer
+  xPES_Demuxer        PES_Demuxer;            ///< PES assemblers of the selected PIDs
+  xPES_PacketHeader   RAP_PES_Header;         ///< PES header of a random access point (--rap-index)
+  const char*         PES_OutPrefix = nullptr; ///< Elementary stream file prefix (--pes-out)
+  std::map<int32_t, std::unique_ptr<xPES_FileSink>> PES_Sinks; ///< Elementary stream files per PID
+  xPSI_ProgramTracker PSI_Tracker;            ///< PAT/PMT follower (--pes=auto, --psi)
+  bool                PSI_Enabled = false;    ///< Feed PSI PIDs to PSI_Tracker
+  std::string         PSI_Log;                ///< PAT/PMT lines written after the current packet line (--psi)
+  xBlockRef           Block;                  ///< Current input block (held only while zero-copy slices are taken)
+  int32_t             TS_PacketId = 0;        ///< Sequential packet counter
+  uint64_t            PES_Bytes   = 0;        ///< Bytes of completed PES units (all PIDs)
+  uint64_t            NumNull     = 0;        ///< Null packets (taken off the analysis by the fast path)
+  bool                DropNull    = false;    ///< Null packets are not emitted (--drop-null)
+  bool                Resync      = true;     ///< Re-acquire sync lock after sync byte loss
+};
+
+/**
+ * @brief Writes a record as text line(s), appends it to the record file (--output=binary)
+ *        or hands it to the formatter stage (--pipeline)
+ *
+ * PAT/PMT lines collected while the packet was analyzed follow its line (text output only).
+ */
+static inline void EmitRecord(xAnalysisContext& Ctx, const xTS_PacketRecord& Record)
+{
+  if (Ctx.Pipeline) {
+    xRecordBlock*& Block = Ctx.Pipeline->Current;
+    if (!Block) Block = Ctx.Pipeline->FreeRecords.Pop();
+    if (!Ctx.PSI_Log.empty()) {
+      Block->PSI_Logs.emplace_back(Block->Records.size(), std::move(Ctx.PSI_Log));
+      Ctx.PSI_Log.clear();
+    }
+    Block->Records.push_back(Record);
+    if (Block->Records.size() == xRecordBlock::Capacity) {
+      Ctx.Pipeline->FilledRecords.Push(Block);
+      Block = nullptr;
+    }
+    return;
+  }
+  if (Ctx.Records) {
+    Ctx.Records->Append(Record);
+    Ctx.PSI_Log.clear();
+    return;
+  }
+  Record.Render(*Ctx.Output);
+  if (!Ctx.PSI_Log.empty()) {
+    Ctx.Output->Put(Ctx.PSI_Log.data(), Ctx.PSI_Log.size());
+    Ctx.PSI_Log.clear();
+  }
+}
+
+/**
+ * @brief Fills the record fields carried by the packet itself (header, adaptation field, ATS)
+ *
+ * Depends on no other packet, so chunks of the input can be analyzed in parallel.
+ *
+ * @param Record             Record to fill (index is set by the caller)
+ * @param TS_PacketBatch     Headers decoded for the run of packets
+ * @param Idx                Index of the packet in TS_PacketBatch
+ * @param TS_AdaptationField Adaptation field parser (holds the packet's adaptation field afterwards)
+ * @param TS_PacketBuffer    Pointer to the 188-byte TS packet (inside the input block)
+ * @param ArrivalTimestamp   M2TS arrival timestamp, NOT_VALID for other packet formats
+ */
+static inline void AnalyzeHeader(xTS_PacketRecord& Record, const xTS_PacketBatch& TS_PacketBatch, uint32_t Idx,
+                                 xTS_AdaptationField& TS_AdaptationField, const uint8_t* TS_PacketBuffer, int64_t ArrivalTimestamp)
+{
+  // Reset adaptation field parser and record for new packet
+  TS_AdaptationField.Reset();
+  Record.Reset();
+
+  // Transport Stream packet header (4 bytes) was decoded for the whole block
+  if (TS_PacketBatch.isSyncValid(Idx)) {
+    const uint8_t AdaptationFieldControl = TS_PacketBatch.getAdaptationFieldControl(Idx);
+
+    // Adaptation field present (AFC = 2 or 3) - never parsed for null packets (fast path)
+    const bool HasAdaptationField = (AdaptationFieldControl == 2 || AdaptationFieldControl == 3) && !TS_PacketBatch.isNull(Idx);
+
+    // Parse adaptation field if present
+    if (HasAdaptationField) {
+      int32_t result = TS_AdaptationField.Parse(TS_PacketBuffer + xTS::TS_HeaderLength, 
+                                                AdaptationFieldControl);
+      if (result < 0) {
+        Record.Flags |= xTS_PacketRecord::FlagAFError;
+      }
+    }
+
+    // Basic TS packet header information
+    Record.Kind   = static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet);
+    Record.PID    = TS_PacketBatch.getPID(Idx);
+    Record.CC     = TS_PacketBatch.getContinuityCounter(Idx);
+    Record.Header = static_cast<uint8_t>((TS_PacketBatch.getTransportErrorIndicator(Idx)    ? xTS_PacketRecord::HeaderE : 0) |
+                                         (TS_PacketBatch.getPayloadUnitStartIndicator(Idx)  ? xTS_PacketRecord::HeaderS : 0) |
+                                         (TS_PacketBatch.getTransportPriority(Idx)          ? xTS_PacketRecord::HeaderP : 0) |
+                                         (TS_PacketBatch.getTransportScramblingControl(Idx) << xTS_PacketRecord::HeaderTSCShift) |
+                                         (AdaptationFieldControl                            << xTS_PacketRecord::HeaderAFCShift));
+
+    // M2TS arrival timestamp (27 MHz) for jitter analysis
+    if (ArrivalTimestamp != NOT_VALID) {
+      Record.Flags |= xTS_PacketRecord::FlagATS;
+      Record.ATS    = static_cast<uint32_t>(ArrivalTimestamp);
+    }
+
+    // Adaptation field details if present
+    if (HasAdaptationField) {
+      Record.AF_Length   = TS_AdaptationField.getAdaptationFieldLength();
+      Record.AF_Flags    = static_cast<uint8_t>(TS_AdaptationField.getDiscontinuityIndicator()   << 7 |
+                                                TS_AdaptationField.getRandomAccessIndicator()    << 6 |
+                                                TS_AdaptationField.getESPriorityIndicator()      << 5 |
+                                                TS_AdaptationField.getPCRFlag()                  << 4 |
+                                                TS_AdaptationField.getOPCRFlag()                 << 3 |
+                                                TS_AdaptationField.getSplicingPointFlag()        << 2 |
+                                                TS_AdaptationField.getTransportPrivateDataFlag() << 1 |
+                                                TS_AdaptationField.getExtensionFlag());
+      Record.AF_Stuffing = static_cast<int16_t>(TS_AdaptationField.getStuffingBytes());
+
+      // Program Clock Reference (PCR) and Original Program Clock Reference (OPCR)
+      if (TS_AdaptationField.getPCRFlag()) {
+        Record.PCR  = TS_AdaptationField.getPCRBase()  << 9 | TS_AdaptationField.getPCRExtension();
+      }
+      if (TS_AdaptationField.getOPCRFlag()) {
+        Record.OPCR = TS_AdaptationField.getOPCRBase() << 9 | TS_AdaptationField.getOPCRExtension();
+      }
+    }
+  } else {
+    // TS packet header parsing failed
+    Record.Kind = static_cast<uint8_t>(xTS_PacketRecord::eKind::PacketError);
+  }
+}
+
+/**
+ * @brief Feeds a packet to the PSI tracker and PES demuxer and adds the PES assembly result to its record
+ *
+ * Depends on the state left by the previous packets of the PID (continuity counter,
+ * unit being assembled, cumulative stuffing), so packets must be fed in stream order.
+ *
+ * @param Ctx             Analysis state, Ctx.TS_AdaptationField holds the packet's adaptation field
+ * @param Record          Record of the packet (filled by AnalyzeHeader())
+ * @param TS_PacketBuffer Pointer to the 188-byte TS packet (inside the input block)
+ */
+static inline void AnalyzePayload(xAnalysisContext& Ctx, xTS_PacketRecord& Record, const uint8_t* TS_PacketBuffer)
+{
+  xTS_PacketHeader&      TS_PacketHeader    = Ctx.TS_PacketHeader;
+  xTS_AdaptationField&   TS_AdaptationField = Ctx.TS_AdaptationField;
+  xPES_Demuxer&          PES_Demuxer        = Ctx.PES_Demuxer;
+
+  // Follow PAT and PMTs (programs, PCR PIDs and elementary streams)
+  if (Ctx.PSI_Enabled && Ctx.PSI_Tracker.isInterested(Record.PID)) {
+    TS_PacketHeader.Parse(TS_PacketBuffer);
+    Ctx.PSI_Tracker.AbsorbPacket(TS_PacketBuffer, &TS_PacketHeader, &TS_AdaptationField);
+  }
+
+  // Process PES packet assembly for selected PIDs
+  if (PES_Demuxer.isInterested(Record.PID)) {
+    TS_PacketHeader.Parse(TS_PacketBuffer);
+    xPES_Assembler::eResult result = PES_Demuxer.AbsorbPacket(TS_PacketBuffer, 
+                                                              &TS_PacketHeader, 
+                                                              &TS_AdaptationField,
+                                                              &Ctx.Block);
+    const xPES_Assembler* PES_Assembler = PES_Demuxer.getAssembler(Record.PID);
+
+    // PES assembly status and information
+    switch (result) {
+      case xPES_Assembler::eResult::UnexpectedPID:
+        // PID not selected (or no PES start seen yet in --pes=all mode)
+        break;
+
+      case xPES_Assembler::eResult::StreamPackedLost:
+        Record.PES_Event = static_cast<uint8_t>(xTS_PacketRecord::ePES_Event::Lost);
+        break;
+
+      case xPES_Assembler::eResult::AssemblingStarted:
+        // PES header information for new packet, including timing information if available
+        Record.PES_Event        = static_cast<uint8_t>(xTS_PacketRecord::ePES_Event::Started);
+        Record.PES_StreamId     = PES_Assembler->m_PESH.getStreamId();
+        Record.PES_PacketLength = PES_Assembler->m_PESH.getPacketLength();
+        if (PES_Assembler->m_PESH.hasPTS()) {
+          Record.Flags  |= xTS_PacketRecord::FlagPTS;
+          Record.PES_PTS = PES_Assembler->m_PESH.getPTS();
+        }
+        if (PES_Assembler->m_PESH.hasDTS()) {
+          Record.Flags  |= xTS_PacketRecord::FlagDTS;
+          Record.PES_DTS = PES_Assembler->m_PESH.getDTS();
+        }
+        break;
+
+      case xPES_Assembler::eResult::AssemblingContinue:
+        Record.PES_Event = static_cast<uint8_t>(xTS_PacketRecord::ePES_Event::Continue);
+        break;
+
+      case xPES_Assembler::eResult::AssemblingFinished:
+        // Packet length integrity is verified against PES_packet_length when rendered
+        Record.PES_Event        = static_cast<uint8_t>(xTS_PacketRecord::ePES_Event::Finished);
+        Record.PES_PacketLength = PES_Assembler->m_PESH.getPacketLength();
+        Record.PES_Length       = PES_Assembler->getNumPacketBytes();
+        Record.PES_Stuffing     = PES_Assembler->getTotalStuffingBytes();
+        break;
+
+      default:
+        break;
+    }
+  }
+}
+
+/**
+ * @brief Adds a packet to the sidecar indexes built during analysis
+ * @param Ctx             Analysis state
+ * @param Record          Record of the packet
+ * @param TS_PacketBuffer Pointer to the TS packet
+ * @param Offset          Absolute byte offset of the (source) packet
+ */
+static inline void IndexPacket(xAnalysisContext& Ctx, const xTS_PacketRecord& Record, const uint8_t* TS_PacketBuffer, uint64_t Offset)
+{
+  if (Ctx.TimeIndex && Record.hasPCR()) Ctx.TimeIndex->AddPCR(Record.PID, Record.getPCR(), Offset);
+  if (!Ctx.RAPIndex) return;
+  if (Record.hasPCR()) Ctx.RAPIndex->AddPCR(Record.PID, Record.getPCR());
+
+  // Random access point - PES packet start flagged by random_access_indicator
+  if ((Record.Header & xTS_PacketRecord::HeaderS) && (Record.AF_Flags & xTS_PacketRecord::AF_FlagRA) && Record.getAFC() == 3) {
+    uint64_t PTS = xTS_RAPIndex::NoTimestamp, DTS = xTS_RAPIndex::NoTimestamp;
+    const uint32_t PayloadOffset = xTS::TS_HeaderLength + Record.AF_Length + 1;
+    Ctx.RAP_PES_Header.Reset();
+    if (PayloadOffset + xTS::PES_HeaderLength + 13 <= xTS::TS_PacketLength && // fixed header, flags and both timestamps
+        Ctx.RAP_PES_Header.Parse(TS_PacketBuffer + PayloadOffset) != NOT_VALID) {
+      if (Ctx.RAP_PES_Header.hasPTS()) PTS = Ctx.RAP_PES_Header.getPTS();
+      if (Ctx.RAP_PES_Header.hasDTS()) DTS = Ctx.RAP_PES_Header.getDTS();
+    }
+    Ctx.RAPIndex->AddRAP(Record.PID, Offset, PTS, DTS);
+  }
+}
+
+/**
+ * @brief Analyzes a single 188-byte TS packet and emits its analysis record
+ *
+ * Takes the header fields from the batch decoded for the block, parses the adaptation
+ * field, feeds the selected PIDs to the PES demuxer and collects all results into one
+ * record (one output line in text mode).
+ *
+ * @param Ctx              Analysis state
+ * @param Idx              Index of the packet in Ctx.TS_PacketBatch
+ * @param TS_PacketBuffer  Pointer to the 188-byte TS packet (inside the input block)
+ * @param ArrivalTimestamp M2TS arrival timestamp, NOT_VALID for other packet formats
+ * @param Offset           Absolute byte offset of the (source) packet
+ */
+static inline void AnalyzePacket(xAnalysisContext& Ctx, uint32_t Idx, const uint8_t* TS_PacketBuffer, int64_t ArrivalTimestamp, uint64_t Offset)
+{
+  xTS_PacketRecord& Record = Ctx.Record;
+
+  // Null packet fast path - no payload analysis or indexing, a record only for the output and the monitors
+  if (Ctx.TS_PacketBatch.isNull(Idx)) {
+    Ctx.NumNull++;
+    if (!Ctx.DropNull || Ctx.Monitor || Ctx.Bitrate) {
+      AnalyzeHeader(Record, Ctx.TS_PacketBatch, Idx, Ctx.TS_AdaptationField, TS_PacketBuffer, ArrivalTimestamp);
+      Record.Index = static_cast<uint32_t>(Ctx.TS_PacketId);
+      if (Ctx.Bitrate)   Ctx.Bitrate->AddPacket(Record);
+      if (Ctx.Monitor)   Ctx.Monitor->AddRecord(Record, TS_PacketBuffer, Offset);
+      if (!Ctx.DropNull) EmitRecord(Ctx, Record);
+    }
+    Ctx.TS_PacketId++;
+    return;
+  }
+
+  AnalyzeHeader(Record, Ctx.TS_PacketBatch, Idx, Ctx.TS_AdaptationField, TS_PacketBuffer, ArrivalTimestamp);
+  Record.Index = static_cast<uint32_t>(Ctx.TS_PacketId);
+  if (Record.Kind == static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet)) {
+    AnalyzePayload(Ctx, Record, TS_PacketBuffer);
+    IndexPacket(Ctx, Record, TS_PacketBuffer, Offset);
+    if (Ctx.PCRAnalyzer) Ctx.PCRAnalyzer->AddRecord(Record, Offset);
+    if (Ctx.Bitrate)     Ctx.Bitrate->AddPacket(Record);
+  }
+  if (Ctx.Monitor) Ctx.Monitor->AddRecord(Record, TS_PacketBuffer, Offset);
+
+  EmitRecord(Ctx, Record);
+
+  // Increment packet counter for next iteration
+  Ctx.TS_PacketId++;
+}
+
+/**
+ * @brief Emits a sync loss record for the byte range skipped by the scanner
+ */
+static void EmitSyncLoss(xAnalysisContext& Ctx, const xTS_SyncScanner& SyncScanner, xTS_PacketRecord::eKind Kind)
+{
+  xTS_PacketRecord& Record = Ctx.Record;
+  Record.Reset();
+  Record.Index = static_cast<uint32_t>(Ctx.TS_PacketId);
+  Record.Kind  = static_cast<uint8_t>(Kind);
+  Record.PCR   = SyncScanner.getLostRangeBegin();
+  Record.OPCR  = SyncScanner.getLostRangeEnd();
+  if (Ctx.Monitor) Ctx.Monitor->AddRecord(Record, nullptr, Record.PCR);
+  EmitRecord(Ctx, Record);
+}
+
+/**
+ * @brief Analyzes all complete packets of a block
+ *
+ * Headers of runs of up to TS_PacketBatch capacity packets are decoded at once into
+ * the column table before the packets are analyzed one by one.
+ * Instantiated per packet layout, so the stride and the TS packet offset inside a
+ * source packet are compile time constants and the plain 188-byte path carries no
+ * layout overhead.
+ *
+ * @tparam Stride       Distance between packets (188, 192 or 204)
+ * @tparam PrefixLength Bytes preceding the TS packet (4 for M2TS, 0 otherwise)
+ * @tparam tContext     xAnalysisContext (sequential analysis) or xParseChunk (parallel chunk parsing)
+ * @param Ctx         Analysis state
+ * @param SyncScanner Sync acquisition engine
+ * @param Block       Input block
+ * @param Available   Number of bytes in the block
+ * @param Limit       Packets starting at or after Limit are left for the next call
+ * @param Position    Absolute stream offset of the block
+ * @param EndOfInput  True if no more data follows the block
+ * @return Number of bytes processed (to be consumed from the input)
+ */
+template<uint32_t Stride, uint32_t PrefixLength, class tContext>
+static size_t ProcessBlock(tContext& Ctx, xTS_SyncScanner& SyncScanner, const uint8_t* Block,
+                           size_t Available, size_t Limit, uint64_t Position, bool EndOfInput)
+{
+  size_t PacketOffset = 0;
+  while (PacketOffset < Limit && PacketOffset + Stride <= Available) {
+    // Re-acquire sync lock when the packet does not start with the sync byte
+    const uint8_t* TS_PacketBuffer = Block + PacketOffset + PrefixLength;
+    if (Ctx.Resync && TS_PacketBuffer[0] != xTS_SyncScanner::SyncByte) {
+      PacketOffset += SyncScanner.Resync(TS_PacketBuffer, Available - PacketOffset - PrefixLength,
+                                         Position + PacketOffset, EndOfInput);
+      if (!SyncScanner.isLocked()) break; // lock needs more data (or input ended)
+      EmitSyncLoss(Ctx, SyncScanner, xTS_PacketRecord::eKind::SyncLoss);
+      continue;
+    }
+
+    // Decode headers of the following run of packets, then analyze them until the run ends or sync is lost
+    const size_t   MaxPackets = std::min<size_t>({ (Available - PacketOffset) / Stride, (Limit - PacketOffset + Stride - 1) / Stride,
+                                                   Ctx.TS_PacketBatch.getCapacity() });
+    const uint32_t NumPackets = Ctx.TS_PacketBatch.Decode(TS_PacketBuffer, static_cast<uint32_t>(MaxPackets), Stride);
+    for (uint32_t Idx = 0; Idx < NumPackets; Idx++) {
+      if (Ctx.Resync && !Ctx.TS_PacketBatch.isSyncValid(Idx)) break;
+      const uint8_t* SourcePacket = Block + PacketOffset;
+      AnalyzePacket(Ctx, Idx, SourcePacket + PrefixLength,
+                    PrefixLength ? static_cast<int64_t>(xTS_PacketFormat::getArrivalTimestamp(SourcePacket)) : NOT_VALID,
+                    Position + PacketOffset);
+      PacketOffset += Stride;
+    }
+  }
+  return PacketOffset;
+}
+
+/**
+ * @brief Selects the ProcessBlock() instance of the packet layout
+ */
+template<class tContext>
+static size_t ProcessBlock(const xTS_PacketFormat& PacketFormat, tContext& Ctx, xTS_SyncScanner& SyncScanner, const uint8_t* Block,
+                           size_t Available, size_t Limit, uint64_t Position, bool EndOfInput)
+{
+  switch (PacketFormat.getFormat()) {
+    case xTS_PacketFormat::eFormat::M2TS192:
+      return ProcessBlock<xTS::M2TS_PacketLength, xTS::M2TS_HeaderLength>(Ctx, SyncScanner, Block, Available, Limit, Position, EndOfInput);
+    case xTS_PacketFormat::eFormat::RS204:
+      return ProcessBlock<xTS::RS_PacketLength, 0>(Ctx, SyncScanner, Block, Available, Limit, Position, EndOfInput);
+    default:
+      return ProcessBlock<xTS::TS_PacketLength, 0>(Ctx, SyncScanner, Block, Available, Limit, Position, EndOfInput);
+  }
+}
+
+//=============================================================================================================================================================================
+// Parallel chunked analysis (--threads)
+//=============================================================================================================================================================================
+
+/**
+ * @brief Packet-aligned part of a memory mapped input, analyzed by one pool task
+ *
+ * Workers fill the records with everything AnalyzeHeader() derives from the packets
+ * themselves. Packet numbers, PSI and PES results depend on all preceding packets and
+ * are added by MergeChunk() in stream order.
+ */
+struct xParseChunk
+{
+  /** @brief Packets per chunk */
+  static constexpr uint32_t NumChunkPackets = 16384;
+
+  const uint8_t*      Data        = nullptr;  ///< Whole input
+  size_t              Size        = 0;        ///< Number of input bytes
+  uint64_t            Begin       = 0;        ///< First byte of the chunk (stride aligned)
+  uint64_t            End         = 0;        ///< Packets starting at or after End belong to the next chunk
+  uint64_t            Start       = 0;        ///< Offset of the first analyzed packet (Begin unless parsed again)
+  uint64_t            Next        = 0;        ///< Offset following the last analyzed packet (or skipped bytes)
+  bool                Resync      = true;     ///< Re-acquire sync lock after sync byte loss
+  uint32_t            PrefixLength = 0;       ///< Bytes preceding the TS packet in a source packet
+  bool                NullRecords = true;     ///< Null packets need records (output or monitors)
+  bool                DropNull    = false;    ///< Null packet records are not rendered (--drop-null)
+  uint64_t            NumNull     = 0;        ///< Null packets of the chunk
+  xTS_PacketBatch     TS_PacketBatch;         ///< Column table of headers decoded per run
+  xTS_AdaptationField TS_AdaptationField;     ///< Adaptation field parser
+  xTS_SyncScanner     SyncScanner;            ///< Sync state of the chunk (starts locked at Start)
+  std::vector<xTS_PacketRecord> Records;      ///< Packet and sync loss records
+  std::vector<const uint8_t*>   Packets;      ///< TS packet of each record (nullptr for sync loss records)
+  uint32_t            NumPackets  = 0;        ///< Packet records (numbered from 0 until merged)
+  std::vector<std::pair<size_t, std::string>> PSI_Logs; ///< PAT/PMT lines following a record (--psi)
+  xTS_TextBuffer      Text;                   ///< Rendered analysis output
+  std::future<void>   Task;                   ///< Parse or render task in flight
+};
+
+/**
+ * @brief Appends the header analysis of a packet to the chunk's records
+ */
+static inline void AnalyzePacket(xParseChunk& Chunk, uint32_t Idx, const uint8_t* TS_PacketBuffer, int64_t ArrivalTimestamp, uint64_t Offset)
+{
+  (void)Offset; // recomputed from the packet pointer when merged
+  if (Chunk.TS_PacketBatch.isNull(Idx)) {
+    Chunk.NumNull++;
+    if (!Chunk.NullRecords) { Chunk.NumPackets++; return; }
+  }
+  Chunk.Records.emplace_back();
+  xTS_PacketRecord& Record = Chunk.Records.back();
+  AnalyzeHeader(Record, Chunk.TS_PacketBatch, Idx, Chunk.TS_AdaptationField, TS_PacketBuffer, ArrivalTimestamp);
+  Record.Index = Chunk.NumPackets++;
+  Chunk.Packets.push_back(TS_PacketBuffer);
+}
+
+/**
+ * @brief Appends a sync loss record to the chunk's records
+ */
+static void EmitSyncLoss(xParseChunk& Chunk, const xTS_SyncScanner& SyncScanner, xTS_PacketRecord::eKind Kind)
+{
+  Chunk.Records.emplace_back();
+  xTS_PacketRecord& Record = Chunk.Records.back();
+  Record.Reset();
+  Record.Index = Chunk.NumPackets;
+  Record.Kind  = static_cast<uint8_t>(Kind);
+  Record.PCR   = SyncScanner.getLostRangeBegin();
+  Record.OPCR  = SyncScanner.getLostRangeEnd();
+  Chunk.Packets.push_back(nullptr);
+}
+
+/**
+ * @brief Guesses the offset of the first packet of a chunk
+ *
+ * Sync losses before the chunk may have moved the packet grid away from the stride
+ * aligned chunk begin, so the first sync lock at or after the begin is taken. A wrong
+ * guess is detected while stitching and the chunk is parsed again.
+ */
+static uint64_t FindChunkStart(const xParseChunk& Chunk, const xTS_PacketFormat& PacketFormat)
+{
+  const uint32_t PrefixLength = PacketFormat.getPrefixLength();
+  if (!Chunk.Resync || Chunk.Begin + PrefixLength >= Chunk.Size) return Chunk.Begin;
+  if (Chunk.Data[Chunk.Begin + PrefixLength] == xTS_SyncScanner::SyncByte) return Chunk.Begin;
+
+  // Search the chunk and as much again for confirmation (long garbage runs are left to stitching)
+  const size_t  SearchSize = std::min<size_t>(Chunk.Size - Chunk.Begin - PrefixLength, 2 * (Chunk.End - Chunk.Begin));
+  const int64_t Lock       = Chunk.SyncScanner.FindLock(Chunk.Data + Chunk.Begin + PrefixLength, SearchSize);
+  return Lock == NOT_VALID ? Chunk.Begin : Chunk.Begin + static_cast<uint64_t>(Lock);
+}
+
+/**
+ * @brief Analyzes the packets starting in [Start, Chunk.End) (pool task)
+ *
+ * The scanner may look past the chunk end, so a sync loss crossing the boundary is
+ * resolved exactly as in sequential processing and Chunk.Next tells where the next
+ * chunk really starts.
+ */
+static void ParseChunk(xParseChunk& Chunk, const xTS_PacketFormat& PacketFormat, uint64_t Start)
+{
+  Chunk.Start = Start;
+  Chunk.Records.clear();
+  Chunk.Packets.clear();
+  Chunk.PSI_Logs.clear();
+  Chunk.NumPackets = 0;
+  Chunk.NumNull    = 0;
+  Chunk.SyncScanner.Reset();
+  Chunk.Next = Chunk.Start;
+  if (Chunk.Start >= Chunk.End) return; // skipped by a sync loss of the previous chunk
+
+  Chunk.Records.reserve(xParseChunk::NumChunkPackets + 1);
+  Chunk.Packets.reserve(xParseChunk::NumChunkPackets + 1);
+  Chunk.Next += ProcessBlock(PacketFormat, Chunk, Chunk.SyncScanner, Chunk.Data + Chunk.Start, Chunk.Size - Chunk.Start,
+                             Chunk.End - Chunk.Start, Chunk.Start, true);
+}
+
+/**
+ * @brief Adds packet numbers, PSI and PES results to a parsed chunk (main thread, stream order)
+ *
+ * PSI tracker and PES demuxer are shared by all chunks, so continuity counters and
+ * units being assembled carry over chunk boundaries exactly as in sequential mode.
+ * Only packets of interested PIDs are touched beyond the packet number.
+ */
+static void MergeChunk(xAnalysisContext& Ctx, xParseChunk& Chunk)
+{
+  for (size_t RecordIdx = 0; RecordIdx < Chunk.Records.size(); RecordIdx++) {
+    xTS_PacketRecord& Record          = Chunk.Records[RecordIdx];
+    const uint8_t*    TS_PacketBuffer = Chunk.Packets[RecordIdx];
+    Record.Index += static_cast<uint32_t>(Ctx.TS_PacketId);
+
+    if (isNullRecord(Record)) {
+      if (Ctx.Bitrate) Ctx.Bitrate->AddPacket(Record);
+      if (Ctx.Monitor) Ctx.Monitor->AddRecord(Record, TS_PacketBuffer, static_cast<uint64_t>(TS_PacketBuffer - Chunk.Data) - Chunk.PrefixLength);
+      if (Ctx.Records && !Ctx.DropNull) EmitRecord(Ctx, Record);
+      continue;
+    }
+
+    if (Record.Kind == static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet) &&
+        ((Ctx.PSI_Enabled && Ctx.PSI_Tracker.isInterested(Record.PID)) || Ctx.PES_Demuxer.isInterested(Record.PID))) {
+      Ctx.TS_AdaptationField.Reset();
+      if (Record.hasAF()) Ctx.TS_AdaptationField.Parse(TS_PacketBuffer + xTS::TS_HeaderLength, Record.getAFC());
+      AnalyzePayload(Ctx, Record, TS_PacketBuffer);
+    }
+    if (Record.Kind == static_cast<uint8_t>(xTS_PacketRecord::eKind::Packet)) {
+      IndexPacket(Ctx, Record, TS_PacketBuffer, static_cast<uint64_t>(TS_PacketBuffer - Chunk.Data) - Chunk.PrefixLength);
+      if (Ctx.PCRAnalyzer) Ctx.PCRAnalyzer->AddRecord(Record, static_cast<uint64_t>(TS_PacketBuffer - Chunk.Data) - Chunk.PrefixLength);
+      if (Ctx.Bitrate)     Ctx.Bitrate->AddPacket(Record);
+    }
+    if (Ctx.Monitor) {
+      Ctx.Monitor->AddRecord(Record, TS_PacketBuffer,
+                             TS_PacketBuffer ? static_cast<uint64_t>(TS_PacketBuffer - Chunk.Data) - Chunk.PrefixLength : Record.PCR);
+    }
+
+    if (Ctx.Records) {
+      EmitRecord(Ctx, Record);
+    } else if (!Ctx.PSI_Log.empty()) {
+      Chunk.PSI_Logs.emplace_back(RecordIdx, std::move(Ctx.PSI_Log));
+      Ctx.PSI_Log.clear();
+    }
+  }
+  Ctx.TS_PacketId += static_cast<int32_t>(Chunk.NumPackets);
+  Ctx.NumNull     += Chunk.NumNull;
+}
+
+/**
+ * @brief Renders the merged records of a chunk as text (pool task)
+ */
+static void RenderChunk(xParseChunk& Chunk)
+{
+  Chunk.Text.Clear();
+  RenderRecords(Chunk.Text, Chunk.Records, Chunk.PSI_Logs, Chunk.DropNull);
+}
+
+/**
+ * @brief Analyzes a completely mapped input in packet-aligned chunks on a thread pool
+ *
+ * Pipeline over a sliding window of chunks:
+ * 1. Pool:        ParseChunk() - sync handling, header and adaptation field analysis
+ * 2. Main thread: chunk stitching in stream order - a chunk whose first packet does not
+ *                 follow the previous chunk's last one (sync loss crossing the boundary)
+ *                 is parsed again from the right offset, then MergeChunk()
+ * 3. Pool:        RenderChunk() (text output)
+ * 4. Main thread: chunk text handed to the output writer in stream order
+ *
+ * Output is identical to sequential processing.
+ *
+ * @param Ctx          Analysis state
+ * @param SyncScanner  Sync acquisition engine (receives the joined state of all chunks)
+ * @param PacketFormat Packet layout
+ * @param Data         Whole input
+ * @param Size         Number of input bytes
+ * @param NumThreads   Number of pool threads
+ * @param NumChunks    Receives the number of chunks
+ * @return Number of chunks parsed again on the main thread
+ */
+static uint64_t ProcessParallel(xAnalysisContext& Ctx, xTS_SyncScanner& SyncScanner, const xTS_PacketFormat& PacketFormat,
+                                const uint8_t* Data, size_t Size, uint32_t NumThreads, uint64_t& NumChunks)
+{
+  const uint64_t ChunkSize   = static_cast<uint64_t>(xParseChunk::NumChunkPackets) * PacketFormat.getStride();
+  const uint32_t RenderDepth = NumThreads;       // chunks being rendered while the main thread merges
+  const uint32_t WindowSize  = NumThreads * 4;   // chunks parsed, merged or rendered at a time
+  NumChunks = (Size + ChunkSize - 1) / ChunkSize;
+
+  xTS_ThreadPool Pool(NumThreads);
+  std::vector<std::unique_ptr<xParseChunk>> Window;
+  for (uint32_t SlotIdx = 0; SlotIdx < WindowSize; SlotIdx++) {
+    Window.emplace_back(new xParseChunk());
+    Window.back()->Data        = Data;
+    Window.back()->Size        = Size;
+    Window.back()->Resync      = Ctx.Resync;
+    Window.back()->PrefixLength = PacketFormat.getPrefixLength();
+    Window.back()->NullRecords = !Ctx.DropNull || Ctx.Monitor || Ctx.Bitrate;
+    Window.back()->DropNull    = Ctx.DropNull;
+    Window.back()->SyncScanner = SyncScanner;
+  }
+
+  auto SubmitParse = [&](uint64_t ChunkIdx) {
+    if (ChunkIdx >= NumChunks) return;
+    xParseChunk& Chunk = *Window[ChunkIdx % WindowSize];
+    Chunk.Begin = ChunkIdx * ChunkSize;
+    Chunk.End   = std::min<uint64_t>(Chunk.Begin + ChunkSize, Size);
+    Chunk.Task  = Pool.Submit([&Chunk, &PacketFormat]() { ParseChunk(Chunk, PacketFormat, FindChunkStart(Chunk, PacketFormat)); });
+  };
+  auto WriteChunk = [&](uint64_t ChunkIdx) {
+    xParseChunk& Chunk = *Window[ChunkIdx % WindowSize];
+    if (Chunk.Task.valid()) Chunk.Task.get();
+    if (!Ctx.Records) Ctx.Output->Put(Chunk.Text.getData(), Chunk.Text.getSize());
+    SubmitParse(ChunkIdx + WindowSize); // the slot is free again
+  };
+
+  for (uint64_t ChunkIdx = 0; ChunkIdx < WindowSize; ChunkIdx++) SubmitParse(ChunkIdx);
+
+  uint64_t NumReparsed = 0;
+  uint64_t NextOffset  = 0; // where the previous chunk stopped
+  for (uint64_t ChunkIdx = 0; ChunkIdx < NumChunks; ChunkIdx++) {
+    xParseChunk& Chunk = *Window[ChunkIdx % WindowSize];
+    Chunk.Task.get();
+    if (Chunk.Start != NextOffset) {
+      ParseChunk(Chunk, PacketFormat, NextOffset);
+      NumReparsed++;
+    }
+    NextOffset = Chunk.Next;
+    SyncScanner.Append(Chunk.SyncScanner);
+
+    MergeChunk(Ctx, Chunk);
+    if (!Ctx.Records) Chunk.Task = Pool.Submit([&Chunk]() { RenderChunk(Chunk); });
+    if (ChunkIdx >= RenderDepth) WriteChunk(ChunkIdx - RenderDepth);
+  }
+  for (uint64_t ChunkIdx = NumChunks > RenderDepth ? NumChunks - RenderDepth : 0; ChunkIdx < NumChunks; ChunkIdx++) {
+    WriteChunk(ChunkIdx);
+  }
+  return NumReparsed;
+}
+
+//=============================================================================================================================================================================
+// Pipelined analysis (--pipeline)
+//=============================================================================================================================================================================
+
+/**
+ * @brief Reader stage - fills free input blocks from the input source (reader thread)
+ */
+static void ReaderStage(xTS_InputSource& Input, xAnalysisPipeline& Pipeline)
+{
+  for (;;) {
+    xInputBlock* Block     = Pipeline.FreeInput.Pop();
+    const size_t Available = Input.Request(Pipeline.BlockSize);
+    Block->Size       = std::min(Available, Pipeline.BlockSize);
+    Block->Position   = Input.getPosition();
+    Block->EndOfInput = Available < Pipeline.BlockSize; // sources return less only at end of input
+    memcpy(Block->Data, Input.getData(), Block->Size);
+    Input.Consume(Block->Size);
+    Pipeline.FilledInput.Push(Block);
+    if (Block->EndOfInput) return;
+  }
+}
+
+/**
+ * @brief Parse stage - analyzes input blocks in stream order (calling thread)
+ *
+ * Runs the same ProcessBlock() as sequential mode; records are handed to the
+ * formatter stage by EmitRecord(). Bytes left at the end of a block (at most one
+ * packet plus the sync confirmation span) are carried into the next block.
+ */
+static void ParseStage(xAnalysisContext& Ctx, xTS_SyncScanner& SyncScanner, const xTS_PacketFormat& PacketFormat, xAnalysisPipeline& Pipeline)
+{
+  std::vector<uint8_t> Carry;
+  Carry.reserve(Pipeline.CarrySize);
+  for (;;) {
+    xInputBlock*   Block     = Pipeline.FilledInput.Pop();
+    uint8_t*       Data      = Block->Data - Carry.size();
+    const size_t   Available = Carry.size() + Block->Size;
+    memcpy(Data, Carry.data(), Carry.size());
+
+    const size_t Processed = ProcessBlock(PacketFormat, Ctx, SyncScanner, Data, Available, Available,
+                                          Block->Position - Carry.size(), Block->EndOfInput);
+    Carry.assign(Data + Processed, Data + Available);
+
+    const bool EndOfInput = Block->EndOfInput;
+    Pipeline.FreeInput.Push(Block);
+    if (EndOfInput) return;
+  }
+}
+
+/**
+ * @brief Formatter stage - renders record blocks or appends them to the record file (formatter thread)
+ */
+static void FormatterStage(xTS_OutputWriter* Output, xTS_RecordWriter* Records, xAnalysisPipeline& Pipeline)
+{
+  for (;;) {
+    xRecordBlock* Block = Pipeline.FilledRecords.Pop();
+    if (!Block) return;
+    if (Records) {
+      for (const xTS_PacketRecord& Record : Block->Records) Records->Append(Record);
+    } else {
+      RenderRecords(*Output, Block->Records, Block->PSI_Logs);
+    }
+    Block->Records.clear();
+    Block->PSI_Logs.clear();
+    Pipeline.FreeRecords.Push(Block);
+  }
+}
+
+/**
+ * @brief Prints the PCR timing analysis, two lines per PCR PID (--pcr-analysis)
+ */
+static void PrintPCRAnalysis(const xTS_PCRAnalyzer& Analyzer)
+{
+  if (Analyzer.getStreams().empty()) printf("PCR analysis: no PCR found\n");
+  for (const xTS_PCRAnalyzer::xStream& Stream : Analyzer.getStreams()) {
+    printf("PCR PID %d: PCRs: %" PRIu64 ", discontinuities: %" PRIu64 ", interval: mean %.3f ms, min %.3f ms, max %.3f ms, p99 %.3f ms\n",
+           Stream.PID, Stream.NumPCRs, Stream.NumDiscontinuities, Stream.Interval.getMean(), Stream.Interval.getMin(),
+           Stream.Interval.getMax(), Stream.IntervalHist.getPercentile(99) / 1000.0);
+    printf("PCR PID %d: jitter: mean %.1f ns, stddev %.1f ns, min %.1f ns, max %.1f ns, |p50| %" PRIu64 " ns, |p99| %" PRIu64 " ns, ",
+           Stream.PID, Stream.Jitter.getMean(), Stream.Jitter.getStdDev(), Stream.Jitter.getMin(), Stream.Jitter.getMax(),
+           Stream.JitterHist.getPercentile(50), Stream.JitterHist.getPercentile(99));
+    if (Stream.ATS) {
+      printf("frequency offset: %.3f ppm (%u s blocks: min %.3f, max %.3f), drift: %.3f ppm/h\n",
+             Stream.getFrequencyOffset(), xTS_PCRAnalyzer::BlockDuration, Stream.BlockSlope.getMin(), Stream.BlockSlope.getMax(),
+             Stream.getDrift());
+    } else {
+      printf("bitrate: %.3f Mbit/s (%u s blocks: min %.3f, max %.3f)\n",
+             Stream.getBitrate() / 1e6, xTS_PCRAnalyzer::BlockDuration, Stream.BlockSlope.getMin(), Stream.BlockSlope.getMax());
+    }
+  }
+}
+
 /**
  * @brief Main application entry point for MPEG-2 Transport Stream analysis
  * 
@@ -72,210 +1104,406 @@ void SaveBinaryToTextFile(const uint8_t* data, size_t size, const std::string& o
  * assembly for audio streams. Results are written to "analysis_output.txt" with
  * detailed per-packet information.
  * 
- * Command line usage: ./TS-PARSER <input_file>
+ * Command line usage: ./TS-PARSER [options] <input_file>
  * 
  * Processing workflow:
- * 1. Parse 188-byte TS packet headers
- * 2. Process adaptation fields when present (PCR/OPCR/stuffing bytes)
- * 3. Assemble PES packets for audio PID (136)
- * 4. Validate packet continuity and PES packet integrity
- * 5. Generate formatted analysis output
+ * 1. Fetch large blocks from the input source (memory mapping or buffered reads)
+ * 2. Detect packet layout (188-byte TS, 192-byte M2TS, 204-byte TS with RS parity)
+ * 3. Parse TS packet headers directly inside the block, re-acquiring
+ *    sync lock and reporting skipped bytes when the sync byte is lost
+ * 4. Process adaptation fields when present (PCR/OPCR/stuffing bytes)
+ * 5. Assemble PES packets for the selected PIDs (default: audio PID 136), or for the
+ *    elementary streams discovered from PAT/PMT (--pes=auto)
+ * 6. Validate packet continuity and PES packet integrity
+ * 7. Generate formatted analysis output (formatted into large chunks, written by a
+ *    separate writer thread)
  * 
  * Output format per packet:
- * "XXXXXXXXXX TS: SB=XX E=X S=X P=X PID=XXXX TSC=X AF=X CC=XX [AF details] [PES status]"
+ * "XXXXXXXXXX TS: SB=XX E=X S=X P=X PID=XXXX TSC=X AF=X CC=XX [ATS=X] [AF details] [PES status]"
  * 
  * @param argc Command line argument count
- * @param argv Command line arguments (argv[1] = input file path)
- * @param envp Environment variables (unused)
+ * @param argv Command line arguments (options followed by input file path)
  * @return EXIT_SUCCESS on successful completion, EXIT_FAILURE on error
  * 
- * @note Requires input file to contain valid MPEG-2 TS packets (188 bytes each)
+ * @note Requires input file to contain MPEG-2 TS packets (188, 192 or 204 bytes each)
  * @note Creates "analysis_output.txt" in current directory with analysis results
- * @note Currently configured for audio PID 136 (commonly used in DVB broadcasts)
+ * @note PES assembly defaults to audio PID 136 (commonly used in DVB broadcasts), see --pes
  */
-int main(int argc, char *argv[], char *envp[])
+int main(int argc, char *argv[])
 {
   // Validate command line arguments
-  if (argc < 2)
+  xParserOptions Options;
+  if (!ParseArguments(argc, argv, Options))
   {
-    printf("Usage: %s <input_file>\n", argv[0]);
+    PrintUsage(argv[0]);
     return EXIT_FAILURE;
   }
 
-  // Open input Transport Stream file in binary mode
-  std::ifstream inputFile(argv[1], std::ios::binary);
-  if (!inputFile.is_open())
+  // Open input Transport Stream
+  std::unique_ptr<xTS_InputSource> Input = xTS_InputSource::Create(Options.InputType, Options.InputFileName, Options.InputConfig);
+  if (!Input->Open(Options.InputFileName))
   {
-    printf("Error: Could not open file %s\n", argv[1]);
+    printf("Error: Could not open file %s\n", Options.InputFileName);
     return EXIT_FAILURE;
   }
 
-  // Create output file for analysis results
-  std::ofstream outputFile("analysis_output.txt");
-  if (!outputFile.is_open())
+  // Chunks of a mapped input are analyzed in parallel, other sources block by block (optionally pipelined)
+  // (a time window is analyzed sequentially)
+  const bool Parallel  = Options.NumThreads > 1 && !Options.TimeWindow && dynamic_cast<xTS_MmapInputSource*>(Input.get()) != nullptr;
+  const bool Live      = Input->isLive();
+  const bool Pipelined = Options.Pipeline && !Parallel && !Options.TimeWindow && !Live;
+  if (Options.NumThreads > 1 && !Parallel && !Options.TimeWindow) {
+    printf("Warning: --threads requires the mmap input backend, parsing sequentially\n");
+  }
+
+  // PCR time index - written during the analysis, or read to locate the requested time window
+  xTS_TimeIndexWriter TimeIndex;
+  uint64_t WindowStart = 0, WindowEnd = UINT64_MAX;
+  if (Options.TimeWindow) {
+    xTS_TimeIndexReader TimeIndexReader;
+    if (!TimeIndexReader.Open(Options.TimeIndexFile)) {
+      printf("Error: Could not read time index %s\n", Options.TimeIndexFile);
+      return EXIT_FAILURE;
+    }
+    WindowStart = TimeIndexReader.FindStartOffset(static_cast<uint64_t>(Options.TimeFrom * xTS_TimeIndex::ClockRate));
+    if (Options.TimeTo >= 0) WindowEnd = TimeIndexReader.FindEndOffset(static_cast<uint64_t>(Options.TimeTo * xTS_TimeIndex::ClockRate));
+
+    // Start at the random access point preceding the window (decodable from the first packet)
+    xTS_RAPIndexReader RAPIndexReader;
+    if (Options.RAPIndexFile) {
+      if (!RAPIndexReader.Open(Options.RAPIndexFile)) {
+        printf("Error: Could not read RAP index %s\n", Options.RAPIndexFile);
+        return EXIT_FAILURE;
+      }
+      const int32_t RAP_PID = Options.RAP_PID != NOT_VALID ? Options.RAP_PID : RAPIndexReader.getMainPID();
+      const xTS_RAPIndex::xEntry* RAP = RAP_PID != NOT_VALID ?
+        RAPIndexReader.FindByTime(static_cast<uint16_t>(RAP_PID), static_cast<uint64_t>(Options.TimeFrom * xTS_TimeIndex::ClockRate)) : nullptr;
+      if (RAP) WindowStart = RAP->Offset;
+    }
+  } else if (Options.TimeIndexFile) {
+    if (!TimeIndex.Open(Options.TimeIndexFile, Options.TimeIndexInterval)) {
+      printf("Error: Could not open file %s for writing\n", Options.TimeIndexFile);
+      return EXIT_FAILURE;
+    }
+  }
+  xTS_RAPIndexWriter RAPIndex;
+  if (Options.RAPIndexFile && !Options.TimeWindow && !RAPIndex.Open(Options.RAPIndexFile)) {
+    printf("Error: Could not open file %s for writing\n", Options.RAPIndexFile);
+    return EXIT_FAILURE;
+  }
+
+  // TR 101 290 monitor - totals only, or a report row per window
+  xTS_TR101290Monitor TR101290;
+  if (Options.TR101290 && !TR101290.Open(Options.TR101290File, Options.TR101290Window)) {
+    printf("Error: Could not open file %s for writing\n", Options.TR101290File);
+    return EXIT_FAILURE;
+  }
+
+  // PCR timing analysis - reported at exit
+  xTS_PCRAnalyzer PCRAnalyzer;
+
+  // Bitrate meter - statistics only, or a time series row per window
+  xTS_BitrateMeter Bitrate;
+  if (Options.Bitrate && !Bitrate.Open(Options.BitrateFile, Options.BitrateWindow)) {
+    printf("Error: Could not open file %s for writing\n", Options.BitrateFile);
+    return EXIT_FAILURE;
+  }
+
+  // Create output file for analysis results (text lines or binary records)
+  xTS_OutputWriter outputFile;
+  xTS_RecordWriter recordFile;
+  const char* OutputFileName = Options.BinaryOutput ? "analysis_output.bin" : "analysis_output.txt";
+  if (!(Options.BinaryOutput ? recordFile.Open(OutputFileName) : outputFile.Open(OutputFileName)))
   {
-    printf("Error: Could not open file analysis_output.txt for writing\n");
+    printf("Error: Could not open file %s for writing\n", OutputFileName);
     return EXIT_FAILURE;
   }
   
-  // Initialize parsing objects and variables
-  xTS_PacketHeader TS_PacketHeader;      // TS packet header parser
-  xTS_AdaptationField TS_AdaptationField; // Adaptation field parser
-  uint8_t TS_PacketBuffer[xTS::TS_PacketLength]; // 188-byte packet buffer
-  int32_t TS_PacketId = 0;               // Sequential packet counter
-  
-  // Initialize PES assembler for audio stream analysis
-  const int32_t AUDIO_PID = 136;         // Target PID for audio stream (DVB standard)
-  xPES_Assembler PES_Assembler;
-  PES_Assembler.Init(AUDIO_PID);
-
-// Main packet processing loop - read and analyze each 188-byte TS packet
-while (inputFile.read(reinterpret_cast<char*>(TS_PacketBuffer), xTS::TS_PacketLength)) {
-  // Reset parser objects for new packet
-  TS_PacketHeader.Reset();
-  TS_AdaptationField.Reset();
-  
-  // Parse Transport Stream packet header (4 bytes)
-  if (TS_PacketHeader.Parse(TS_PacketBuffer) == xTS::TS_HeaderLength) {
-    // Parse adaptation field if present (AFC = 2 or 3)
-    if (TS_PacketHeader.getAdaptationFieldControl() == 2 || 
-        TS_PacketHeader.getAdaptationFieldControl() == 3) {
-      int32_t result = TS_AdaptationField.Parse(TS_PacketBuffer + xTS::TS_HeaderLength, 
-                                                TS_PacketHeader.getAdaptationFieldControl());
-      if (result < 0) {
-        outputFile << "Error parsing adaptation field in packet " << TS_PacketId << "\n";
+  // Initialize parsing objects and PES demuxer for elementary stream analysis
+  xAnalysisContext Ctx;
+  Ctx.Output  = &outputFile;
+  Ctx.Records = Options.BinaryOutput ? &recordFile : nullptr;
+  Ctx.Resync = Options.Resync;
+  Ctx.TimeIndex = Options.TimeIndexFile && !Options.TimeWindow ? &TimeIndex : nullptr;
+  Ctx.RAPIndex  = Options.RAPIndexFile  && !Options.TimeWindow ? &RAPIndex  : nullptr;
+  Ctx.Monitor   = Options.TR101290 ? &TR101290 : nullptr;
+  Ctx.PCRAnalyzer = Options.PCRAnalysis ? &PCRAnalyzer : nullptr;
+  Ctx.Bitrate   = Options.Bitrate ? &Bitrate : nullptr;
+  Ctx.DropNull  = Options.DropNull;
+  Ctx.PES_OutPrefix = Options.PES_OutPrefix;
+  Ctx.PES_Demuxer.setZeroCopy(Options.PES_OutPrefix != nullptr && !Pipelined); // pipeline input blocks are recycled, payload is copied
+  Ctx.PES_Demuxer.setCallback([&Ctx](int32_t PID, const xPES_Assembler& Assembler)
+  {
+    Ctx.PES_Bytes += Assembler.getNumPacketBytes();
+    if (!Ctx.PES_OutPrefix) return;
+
+    // Elementary stream output - file is created with the first complete PES packet of the PID
+    std::unique_ptr<xPES_FileSink>& Sink = Ctx.PES_Sinks[PID];
+    if (!Sink) {
+      Sink.reset(new xPES_FileSink());
+      std::string FileName = std::string(Ctx.PES_OutPrefix) + "_" + std::to_string(PID) + ".pes";
+      if (!Sink->Open(FileName.c_str())) {
+        printf("Error: Could not open file %s for writing\n", FileName.c_str());
       }
     }
-    
-    // Format and output basic TS packet header information
-    char buffer[256];
-    snprintf(buffer, sizeof(buffer), "%010d TS: SB=%02X E=%d S=%d P=%d PID=%4d TSC=%d AF=%d CC=%2d",
-             TS_PacketId,
-             TS_PacketHeader.getSyncByte(),
-             TS_PacketHeader.getTransportErrorIndicator(),
-             TS_PacketHeader.getPayloadUnitStartIndicator(),
-             TS_PacketHeader.getTransportPriority(),
-             TS_PacketHeader.getPID(),
-             TS_PacketHeader.getTransportScramblingControl(),
-             TS_PacketHeader.getAdaptationFieldControl(),
-             TS_PacketHeader.getContinuityCounter());
-    outputFile << buffer;
-    
-    // Output adaptation field details if present
-    if (TS_PacketHeader.getAdaptationFieldControl() == 2 || 
-        TS_PacketHeader.getAdaptationFieldControl() == 3) {
-      char afBuffer[256];
-      snprintf(afBuffer, sizeof(afBuffer), " AF: L=%d DC=%d RA=%d SP=%d PR=%d OR=%d SF=%d TP=%d EX=%d",
-               TS_AdaptationField.getAdaptationFieldLength(),
-               TS_AdaptationField.getDiscontinuityIndicator(),
-               TS_AdaptationField.getRandomAccessIndicator(),
-               TS_AdaptationField.getESPriorityIndicator(),
-               TS_AdaptationField.getPCRFlag(),               TS_AdaptationField.getOPCRFlag(),
-               TS_AdaptationField.getSplicingPointFlag(),
-               TS_AdaptationField.getTransportPrivateDataFlag(),
-               TS_AdaptationField.getExtensionFlag());
-      outputFile << afBuffer;
-      
-      // Output Program Clock Reference (PCR) timing information if present
-      if (TS_AdaptationField.getPCRFlag()) {
-        outputFile << " PCR_base=" << TS_AdaptationField.getPCRBase()
-                  << " PCR_ext=" << TS_AdaptationField.getPCRExtension()
-                  << " PCR=" << TS_AdaptationField.getPCR();
-      }
-      
-      // Output Original Program Clock Reference (OPCR) timing information if present
-      if (TS_AdaptationField.getOPCRFlag()) {
-        outputFile << " OPCR_base=" << TS_AdaptationField.getOPCRBase()
-                  << " OPCR_ext=" << TS_AdaptationField.getOPCRExtension()
-                  << " OPCR=" << TS_AdaptationField.getOPCR();
-      }
-      
-      // Output stuffing byte count for padding analysis
-      outputFile << " StuffingBytes=" << TS_AdaptationField.getStuffingBytes();
-    }
-    
-    // Process PES packet assembly for target audio PID
-    if (TS_PacketHeader.getPID() == AUDIO_PID) {
-      xPES_Assembler::eResult result = PES_Assembler.AbsorbPacket(TS_PacketBuffer, 
-                                                                  &TS_PacketHeader, 
-                                                                  &TS_AdaptationField);
-      
-      // Output PES assembly status and information
-      switch (result) {
-        case xPES_Assembler::eResult::UnexpectedPID:
-          // Should not occur due to PID filtering, but included for completeness
-          break;
-          
-        case xPES_Assembler::eResult::StreamPackedLost:
-          outputFile << " PES: PacketLost";
-          break;
-          
-        case xPES_Assembler::eResult::AssemblingStarted:
-          outputFile << " PES: Started";
-          // Output PES header information for new packet
-          outputFile << " PES: PSCP=" << PES_Assembler.m_PESH.getPacketStartCodePrefix()
-                    << " SID=" << static_cast<int>(PES_Assembler.m_PESH.getStreamId())
-                    << " L=" << PES_Assembler.m_PESH.getPacketLength();
-          
-          // Include timing information if available
-          if (PES_Assembler.m_PESH.hasPTS()) {
-            outputFile << " PTS=" << PES_Assembler.m_PESH.getPTS();
-          }
-          if (PES_Assembler.m_PESH.hasDTS()) {
-            outputFile << " DTS=" << PES_Assembler.m_PESH.getDTS();
-          }
-          break;
-          
-        case xPES_Assembler::eResult::AssemblingContinue:
-          outputFile << " PES: Continue";
-          break;
-          
-        case xPES_Assembler::eResult::AssemblingFinished:
-          outputFile << " PES: Finished Length=" << PES_Assembler.getNumPacketBytes();
-          
-          // Perform PES packet integrity verification
-          if (PES_Assembler.m_PESH.getPacketLength() > 0) {
-            // Calculate expected PES packet size: 6-byte header + PacketLength field
-            uint32_t expectedLength = PES_Assembler.m_PESH.getPacketLength() + 6;
-            uint32_t actualLength = PES_Assembler.getNumPacketBytes();
-            uint32_t totalStuffing = PES_Assembler.getTotalStuffingBytes();
-            
-            outputFile << " StuffingBytes=" << totalStuffing;
-            
-            // Verify packet length integrity (stuffing bytes don't affect PES length)
-            int32_t difference = std::abs(static_cast<int32_t>(expectedLength - actualLength));
-            
-            if (difference == 0) {
-              outputFile << " (Verified OK - exact match)";
-            } else if (difference <= 4) {
-              outputFile << " (Verified OK with tolerance)";
-            } else {
-              outputFile << " (Length mismatch: expected=" << expectedLength 
-                        << ", actual=" << actualLength
-                        << ", diff=" << difference << ")";
-            }
-          }
-          break;
-          
-        default:
-          break;
-      }
+    Sink->Write(Assembler);
+  });
+  Ctx.PES_Demuxer.setAutoAdd(Options.PES_AllPIDs);
+  Ctx.PES_Demuxer.setBufferPool(Options.PES_Pool ? &Ctx.PES_BufferPool : nullptr);
+  for (int32_t PID : Options.PES_PIDs) {
+    Ctx.PES_Demuxer.AddPID(PID);
+  }
+
+  // Program discovery - PES assemblers are created for the elementary streams each PMT lists
+  Ctx.PSI_Enabled = Options.PES_AutoPIDs || Options.PSI_Print;
+  const bool PSI_Print = Options.PSI_Print, PES_AutoPIDs = Options.PES_AutoPIDs;
+  Ctx.PSI_Tracker.setPATCallback([&Ctx, PSI_Print](const xPSI_PAT& PAT)
+  {
+    if (!PSI_Print) return;
+    char Line[64];
+    snprintf(Line, sizeof(Line), "PAT: TSID=%u V=%u Programs:", PAT.getTransportStreamId(), PAT.getHeader().getVersionNumber());
+    Ctx.PSI_Log += Line;
+    for (const xPSI_PAT::xProgram& Program : PAT.getPrograms()) {
+      snprintf(Line, sizeof(Line), Program.ProgramNumber ? " %u->PMT_PID=%u" : " %u->NIT_PID=%u", Program.ProgramNumber, Program.PID);
+      Ctx.PSI_Log += Line;
+    }
+    Ctx.PSI_Log += "\n";
+  });
+  Ctx.PSI_Tracker.setPMTCallback([&Ctx, PSI_Print, PES_AutoPIDs](int32_t PID, const xPSI_PMT& PMT)
+  {
+    for (const xPSI_PMT::xStream& Stream : PMT.getStreams()) {
+      if (PES_AutoPIDs && xPSI_PMT::isPES(Stream.StreamType)) Ctx.PES_Demuxer.AddPID(Stream.PID);
+    }
+    if (!PSI_Print) return;
+    char Line[96];
+    snprintf(Line, sizeof(Line), "PMT: PID=%d Program=%u V=%u PCR_PID=%u Streams:", PID, PMT.getProgramNumber(),
+             PMT.getHeader().getVersionNumber(), PMT.getPCR_PID());
+    Ctx.PSI_Log += Line;
+    for (const xPSI_PMT::xStream& Stream : PMT.getStreams()) {
+      snprintf(Line, sizeof(Line), " PID=%u Type=0x%02X (%s)", Stream.PID, Stream.StreamType, xPSI_PMT::getStreamTypeName(Stream.StreamType));
+      Ctx.PSI_Log += Line;
+    }
+    Ctx.PSI_Log += "\n";
+  });
+
+  // Live input (growing file, network) - output and indexes are brought up to date when the parser waits for data (network: once idle)
+  if (Live) {
+    Input->setIdleCallback([&]()
+    {
+      if (Options.BinaryOutput) recordFile.Flush();
+      else                      outputFile.Flush();
+      if (Ctx.TimeIndex) TimeIndex.Flush();
+      if (Ctx.RAPIndex)  RAPIndex.Flush();
+      if (Ctx.Monitor)   TR101290.Flush();
+      if (Ctx.Bitrate)   Bitrate.Flush();
+    });
+    signal(SIGINT,  [](int) { xTS_InputSource::RequestStop(); });
+    signal(SIGTERM, [](int) { xTS_InputSource::RequestStop(); });
+  }
+
+  // Detect packet layout (188/192/204) from the start of the input
+  xTS_PacketFormat PacketFormat(Options.PacketFormat);
+  if (Options.ProbeFormat) {
+    Input->Request(Live ? 64 * 1024 : Options.InputConfig.BlockSize); // a live source may not fill a block for a long time
+    PacketFormat = xTS_SyncScanner::ProbeFormat(Input->getData(), std::min<size_t>(Input->getAvailable(), 64 * 1024));
+  }
+
+  // Sync acquisition engine used when a packet does not start with the sync byte
+  xTS_SyncScanner SyncScanner(PacketFormat.getStride(), Options.SyncConfirm);
+  TR101290.setStride(PacketFormat.getStride());
+
+
+  // Move to the time window (sources which cannot seek skip the leading bytes)
+  if (WindowStart && !Input->Seek(WindowStart)) {
+    while (Input->getPosition() < WindowStart) {
+      const size_t Available = Input->Request(Options.InputConfig.BlockSize);
+      if (Available == 0) break;
+      Input->Consume(static_cast<size_t>(std::min<uint64_t>(Available, WindowStart - Input->getPosition())));
     }
-    
-    // Complete packet analysis line
-    outputFile << "\n";
+  }
+  const uint64_t StartPosition = Input->getPosition();
+
+  const auto StartTime = std::chrono::steady_clock::now();
+  uint64_t NumChunks = 0, NumReparsed = 0;
+  std::unique_ptr<xAnalysisPipeline> Pipeline;
+  std::thread                        FormatterThread;
+
+  if (Parallel) {
+    const size_t Available = Input->Request(static_cast<size_t>(Input->getSize()));
+    if (Ctx.PES_OutPrefix) Ctx.Block = Input->getBlockRef();
+    NumReparsed = ProcessParallel(Ctx, SyncScanner, PacketFormat, Input->getData(), Available, Options.NumThreads, NumChunks);
+    Ctx.Block.reset();
+    Input->Consume(Available);
+  } else if (Pipelined) {
+    // Reader and formatter threads around the parse stage; blocks carry at most one packet plus the sync confirmation span
+    Pipeline.reset(new xAnalysisPipeline(Options.InputConfig.BlockSize, (Options.SyncConfirm + 1) * xTS::RS_PacketLength));
+    Ctx.Pipeline    = Pipeline.get();
+    FormatterThread = std::thread(FormatterStage, Ctx.Output, Ctx.Records, std::ref(*Pipeline));
+    std::thread ReaderThread(ReaderStage, std::ref(*Input), std::ref(*Pipeline));
+    ParseStage(Ctx, SyncScanner, PacketFormat, *Pipeline);
+    ReaderThread.join();
   } else {
-    // TS packet header parsing failed
-    outputFile << "Error parsing packet " << TS_PacketId << "\n";
+    // Main processing loop - fetch a block and analyze each packet in place
+    // (live input is parsed as soon as anything arrived after the bytes left unprocessed)
+    size_t Unprocessed = 0;
+    for (;;) {
+      const size_t   MinBytes   = Live ? std::min(Unprocessed + 1, Options.InputConfig.BlockSize) : Options.InputConfig.BlockSize;
+      const size_t   Available  = Input->Request(MinBytes);
+      const bool     EndOfInput = Available < MinBytes; // sources return less only at end of input
+      const uint8_t* Block      = Input->getData();
+      const uint64_t Position   = Input->getPosition();
+
+      // PES payload slices keep the block alive (zero-copy elementary stream output)
+      if (Ctx.PES_OutPrefix) Ctx.Block = Input->getBlockRef();
+
+      // Packets starting at or after the end of the time window are not analyzed
+      const size_t Limit     = static_cast<size_t>(std::min<uint64_t>(Available, WindowEnd - Position));
+      const size_t Processed = ProcessBlock(PacketFormat, Ctx, SyncScanner, Block, Available, Limit, Position, EndOfInput);
+
+      Ctx.Block.reset(); // the window must not be pinned across Request()
+      Input->Consume(Processed);
+      Unprocessed = Available - Processed;
+      if (EndOfInput || Input->getPosition() >= WindowEnd) break;
+    }
+  }
+
+  // Report unbounded PES units still being assembled
+  Ctx.PES_Demuxer.Flush();
+
+  // Report loss which did not end with a new lock
+  if (!SyncScanner.isLocked()) {
+    EmitSyncLoss(Ctx, SyncScanner, xTS_PacketRecord::eKind::SyncLossFinal);
+  }
+
+  // Hand the last records to the formatter stage and wait until it has written them
+  if (Pipelined) {
+    if (Pipeline->Current) Pipeline->FilledRecords.Push(Pipeline->Current);
+    Pipeline->FilledRecords.Push(nullptr);
+    FormatterThread.join();
   }
-  
-  // Increment packet counter for next iteration
-  TS_PacketId++;
-}
 
   // Cleanup and return success
-  inputFile.close();
-  outputFile.close();
+  if (!(Options.BinaryOutput ? recordFile.Close() : outputFile.Close())) {
+    printf("Error: Could not write %s\n", OutputFileName);
+  }
+  const uint64_t NumIndexEntries = TimeIndex.getNumEntries();
+  if (Ctx.TimeIndex && !TimeIndex.Close()) {
+    printf("Error: Could not write %s\n", Options.TimeIndexFile);
+  }
+  const uint32_t NumRAP_PIDs = RAPIndex.getNumPIDs();
+  if (Ctx.RAPIndex && !RAPIndex.Close()) {
+    printf("Error: Could not write %s\n", Options.RAPIndexFile);
+  }
+  if (Ctx.Monitor && !TR101290.Close()) {
+    printf("Error: Could not write %s\n", Options.TR101290File);
+  }
+  if (Ctx.Bitrate && !Bitrate.Close()) {
+    printf("Error: Could not write %s\n", Options.BitrateFile);
+  }
+
+  if (Options.PrintStats) {
+    const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+    const uint64_t Bytes = Input->getPosition() - StartPosition;
+    printf("Input: %s, format: %s, packets: %d, bytes: %" PRIu64 ", time: %.3f s, throughput: %.3f GB/s (%.1f Mpackets/s)\n",
+           Input->getName(), PacketFormat.getName(), Ctx.TS_PacketId, Bytes, Seconds,
+           Seconds > 0 ? Bytes / Seconds / 1e9 : 0.0,
+           Seconds > 0 ? Ctx.TS_PacketId / Seconds / 1e6 : 0.0);
+    printf("Sync: losses: %" PRIu64 ", lost bytes: %" PRIu64 ", scanner: %s, header decoder: %s\n",
+           SyncScanner.getNumSyncLosses(), SyncScanner.getNumLostBytes(), SyncScanner.getKernelName(),
+           Ctx.TS_PacketBatch.getKernelName());
+    printf("Null packets: %" PRIu64 " (%.1f%%)%s\n", Ctx.NumNull, Ctx.TS_PacketId ? 100.0 * Ctx.NumNull / Ctx.TS_PacketId : 0.0,
+           Options.DropNull ? ", dropped from output" : "");
+    printf("PES: PIDs: %u, units: %" PRIu64 ", bytes: %" PRIu64 ", buffer allocations: %" PRIu64,
+           Ctx.PES_Demuxer.getNumActivePIDs(), Ctx.PES_Demuxer.getNumUnits(), Ctx.PES_Bytes,
+           Ctx.PES_Demuxer.getNumBufferAllocations());
+    if (Options.PES_Pool) {
+      printf(" (pool: heap allocations: %" PRIu64 ", reuses: %" PRIu64 ")",
+             Ctx.PES_BufferPool.getNumAllocations(), Ctx.PES_BufferPool.getNumReuses());
+    }
+    printf("\n");
+    if (Options.BinaryOutput) {
+      printf("Output: records: %" PRIu64 ", bytes: %" PRIu64 "\n", recordFile.getNumRecords(), recordFile.getNumBytes());
+    } else {
+      printf("Output: bytes: %" PRIu64 ", write calls: %" PRIu64 ", writer stalls: %" PRIu64 "\n",
+             outputFile.getNumBytes(), outputFile.getNumCalls(), outputFile.getNumStalls());
+    }
+    if (Pipelined) {
+      printf("Pipeline: input ring: mean occupancy %.1f/%u, reader waits: %" PRIu64 ", parser waits: %" PRIu64
+             "; record ring: mean occupancy %.1f/%u, parser waits: %" PRIu64 ", formatter waits: %" PRIu64 "\n",
+             Pipeline->FilledInput.getAverageOccupancy(), Pipeline->FilledInput.getCapacity(),
+             Pipeline->FreeInput.getNumPopWaits(), Pipeline->FilledInput.getNumPopWaits(),
+             Pipeline->FilledRecords.getAverageOccupancy(), Pipeline->FilledRecords.getCapacity(),
+             Pipeline->FreeRecords.getNumPopWaits(), Pipeline->FilledRecords.getNumPopWaits());
+    }
+    if (Parallel) {
+      printf("Parallel: threads: %u, chunks: %" PRIu64 ", chunks parsed again: %" PRIu64 "\n", Options.NumThreads, NumChunks, NumReparsed);
+    }
+    if (Ctx.TimeIndex) {
+      printf("Time index: PCR PID: %d, entries: %" PRIu64 ", interval: %u ms\n", TimeIndex.getPCR_PID(), NumIndexEntries, Options.TimeIndexInterval);
+    }
+    if (const xTS_FollowInputSource* Follow = dynamic_cast<const xTS_FollowInputSource*>(Input.get())) {
+      printf("Follow: waits for data: %" PRIu64 ", file change notifications: %" PRIu64 "\n", Follow->getNumWaits(), Follow->getNumEvents());
+    }
+    if (const xTS_UdpInputSource* Udp = dynamic_cast<const xTS_UdpInputSource*>(Input.get())) {
+      printf("UDP: datagrams: %" PRIu64 ", receive calls: %" PRIu64 " (%.1f datagrams/call), waits: %" PRIu64 ", receive buffer: %u KiB\n",
+             Udp->getNumDatagrams(), Udp->getNumCalls(), Udp->getNumCalls() ? double(Udp->getNumDatagrams()) / Udp->getNumCalls() : 0.0,
+             Udp->getNumWaits(), Udp->getActualBufferSize() / 1024);
+      printf("UDP loss: RTP packets: %" PRIu64 ", lost: %" PRIu64 ", reordered: %" PRIu64 ", kernel drops: %" PRIu64 ", invalid datagrams: %" PRIu64 "\n",
+             Udp->getNumRTP(), Udp->getNumLost(), Udp->getNumReordered(), Udp->getNumKernelDrops(), Udp->getNumInvalid());
+    }
+    if (Ctx.RAPIndex) {
+      printf("RAP index: PIDs: %u, random access points: %" PRIu64 "\n", NumRAP_PIDs, RAPIndex.getNumEntries());
+    }
+    if (Options.TimeWindow) {
+      printf("Time window: %.3f s - ", Options.TimeFrom);
+      if (Options.TimeTo >= 0) printf("%.3f s", Options.TimeTo);
+      else                     printf("end");
+      printf(", bytes: %" PRIu64 " - %" PRIu64 "\n", StartPosition, Input->getPosition());
+    }
+    if (Ctx.Monitor) {
+      printf("TR 101 290: packets: %" PRIu64 ", PIDs: %u, clock PCR PID: %d, windows: %" PRIu64 "\n",
+             TR101290.getNumPackets(), TR101290.getNumPIDs(), TR101290.getRefPID(), TR101290.getNumWindows());
+      for (uint32_t Priority = 1; Priority <= 3; Priority++) {
+        printf("TR 101 290 P%u:", Priority);
+        for (uint32_t Idx = 0; Idx < xTS_TR101290::NumIndicators; Idx++) {
+          const xTS_TR101290::eIndicator Indicator = static_cast<xTS_TR101290::eIndicator>(Idx);
+          if (xTS_TR101290::getPriority(Indicator) != Priority) continue;
+          printf(" %s %s=%" PRIu64, xTS_TR101290::getNumber(Indicator), xTS_TR101290::getName(Indicator), TR101290.getTotal(Indicator));
+        }
+        printf("\n");
+      }
+    }
+    if (Ctx.Bitrate) {
+      printf("Bitrate: PCR PID: %d, dropped windows: %" PRIu64, Bitrate.getRefPID(), Bitrate.getNumDropped());
+      for (uint32_t Level = 0; Level < xTS_BitrateMeter::NumLevels; Level++) {
+        const xTS_RunningStats& Total = Bitrate.getTotalStats(Level);
+        printf("; %" PRIu64 " ms windows: %" PRIu64 ", mean %.3f, min %.3f, max %.3f Mbit/s", Bitrate.getWindowLength(Level),
+               Bitrate.getNumWindows(Level), Total.getMean() / 1e6, Total.getMin() / 1e6, Total.getMax() / 1e6);
+      }
+      printf("\nBitrate PIDs [Mbit/s]:");
+      for (uint32_t PID = 0; PID < xTS_BitrateMeter::NumPIDs; PID++) {
+        const double PIDBitrate = Bitrate.getMeanBitrate(static_cast<uint16_t>(PID));
+        if (PIDBitrate > 0) printf(" %u:%.3f", PID, PIDBitrate / 1e6);
+      }
+      printf("\n");
+    }
+    if (Ctx.PSI_Enabled) {
+      printf("PSI: programs: %zu, streams: %u, sections parsed: %" PRIu64 ", repetitions skipped: %" PRIu64 ", CRC errors: %" PRIu64 " (%s), invalid: %" PRIu64 "\n",
+             Ctx.PSI_Tracker.getPMTs().size(), Ctx.PSI_Tracker.getNumStreams(), Ctx.PSI_Tracker.getNumSections(),
+             Ctx.PSI_Tracker.getNumSkipped(), Ctx.PSI_Tracker.getNumCRCErrors(), xTS_CRC32().getKernelName(),
+             Ctx.PSI_Tracker.getNumInvalid());
+    }
+    if (Ctx.PES_OutPrefix) {
+      uint64_t NumBytes = 0, NumCalls = 0;
+      for (const auto& Sink : Ctx.PES_Sinks) {
+        NumBytes += Sink.second->getNumBytes();
+        NumCalls += Sink.second->getNumCalls();
+      }
+      printf("PES output: files: %zu, bytes: %" PRIu64 ", write calls: %" PRIu64 "\n", Ctx.PES_Sinks.size(), NumBytes, NumCalls);
+    }
+  }
+  if (Ctx.PCRAnalyzer) PrintPCRAnalysis(PCRAnalyzer);
+  Input->Close();
   return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,67 @@
+/**
+ * @file TS_records.cpp
+ * @brief Companion reader for binary analysis records
+ *
+ * Renders a record file written with --output=binary into the text format of
+ * analysis_output.txt. The record file is memory mapped and read block by block.
+ *
+ * Command line usage: ./TS-RECORDS <records_file> [<text_file>]
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsCommon.h"
+#include "../include/tsRecordFile.h"
+#include "../include/tsOutputWriter.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cinttypes>
+
+//=============================================================================================================================================================================
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2 || argc > 3)
+  {
+    printf("Usage: %s <records_file> [<text_file>]\n", argv[0]);
+    printf("Renders analysis records (TS-PARSER --output=binary) as text (default: analysis_output.txt)\n");
+    return EXIT_FAILURE;
+  }
+  const char* InputFileName  = argv[1];
+  const char* OutputFileName = argc > 2 ? argv[2] : "analysis_output.txt";
+
+  xTS_RecordReader Reader;
+  if (!Reader.Open(InputFileName))
+  {
+    printf("Error: %s is not a valid record file\n", InputFileName);
+    return EXIT_FAILURE;
+  }
+
+  xTS_OutputWriter Output;
+  if (!Output.Open(OutputFileName))
+  {
+    printf("Error: Could not open file %s for writing\n", OutputFileName);
+    return EXIT_FAILURE;
+  }
+
+  xTS_PacketRecord Record;
+  for (uint32_t BlockIdx = 0; BlockIdx < Reader.getNumBlocks(); BlockIdx++) {
+    const uint32_t NumRecords = Reader.getNumRecords(BlockIdx);
+    for (uint32_t RecordIdx = 0; RecordIdx < NumRecords; RecordIdx++) {
+      Reader.getRecord(BlockIdx, RecordIdx, Record);
+      Record.Render(Output);
+    }
+  }
+
+  if (!Output.Close())
+  {
+    printf("Error: Could not write %s\n", OutputFileName);
+    return EXIT_FAILURE;
+  }
+  printf("Rendered %" PRIu64 " records to %s\n", Reader.getNumRecords(), OutputFileName);
+  return EXIT_SUCCESS;
+}
+
+//=============================================================================================================================================================================
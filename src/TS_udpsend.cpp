@@ -0,0 +1,178 @@
+/**
+ * @file TS_udpsend.cpp
+ * @brief Companion sender streaming a Transport Stream file as UDP or RTP datagrams
+ *
+ * Sends the file in datagrams of 7 TS packets (1316 bytes), optionally behind an RTP
+ * header (payload type 33, MP2T), to a unicast or multicast address. Together with a
+ * udp:// or rtp:// input of TS-PARSER it tests the network receiver over loopback;
+ * --drop-every skips datagrams (their RTP sequence numbers are still used) to exercise
+ * the loss counters.
+ *
+ * Command line usage: ./TS-UDPSEND <input_file> <address>:<port> [--rtp] [--rate=<Mbit/s>] [--loop=<N>] [--drop-every=<N>] [--ttl=<N>]
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsCommon.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cinttypes>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_SOCKETS 1
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#else
+#define TS_HAS_SOCKETS 0
+#endif
+
+//=============================================================================================================================================================================
+
+/** @brief TS packets carried by one datagram */
+static constexpr size_t PacketsPerDatagram = 7;
+static constexpr size_t DatagramPayload    = PacketsPerDatagram * 188;
+static constexpr size_t RTP_HeaderLength   = 12;
+static constexpr uint8_t RTP_PayloadTypeMP2T = 33;
+
+static void PrintUsage(const char* ProgramName)
+{
+  printf("Usage: %s <input_file> <address>:<port> [options]\n", ProgramName);
+  printf("Streams a TS file in datagrams of %zu packets\n", PacketsPerDatagram);
+  printf("  --rtp               Prepend an RTP header (payload type %u)\n", RTP_PayloadTypeMP2T);
+  printf("  --rate=<Mbit/s>     Pace the stream to the given payload rate (default: as fast as possible)\n");
+  printf("  --loop=<N>          Send the file N times (default: 1)\n");
+  printf("  --drop-every=<N>    Skip every N-th datagram (default: none)\n");
+  printf("  --ttl=<N>           Multicast time to live (default: 1)\n");
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 3)
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  const char* InputFileName = argv[1];
+  const char* Destination   = argv[2];
+  bool     RTP       = false;
+  double   Rate      = 0;
+  uint32_t NumLoops  = 1;
+  uint32_t DropEvery = 0;
+  int      TTL       = 1;
+  for (int i = 3; i < argc; i++)
+  {
+    const char* Arg = argv[i];
+    if     (strcmp(Arg, "--rtp") == 0) { RTP = true; }
+    else if(strncmp(Arg, "--rate=", 7) == 0) { Rate = strtod(Arg + 7, nullptr); }
+    else if(strncmp(Arg, "--loop=", 7) == 0) { NumLoops = strtoul(Arg + 7, nullptr, 10); }
+    else if(strncmp(Arg, "--drop-every=", 13) == 0) { DropEvery = strtoul(Arg + 13, nullptr, 10); }
+    else if(strncmp(Arg, "--ttl=", 6) == 0) { TTL = atoi(Arg + 6); }
+    else
+    {
+      printf("Error: Unknown option %s\n", Arg);
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+#if TS_HAS_SOCKETS
+  // Whole input in memory - the send loop must not stall on disk reads
+  std::vector<uint8_t> Stream;
+  std::FILE* InputFile = std::fopen(InputFileName, "rb");
+  if (InputFile == nullptr)
+  {
+    printf("Error: Could not open file %s\n", InputFileName);
+    return EXIT_FAILURE;
+  }
+  uint8_t Chunk[65536];
+  size_t NumRead;
+  while ((NumRead = std::fread(Chunk, 1, sizeof(Chunk), InputFile)) > 0) Stream.insert(Stream.end(), Chunk, Chunk + NumRead);
+  std::fclose(InputFile);
+
+  const char* Colon = strrchr(Destination, ':');
+  sockaddr_in Remote;
+  memset(&Remote, 0, sizeof(Remote));
+  Remote.sin_family = AF_INET;
+  if (Colon == nullptr || inet_pton(AF_INET, std::string(Destination, Colon).c_str(), &Remote.sin_addr) != 1 || atoi(Colon + 1) <= 0)
+  {
+    printf("Error: Destination %s is not <IPv4 address>:<port>\n", Destination);
+    return EXIT_FAILURE;
+  }
+  Remote.sin_port = htons(static_cast<uint16_t>(atoi(Colon + 1)));
+
+  const int Socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if (Socket < 0)
+  {
+    printf("Error: Could not create socket\n");
+    return EXIT_FAILURE;
+  }
+  setsockopt(Socket, IPPROTO_IP, IP_MULTICAST_TTL, &TTL, sizeof(TTL));
+
+  uint8_t  Datagram[RTP_HeaderLength + DatagramPayload];
+  uint16_t Sequence = 0;
+  const uint32_t SSRC = static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+  uint64_t NumSent = 0, NumDropped = 0, NumBytes = 0, Index = 0;
+  const auto StartTime = std::chrono::steady_clock::now();
+
+  for (uint32_t Loop = 0; Loop < NumLoops; Loop++) {
+    for (size_t Offset = 0; Offset < Stream.size(); Offset += DatagramPayload, Index++) {
+      const size_t PayloadLength = std::min(DatagramPayload, Stream.size() - Offset);
+
+      // Pacing - wait until the bytes sent so far are due at the requested rate
+      if (Rate > 0) {
+        std::this_thread::sleep_until(StartTime + std::chrono::duration<double>(NumBytes * 8 / (Rate * 1e6)));
+      }
+      NumBytes += PayloadLength;
+
+      size_t HeaderLength = 0;
+      if (RTP) {
+        const uint32_t Timestamp = static_cast<uint32_t>(std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count() * 90000);
+        Datagram[0]  = 0x80;                 // version 2, no padding, extension or CSRCs
+        Datagram[1]  = RTP_PayloadTypeMP2T;
+        Datagram[2]  = static_cast<uint8_t>(Sequence >> 8);
+        Datagram[3]  = static_cast<uint8_t>(Sequence);
+        Datagram[4]  = static_cast<uint8_t>(Timestamp >> 24);
+        Datagram[5]  = static_cast<uint8_t>(Timestamp >> 16);
+        Datagram[6]  = static_cast<uint8_t>(Timestamp >> 8);
+        Datagram[7]  = static_cast<uint8_t>(Timestamp);
+        Datagram[8]  = static_cast<uint8_t>(SSRC >> 24);
+        Datagram[9]  = static_cast<uint8_t>(SSRC >> 16);
+        Datagram[10] = static_cast<uint8_t>(SSRC >> 8);
+        Datagram[11] = static_cast<uint8_t>(SSRC);
+        HeaderLength = RTP_HeaderLength;
+      }
+      Sequence++;
+
+      if (DropEvery && (Index + 1) % DropEvery == 0) { NumDropped++; continue; }
+      memcpy(Datagram + HeaderLength, Stream.data() + Offset, PayloadLength);
+      if (sendto(Socket, Datagram, HeaderLength + PayloadLength, 0, reinterpret_cast<const sockaddr*>(&Remote), sizeof(Remote)) < 0)
+      {
+        printf("Error: Could not send to %s\n", Destination);
+        close(Socket);
+        return EXIT_FAILURE;
+      }
+      NumSent++;
+    }
+  }
+  close(Socket);
+
+  const double Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count();
+  printf("Sent: datagrams: %" PRIu64 ", skipped: %" PRIu64 ", bytes: %" PRIu64 ", time: %.3f s, rate: %.1f Mbit/s\n",
+         NumSent, NumDropped, NumBytes, Seconds, Seconds > 0 ? NumBytes * 8 / Seconds / 1e6 : 0.0);
+  return EXIT_SUCCESS;
+#else
+  (void)InputFileName; (void)Destination; (void)RTP; (void)Rate; (void)NumLoops; (void)DropEvery; (void)TTL;
+  printf("Error: UDP output is not supported on this platform\n");
+  return EXIT_FAILURE;
+#endif
+}
@@ -0,0 +1,78 @@
+/**
+ * @file pesBufferPool.cpp
+ * @brief Implementation of the size-classed PES buffer pool
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/pesBufferPool.h"
+#include <new>
+
+//=============================================================================================================================================================================
+// xPES_BufferPool Implementation
+//=============================================================================================================================================================================
+
+xPES_BufferPool::~xPES_BufferPool()
+{
+  for(std::vector<uint8_t*>& FreeList : m_FreeLists)
+  {
+    for(uint8_t* Buffer : FreeList) { delete[] Buffer; }
+    FreeList.clear();
+  }
+}
+
+/**
+ * @brief Rounds request up to its size class and pops a free buffer of that class
+ */
+uint8_t* xPES_BufferPool::Acquire(uint32_t MinSize, uint32_t& Capacity)
+{
+  Capacity = getClassSize(MinSize);
+  if(Capacity == 0) Capacity = MinSize; // above all classes - exact size from the heap
+
+  int32_t ClassIdx = xGetClassIdx(Capacity);
+  if(ClassIdx != NOT_VALID && !m_FreeLists[ClassIdx].empty())
+  {
+    uint8_t* Buffer = m_FreeLists[ClassIdx].back();
+    m_FreeLists[ClassIdx].pop_back();
+    m_NumReuses++;
+    return Buffer;
+  }
+
+  uint8_t* Buffer = new (std::nothrow) uint8_t[Capacity];
+  if(Buffer) m_NumAllocations++;
+  return Buffer;
+}
+
+void xPES_BufferPool::Release(uint8_t* Buffer, uint32_t Capacity)
+{
+  if(!Buffer) return;
+  int32_t ClassIdx = xGetClassIdx(Capacity);
+  if(ClassIdx == NOT_VALID) { delete[] Buffer; return; }
+  m_FreeLists[ClassIdx].push_back(Buffer);
+}
+
+uint32_t xPES_BufferPool::getClassSize(uint32_t MinSize)
+{
+  uint32_t ClassSize = MinClassSize;
+  for(uint32_t ClassIdx = 0; ClassIdx < NumClasses; ClassIdx++, ClassSize <<= 1)
+  {
+    if(ClassSize >= MinSize) return ClassSize;
+  }
+  return 0;
+}
+
+/**
+ * @brief Maps an exact class capacity to its free list index
+ * @return Class index, NOT_VALID for capacities which are not a class size
+ */
+int32_t xPES_BufferPool::xGetClassIdx(uint32_t Capacity)
+{
+  uint32_t ClassSize = MinClassSize;
+  for(int32_t ClassIdx = 0; ClassIdx < (int32_t)NumClasses; ClassIdx++, ClassSize <<= 1)
+  {
+    if(ClassSize == Capacity) return ClassIdx;
+  }
+  return NOT_VALID;
+}
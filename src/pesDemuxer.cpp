@@ -0,0 +1,141 @@
+/**
+ * @file pesDemuxer.cpp
+ * @brief Implementation of multi-PID PES assembly
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/pesDemuxer.h"
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xPES_Demuxer Implementation
+//=============================================================================================================================================================================
+
+xPES_Demuxer::xPES_Demuxer()
+  : m_BufferPool(nullptr)
+  , m_ZeroCopy(false)
+  , m_AutoAdd(false)
+  , m_NumUnits(0)
+{
+  memset(m_SlotIdx, 0, sizeof(m_SlotIdx));
+}
+
+/**
+ * @brief Releases all assemblers and clears the PID table
+ */
+void xPES_Demuxer::Reset()
+{
+  memset(m_SlotIdx, 0, sizeof(m_SlotIdx));
+  m_Entries.clear();
+  m_NumUnits = 0;
+}
+
+/**
+ * @brief Creates assembler for a PID (no-op if already active)
+ */
+bool xPES_Demuxer::AddPID(int32_t PID)
+{
+  if(PID < 0 || PID >= (int32_t)NumPIDs) return false;
+  if(m_SlotIdx[PID]) return true;
+
+  std::unique_ptr<xEntry> Entry(new xEntry());
+  Entry->Assembler.setBufferPool(m_BufferPool);
+  Entry->Assembler.setZeroCopy(m_ZeroCopy);
+  Entry->Assembler.Init(PID);
+  Entry->Pending  = false;
+  Entry->NumUnits = 0;
+  m_Entries.push_back(std::move(Entry));
+  m_SlotIdx[PID] = static_cast<uint16_t>(m_Entries.size());
+  return true;
+}
+
+/**
+ * @brief Routes packet to its assembler and reports completed units
+ *
+ * An unbounded unit has no end marker of its own - it is reported when the next
+ * unit starts, before the new payload is absorbed. A bounded unit is reported only once
+ * PES_packet_length bytes were assembled; one cut short by the next unit start is dropped.
+ */
+xPES_Assembler::eResult xPES_Demuxer::AbsorbPacket(const uint8_t* TransportStreamPacket,
+                                                   const xTS_PacketHeader* PacketHeader,
+                                                   const xTS_AdaptationField* AdaptationField,
+                                                   const xBlockRef* Block)
+{
+  const uint16_t PID = PacketHeader->getPID();
+  if(!m_SlotIdx[PID])
+  {
+    if(!m_AutoAdd || PID == (uint16_t)xTS_PacketHeader::ePID::NuLL || !xStartsPES(TransportStreamPacket, PacketHeader, AdaptationField))
+    {
+      return xPES_Assembler::eResult::UnexpectedPID;
+    }
+    AddPID(PID);
+  }
+
+  xEntry& Entry = *m_Entries[m_SlotIdx[PID] - 1];
+  if(Entry.Pending && PacketHeader->getPayloadUnitStartIndicator() && PacketHeader->hasPayload())
+  {
+    xReportUnit(Entry);
+  }
+
+  xPES_Assembler::eResult Result = Entry.Assembler.AbsorbPacket(TransportStreamPacket, PacketHeader, AdaptationField, Block);
+  switch(Result)
+  {
+    case xPES_Assembler::eResult::AssemblingStarted:
+      Entry.Pending = Entry.Assembler.m_PESH.getPacketLength() == 0;
+      break;
+    case xPES_Assembler::eResult::AssemblingFinished:
+      xReportUnit(Entry);
+      break;
+    case xPES_Assembler::eResult::StreamPackedLost:
+    case xPES_Assembler::eResult::UnexpectedPID:
+      Entry.Pending = false;
+      break;
+    default:
+      break;
+  }
+  return Result;
+}
+
+/**
+ * @brief Reports unbounded units still being assembled (incomplete bounded units are dropped)
+ */
+void xPES_Demuxer::Flush()
+{
+  for(std::unique_ptr<xEntry>& Entry : m_Entries)
+  {
+    if(Entry->Pending) xReportUnit(*Entry);
+  }
+}
+
+uint64_t xPES_Demuxer::getNumBufferAllocations() const
+{
+  uint64_t NumAllocations = 0;
+  for(const std::unique_ptr<xEntry>& Entry : m_Entries) { NumAllocations += Entry->Assembler.getNumAllocations(); }
+  return NumAllocations;
+}
+
+void xPES_Demuxer::xReportUnit(xEntry& Entry)
+{
+  Entry.Pending = false;
+  Entry.NumUnits++;
+  m_NumUnits++;
+  if(m_Callback) m_Callback(Entry.Assembler.getPID(), Entry.Assembler);
+}
+
+/**
+ * @brief Checks whether packet starts a PES unit (PUSI set and payload begins with 0x000001)
+ */
+bool xPES_Demuxer::xStartsPES(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField)
+{
+  if(!PacketHeader->getPayloadUnitStartIndicator() || !PacketHeader->hasPayload()) return false;
+
+  uint32_t PayloadOffset = xTS::TS_HeaderLength;
+  if(PacketHeader->hasAdaptationField()) PayloadOffset += AdaptationField->getAdaptationFieldLength() + 1;
+  if(PayloadOffset + 3 > xTS::TS_PacketLength) return false;
+
+  const uint8_t* Payload = TransportStreamPacket + PayloadOffset;
+  return Payload[0] == 0x00 && Payload[1] == 0x00 && Payload[2] == 0x01;
+}
@@ -18,6 +18,8 @@
 #include "../include/pesParse.h"
 #include <cstring>
 #include <cstdio>
+#include <new>
+#include <algorithm>
 
 //=============================================================================================================================================================================
 // xPES_PacketHeader Implementation
@@ -132,7 +134,7 @@ int32_t xPES_PacketHeader::Parse(const uint8_t* Input)
     m_hasHeaderExtension = true;
     
     // Validate minimum packet length for extended header (requires 3+ additional bytes)
-    if (m_PacketLength < 3) return m_headerLength; 
+    if (m_PacketLength != 0 && m_PacketLength < 3) return m_headerLength; // 0: unbounded (video)
     
     // Parse and validate marker bits from first extension byte
     uint8_t markerBits = (Input[6] & 0xC0) >> 6;
@@ -271,9 +273,13 @@ xPES_Assembler::xPES_Assembler()
   , m_Buffer(nullptr)           // Dynamic buffer for PES packet assembly
   , m_BufferSize(0)             // Current allocated buffer size
   , m_DataOffset(0)             // Current write position in buffer
+  , m_BufferPool(nullptr)       // Private heap buffer by default
+  , m_ZeroCopy(false)           // Copy payload into the assembly buffer
+  , m_CurrentBlock(nullptr)     // Block of the packet being absorbed
   , m_LastContinuityCounter(0)  // Last seen continuity counter value
   , m_Started(false)            // Assembly state flag
   , m_TotalStuffingBytes(0)     // Accumulated stuffing bytes count
+  , m_NumAllocations(0)         // Buffer allocation count
 {
 }
 
@@ -284,12 +290,29 @@ xPES_Assembler::xPES_Assembler()
  * Called automatically when assembler object goes out of scope.
  */
 xPES_Assembler::~xPES_Assembler()
+{
+  setBufferPool(nullptr);
+}
+
+/**
+ * @brief Selects buffer source - shared pool or private heap buffer
+ * 
+ * The current buffer is returned to its source; the next packet allocates
+ * from the new one.
+ * 
+ * @param BufferPool Pool to use, nullptr for a private heap buffer
+ */
+void xPES_Assembler::setBufferPool(xPES_BufferPool* BufferPool)
 {
   if (m_Buffer)
   {
-    delete[] m_Buffer;
+    if (m_BufferPool) m_BufferPool->Release(m_Buffer, m_BufferSize);
+    else              delete[] m_Buffer;
     m_Buffer = nullptr;
   }
+  m_BufferSize = 0;
+  m_DataOffset = 0;
+  m_BufferPool = BufferPool;
 }
 
 /**
@@ -348,8 +371,11 @@ void xPES_Assembler::Init(int32_t PID)
  */
 xPES_Assembler::eResult xPES_Assembler::AbsorbPacket(const uint8_t* TransportStreamPacket, 
                                                      const xTS_PacketHeader* PacketHeader, 
-                                                     const xTS_AdaptationField* AdaptationField)
+                                                     const xTS_AdaptationField* AdaptationField,
+                                                     const xBlockRef* Block)
 {
+  m_CurrentBlock = Block;
+
   // Validate that packet belongs to our target PID
   if (PacketHeader->getPID() != m_PID)
   {
@@ -430,6 +456,12 @@ xPES_Assembler::eResult xPES_Assembler::AbsorbPacket(const uint8_t* TransportStr
       m_Started = false;
       return eResult::UnexpectedPID;
     }
+
+    // Bounded packet - allocate final size up front instead of growing per TS packet
+    if (m_PESH.getPacketLength() > 0 && !m_ZeroCopy)
+    {
+      xBufferReserve(xTS::PES_HeaderLength + m_PESH.getPacketLength());
+    }
     
     // Store complete payload data (including PES header) in assembly buffer
     xBufferAppend(payload, payloadSize);
@@ -472,46 +504,96 @@ xPES_Assembler::eResult xPES_Assembler::AbsorbPacket(const uint8_t* TransportStr
 }
 
 /**
- * @brief Resets internal assembly buffer and deallocates memory
+ * @brief Resets internal assembly buffer for a new PES packet
  * 
- * Clears the internal buffer used for PES packet assembly and resets all
- * buffer management variables to initial state. This prepares the assembler
- * for a new PES packet assembly session.
+ * Only the data offset is cleared. The buffer and its capacity are kept, so
+ * consecutive PES packets of a stream are assembled without heap traffic.
  * 
- * @note Deallocates buffer memory to prevent memory leaks
  * @note Called automatically when starting new PES packet assembly
- * @note Safe to call multiple times - checks for null pointer
+ * @note Safe to call multiple times
  */
 void xPES_Assembler::xBufferReset()
 {
-  // Deallocate existing buffer if present
-  if (m_Buffer)
-  {
-    delete[] m_Buffer;
-    m_Buffer = nullptr;
-  }
-  
-  // Reset buffer management variables
-  m_BufferSize = 0;   // No allocated space
   m_DataOffset = 0;   // No data stored
+
+  // Drop slices of the previous packet (and references to blocks no longer needed)
+  m_Slices.clear();
+  m_SliceBlocks.clear();
 }
 
 /**
- * @brief Appends data to internal assembly buffer with automatic resizing
- * 
- * Dynamically expands the internal buffer as needed to accommodate new data.
- * Uses exponential growth strategy to minimize memory reallocations while
- * assembling large PES packets from multiple TS packet payloads.
+ * @brief Grows internal assembly buffer to hold at least Size bytes
  * 
  * Buffer expansion strategy:
  * 1. Double current buffer size, or
- * 2. Current data + new data size, whichever is larger
+ * 2. Requested size, whichever is larger
  * 3. Minimum buffer size of 1024 bytes for efficiency
  * 
+ * With a buffer pool the new size is rounded up to the pool size class and the
+ * old buffer is returned to the pool.
+ * 
+ * @param Size Required capacity in bytes
+ * @return True if the buffer holds at least Size bytes
+ * 
+ * @note Handles memory allocation failures gracefully with error logging
+ * @note Preserves existing buffer content during expansion
+ */
+bool xPES_Assembler::xBufferReserve(uint32_t Size)
+{
+  if (Size <= m_BufferSize) return true;
+
+  // Calculate new buffer size using exponential growth strategy
+  uint32_t newSize = std::max(m_BufferSize * 2, Size);
+  
+  // Ensure minimum buffer size for efficiency
+  newSize = std::max(newSize, static_cast<uint32_t>(1024));
+
+  uint8_t* newBuffer = nullptr;
+  if (m_BufferPool)
+  {
+    newBuffer = m_BufferPool->Acquire(newSize, newSize);
+  }
+  else
+  {
+    newBuffer = new (std::nothrow) uint8_t[newSize];
+  }
+
+  if (!newBuffer)
+  {
+    printf("Error: Memory allocation failed in xBufferReserve (%u bytes)\n", newSize);
+    return false;
+  }
+  m_NumAllocations++;
+
+  // Copy existing data if present
+  if (m_Buffer && m_DataOffset > 0)
+  {
+    memcpy(newBuffer, m_Buffer, m_DataOffset);
+  }
+
+  // Replace old buffer with new expanded buffer
+  if (m_Buffer)
+  {
+    if (m_BufferPool) m_BufferPool->Release(m_Buffer, m_BufferSize);
+    else              delete[] m_Buffer;
+  }
+
+  m_Buffer = newBuffer;
+  m_BufferSize = newSize;
+  return true;
+}
+
+/**
+ * @brief Appends data to internal assembly buffer with automatic resizing
+ * 
+ * Expands the internal buffer when needed (see xBufferReserve()). Bounded PES
+ * packets are pre-sized when their header is parsed, so growth only happens for
+ * unbounded packets and the first packets of a stream. In zero-copy mode only the
+ * range and a reference to its block are recorded.
+ * 
  * @param Data Pointer to new data to append to buffer
  * @param Size Number of bytes to append from Data
  * 
- * @note Handles memory allocation failures gracefully with error logging
  * @note Preserves existing buffer content during expansion
  * @note Thread-safe within single assembler instance
  * 
@@ -521,44 +603,22 @@ void xPES_Assembler::xBufferAppend(const uint8_t* Data, int32_t Size)
 {
   // Validate input parameters
   if (Size <= 0 || !Data) return;
-  
-  // Check if buffer expansion is needed
-  if (m_DataOffset + Size > m_BufferSize)
+
+  // Zero-copy mode - record payload range and keep its block alive
+  if (m_ZeroCopy)
   {
-    // Calculate new buffer size using exponential growth strategy
-    uint32_t newSize = std::max(m_BufferSize * 2, m_DataOffset + Size);
-    
-    // Ensure minimum buffer size for efficiency
-    newSize = std::max(newSize, static_cast<uint32_t>(1024));
-    
-    uint8_t* newBuffer = nullptr;
-    try {
-      // Allocate new buffer
-      newBuffer = new uint8_t[newSize];
-      
-      // Copy existing data if present
-      if (m_Buffer && m_DataOffset > 0)
-      {
-        memcpy(newBuffer, m_Buffer, m_DataOffset);
-      }
-      
-      // Replace old buffer with new expanded buffer
-      if (m_Buffer)
-      {
-        delete[] m_Buffer;
-      }
-      
-      m_Buffer = newBuffer;
-      m_BufferSize = newSize;
-    }
-    catch (const std::bad_alloc& e) {
-      // Handle memory allocation failure
-      if (newBuffer) delete[] newBuffer;
-      printf("Error: Memory allocation failed in xBufferAppend: %s\n", e.what());
-      return;
+    m_Slices.push_back(xPES_Slice{ Data, static_cast<size_t>(Size) });
+    if (m_CurrentBlock && *m_CurrentBlock && (m_SliceBlocks.empty() || m_SliceBlocks.back() != *m_CurrentBlock))
+    {
+      m_SliceBlocks.push_back(*m_CurrentBlock);
     }
+    m_DataOffset += Size;
+    return;
   }
   
+  // Check if buffer expansion is needed
+  if (!xBufferReserve(m_DataOffset + Size)) return;
+  
   // Append new data to buffer
   memcpy(m_Buffer + m_DataOffset, Data, Size);
   m_DataOffset += Size;
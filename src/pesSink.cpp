@@ -0,0 +1,150 @@
+/**
+ * @file pesSink.cpp
+ * @brief Implementation of elementary stream file output
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/pesSink.h"
+#include <algorithm>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_WRITEV 1
+#include <cerrno>
+#include <climits>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <unistd.h>
+static_assert(sizeof(xPES_Slice) == sizeof(iovec) && offsetof(xPES_Slice, Size) == offsetof(iovec, iov_len),
+              "xPES_Slice must be layout compatible with struct iovec");
+#else
+#define TS_HAS_WRITEV 0
+#endif
+
+//=============================================================================================================================================================================
+// xPES_FileSink Implementation
+//=============================================================================================================================================================================
+
+xPES_FileSink::xPES_FileSink()
+  : m_FileDescriptor(-1)
+  , m_File(nullptr)
+  , m_NumBytes(0)
+  , m_NumPackets(0)
+  , m_NumCalls(0)
+{
+}
+
+xPES_FileSink::~xPES_FileSink()
+{
+  Close();
+}
+
+bool xPES_FileSink::Open(const char* FileName)
+{
+  Close();
+#if TS_HAS_WRITEV
+  m_FileDescriptor = ::open(FileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  return m_FileDescriptor >= 0;
+#else
+  m_File = std::fopen(FileName, "wb");
+  return m_File != nullptr;
+#endif
+}
+
+void xPES_FileSink::Close()
+{
+#if TS_HAS_WRITEV
+  if(m_FileDescriptor >= 0)
+  {
+    ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+  }
+#endif
+  if(m_File)
+  {
+    std::fclose(m_File);
+    m_File = nullptr;
+  }
+}
+
+/**
+ * @brief Writes slice list (zero-copy mode) or assembly buffer (copy mode)
+ */
+bool xPES_FileSink::Write(const xPES_Assembler& Assembler)
+{
+  bool Result;
+  if(Assembler.isZeroCopy())
+  {
+    Result = xWriteSlices(Assembler.getSlices(), Assembler.getNumSlices());
+  }
+  else
+  {
+    const xPES_Slice Whole = { Assembler.getPacket(), static_cast<size_t>(Assembler.getNumPacketBytes()) };
+    Result = xWriteSlices(&Whole, Whole.Size ? 1 : 0);
+  }
+  if(Result) m_NumPackets++;
+  return Result;
+}
+
+/**
+ * @brief Writes all slices, resuming after partial writes
+ *
+ * writev() accepts at most IOV_MAX entries per call; longer lists are written in
+ * several calls.
+ */
+bool xPES_FileSink::xWriteSlices(const xPES_Slice* Slices, uint32_t NumSlices)
+{
+#if TS_HAS_WRITEV
+  if(m_FileDescriptor < 0) return false;
+
+  // Slices are const - a partially written entry is resumed through a local copy
+  xPES_Slice Partial     = { nullptr, 0 };
+  bool       UsePartial  = false;
+  uint32_t   SliceIdx    = 0;
+  while(SliceIdx < NumSlices)
+  {
+    const xPES_Slice* Batch    = UsePartial ? &Partial : Slices + SliceIdx;
+    const int         NumBatch = UsePartial ? 1 : static_cast<int>(std::min<uint32_t>(NumSlices - SliceIdx, IOV_MAX));
+
+    ssize_t Written = ::writev(m_FileDescriptor, reinterpret_cast<const iovec*>(Batch), NumBatch);
+    m_NumCalls++;
+    if(Written < 0)
+    {
+      if(errno == EINTR) continue;
+      return false;
+    }
+    if(Written == 0) return false;
+    m_NumBytes += static_cast<uint64_t>(Written);
+
+    // Advance over fully written slices
+    size_t Remaining = static_cast<size_t>(Written);
+    for(int Idx = 0; Idx < NumBatch; Idx++)
+    {
+      const size_t Size = Batch[Idx].Size;
+      if(Remaining < Size)
+      {
+        Partial    = xPES_Slice{ Batch[Idx].Data + Remaining, Size - Remaining };
+        UsePartial = true;
+        break;
+      }
+      Remaining -= Size;
+      if(UsePartial) UsePartial = false;
+      SliceIdx++;
+    }
+  }
+  return true;
+#else
+  if(m_File == nullptr) return false;
+  for(uint32_t SliceIdx = 0; SliceIdx < NumSlices; SliceIdx++)
+  {
+    size_t Written = std::fwrite(Slices[SliceIdx].Data, 1, Slices[SliceIdx].Size, m_File);
+    m_NumCalls++;
+    m_NumBytes += Written;
+    if(Written != Slices[SliceIdx].Size) return false;
+  }
+  return true;
+#endif
+}
@@ -0,0 +1,385 @@
+/**
+ * @file psiParse.cpp
+ * @brief Implementation of PSI section assembly and PAT/PMT parsing
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/psiParse.h"
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xPSI_SectionHeader Implementation
+//=============================================================================================================================================================================
+
+void xPSI_SectionHeader::Reset()
+{
+  m_TableId                = 0;
+  m_SectionSyntaxIndicator = 0;
+  m_SectionLength          = 0;
+  m_TableIdExtension       = 0;
+  m_VersionNumber          = 0;
+  m_CurrentNextIndicator   = 0;
+  m_SectionNumber          = 0;
+  m_LastSectionNumber      = 0;
+}
+
+int32_t xPSI_SectionHeader::Parse(const uint8_t* Section, uint32_t Size)
+{
+  Reset();
+  if(Size < PrefixLength) return NOT_VALID;
+
+  m_TableId                = Section[0];
+  m_SectionSyntaxIndicator = (Section[1] >> 7) & 0x01;
+  m_SectionLength          = ((Section[1] & 0x0F) << 8) | Section[2];
+  if(!m_SectionSyntaxIndicator) return PrefixLength;
+
+  if(Size < HeaderLength) return NOT_VALID;
+  m_TableIdExtension       = (Section[3] << 8) | Section[4];
+  m_VersionNumber          = (Section[5] >> 1) & 0x1F;
+  m_CurrentNextIndicator   = Section[5] & 0x01;
+  m_SectionNumber          = Section[6];
+  m_LastSectionNumber      = Section[7];
+  return HeaderLength;
+}
+
+//=============================================================================================================================================================================
+// xPSI_SectionAssembler Implementation
+//=============================================================================================================================================================================
+
+xPSI_SectionAssembler::xPSI_SectionAssembler()
+  : m_PID(NOT_VALID)
+  , m_SectionSize(0)
+  , m_NumReceived(0)
+  , m_Started(false)
+  , m_Skip(false)
+  , m_LastCC(NOT_VALID)
+  , m_NumSections(0)
+  , m_NumCRCErrors(0)
+  , m_NumSkipped(0)
+  , m_NumDropped(0)
+{
+}
+
+void xPSI_SectionAssembler::Init(int32_t PID)
+{
+  m_PID    = PID;
+  m_LastCC = NOT_VALID;
+  m_Started = false;
+  m_HeaderCache.clear();
+  m_Section.reserve(1024);
+}
+
+/**
+ * @brief Splits the payload at pointer_field - bytes before it complete the pending section, new sections start after it
+ */
+void xPSI_SectionAssembler::AbsorbPacket(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField)
+{
+  if(!PacketHeader->hasPayload()) return;
+  if(PacketHeader->getTransportErrorIndicator()) { xAbort(); return; }
+
+  // Continuity check - a duplicated packet is ignored, a lost one invalidates the pending section
+  const int8_t CC = static_cast<int8_t>(PacketHeader->getContinuityCounter());
+  if(m_LastCC != NOT_VALID)
+  {
+    if(CC == m_LastCC) return;
+    if(CC != ((m_LastCC + 1) & 0x0F)) xAbort();
+  }
+  m_LastCC = CC;
+
+  uint32_t PayloadOffset = xTS::TS_HeaderLength;
+  if(PacketHeader->hasAdaptationField()) PayloadOffset += AdaptationField->getAdaptationFieldLength() + 1;
+  if(PayloadOffset >= xTS::TS_PacketLength) return;
+
+  const uint8_t* Payload = TransportStreamPacket + PayloadOffset;
+  uint32_t       Size    = xTS::TS_PacketLength - PayloadOffset;
+
+  if(!PacketHeader->getPayloadUnitStartIndicator())
+  {
+    xFeed(Payload, Size, false);
+    return;
+  }
+
+  const uint32_t PointerField = Payload[0];
+  Payload++;
+  Size--;
+  if(PointerField > Size) { xAbort(); return; }
+
+  xFeed(Payload, PointerField, false);
+  if(m_Started) xAbort(); // pending section longer than announced by pointer_field
+  xFeed(Payload + PointerField, Size - PointerField, true);
+}
+
+void xPSI_SectionAssembler::xAbort()
+{
+  if(m_Started) m_NumDropped++;
+  m_Started = false;
+}
+
+/**
+ * @brief Collects section bytes in three steps: length field, header (cache compare), rest of the section
+ */
+void xPSI_SectionAssembler::xFeed(const uint8_t* Data, uint32_t Size, bool CanStart)
+{
+  while(Size > 0)
+  {
+    if(!m_Started)
+    {
+      if(!CanStart || Data[0] == (uint8_t)xPSI_SectionHeader::eTableId::Stuffing) return;
+      m_Started     = true;
+      m_Skip        = false;
+      m_SectionSize = 0;
+      m_NumReceived = 0;
+      m_Section.clear();
+    }
+
+    const uint32_t Target = m_SectionSize == 0                         ? xPSI_SectionHeader::PrefixLength
+                          : m_NumReceived < xPSI_SectionHeader::HeaderLength ? std::min(xPSI_SectionHeader::HeaderLength, m_SectionSize)
+                          : m_SectionSize;
+    const uint32_t Take   = std::min(Size, Target - m_NumReceived);
+    if(!m_Skip) m_Section.insert(m_Section.end(), Data, Data + Take);
+    m_NumReceived += Take;
+    Data          += Take;
+    Size          -= Take;
+    if(m_NumReceived < Target) return; // section continues in the next packet
+
+    if(m_SectionSize == 0)
+    {
+      const uint32_t SectionLength = ((m_Section[1] & 0x0F) << 8) | m_Section[2];
+      if(SectionLength > xPSI_SectionHeader::MaxSectionLength) { xAbort(); return; }
+      m_SectionSize = xPSI_SectionHeader::PrefixLength + SectionLength;
+    }
+    else if(m_NumReceived == m_SectionSize)
+    {
+      xComplete();
+    }
+    else if(m_NumReceived == xPSI_SectionHeader::HeaderLength && (m_Section[1] & 0x80))
+    {
+      m_Skip = xIsCached();
+    }
+  }
+}
+
+void xPSI_SectionAssembler::xComplete()
+{
+  m_Started = false;
+  if(m_Skip) { m_NumSkipped++; return; }
+
+  const bool LongForm = (m_Section[1] & 0x80) != 0;
+  if(LongForm && !m_CRC32.Verify(m_Section.data(), m_SectionSize)) { m_NumCRCErrors++; return; }
+
+  m_NumSections++;
+  const bool Accepted = m_Callback ? m_Callback(m_PID, m_Section.data(), m_SectionSize) : true;
+  if(Accepted && LongForm && m_SectionSize >= xPSI_SectionHeader::HeaderLength) xCacheHeader();
+}
+
+/**
+ * @brief Compares the 8 raw header bytes of the current section with the cached headers
+ */
+bool xPSI_SectionAssembler::xIsCached() const
+{
+  uint64_t Header;
+  memcpy(&Header, m_Section.data(), sizeof(Header));
+  return std::find(m_HeaderCache.begin(), m_HeaderCache.end(), Header) != m_HeaderCache.end();
+}
+
+/**
+ * @brief Stores header of an accepted section, replacing the entry of the same table_id/table_id_extension/section_number
+ */
+void xPSI_SectionAssembler::xCacheHeader()
+{
+  uint64_t Header;
+  memcpy(&Header, m_Section.data(), sizeof(Header));
+
+  // Key bytes: table_id (0), table_id_extension (3-4), section_number (6)
+  uint64_t KeyMask = 0;
+  const uint8_t KeyBytes[] = { 0xFF, 0x00, 0x00, 0xFF, 0xFF, 0x00, 0xFF, 0x00 };
+  memcpy(&KeyMask, KeyBytes, sizeof(KeyMask));
+
+  for(uint64_t& Cached : m_HeaderCache)
+  {
+    if((Cached & KeyMask) == (Header & KeyMask)) { Cached = Header; return; }
+  }
+  m_HeaderCache.push_back(Header);
+}
+
+//=============================================================================================================================================================================
+// xPSI_PAT / xPSI_PMT Implementation
+//=============================================================================================================================================================================
+
+int32_t xPSI_PAT::Parse(const uint8_t* Section, uint32_t Size)
+{
+  m_Programs.clear();
+  if(m_Header.Parse(Section, Size) != (int32_t)xPSI_SectionHeader::HeaderLength) return NOT_VALID;
+  if(m_Header.getTableId() != (uint8_t)xPSI_SectionHeader::eTableId::PAT) return NOT_VALID;
+
+  const uint32_t SectionSize = m_Header.getSectionSize();
+  if(SectionSize > Size || SectionSize < xPSI_SectionHeader::HeaderLength + xPSI_SectionHeader::CRC_Length) return NOT_VALID;
+
+  const uint32_t End = SectionSize - xPSI_SectionHeader::CRC_Length;
+  for(uint32_t Offset = xPSI_SectionHeader::HeaderLength; Offset + 4 <= End; Offset += 4)
+  {
+    xProgram Program;
+    Program.ProgramNumber = (Section[Offset] << 8) | Section[Offset + 1];
+    Program.PID           = ((Section[Offset + 2] & 0x1F) << 8) | Section[Offset + 3];
+    m_Programs.push_back(Program);
+  }
+  return static_cast<int32_t>(m_Programs.size());
+}
+
+int32_t xPSI_PMT::Parse(const uint8_t* Section, uint32_t Size)
+{
+  m_Streams.clear();
+  m_PCR_PID = (uint16_t)xTS_PacketHeader::ePID::NuLL;
+  if(m_Header.Parse(Section, Size) != (int32_t)xPSI_SectionHeader::HeaderLength) return NOT_VALID;
+  if(m_Header.getTableId() != (uint8_t)xPSI_SectionHeader::eTableId::PMT) return NOT_VALID;
+
+  const uint32_t SectionSize = m_Header.getSectionSize();
+  if(SectionSize > Size || SectionSize < xPSI_SectionHeader::HeaderLength + 4 + xPSI_SectionHeader::CRC_Length) return NOT_VALID;
+
+  const uint32_t End = SectionSize - xPSI_SectionHeader::CRC_Length;
+  m_PCR_PID = ((Section[8] & 0x1F) << 8) | Section[9];
+  const uint32_t ProgramInfoLength = ((Section[10] & 0x0F) << 8) | Section[11];
+
+  uint32_t Offset = xPSI_SectionHeader::HeaderLength + 4 + ProgramInfoLength;
+  while(Offset + 5 <= End)
+  {
+    xStream Stream;
+    Stream.StreamType = Section[Offset];
+    Stream.PID        = ((Section[Offset + 1] & 0x1F) << 8) | Section[Offset + 2];
+    const uint32_t ES_InfoLength = ((Section[Offset + 3] & 0x0F) << 8) | Section[Offset + 4];
+    m_Streams.push_back(Stream);
+    Offset += 5 + ES_InfoLength;
+  }
+  if(Offset != End) return NOT_VALID;
+  return static_cast<int32_t>(m_Streams.size());
+}
+
+bool xPSI_PMT::isPES(uint8_t StreamType)
+{
+  return StreamType != 0x05 && (StreamType < 0x0A || StreamType > 0x0D);
+}
+
+const char* xPSI_PMT::getStreamTypeName(uint8_t StreamType)
+{
+  switch(StreamType)
+  {
+    case 0x01: return "MPEG-1 Video";
+    case 0x02: return "MPEG-2 Video";
+    case 0x03: return "MPEG-1 Audio";
+    case 0x04: return "MPEG-2 Audio";
+    case 0x05: return "Private Sections";
+    case 0x06: return "Private PES";
+    case 0x0F: return "AAC ADTS";
+    case 0x11: return "AAC LATM";
+    case 0x15: return "Metadata PES";
+    case 0x1B: return "H.264";
+    case 0x24: return "HEVC";
+    case 0x81: return "AC-3";
+    case 0x87: return "E-AC-3";
+    default:   return "Unknown";
+  }
+}
+
+//=============================================================================================================================================================================
+// xPSI_ProgramTracker Implementation
+//=============================================================================================================================================================================
+
+xPSI_ProgramTracker::xPSI_ProgramTracker()
+{
+  Reset();
+}
+
+void xPSI_ProgramTracker::Reset()
+{
+  memset(m_SlotIdx, 0, sizeof(m_SlotIdx));
+  m_Assemblers.clear();
+  m_PMTs.clear();
+  m_NumInvalid = 0;
+  xAddPID((int32_t)xTS_PacketHeader::ePID::PAT);
+}
+
+void xPSI_ProgramTracker::AbsorbPacket(const uint8_t* TransportStreamPacket, const xTS_PacketHeader* PacketHeader, const xTS_AdaptationField* AdaptationField)
+{
+  const uint16_t PID = PacketHeader->getPID();
+  if(!m_SlotIdx[PID]) return;
+  m_Assemblers[m_SlotIdx[PID] - 1]->AbsorbPacket(TransportStreamPacket, PacketHeader, AdaptationField);
+}
+
+uint32_t xPSI_ProgramTracker::getNumStreams() const
+{
+  uint32_t NumStreams = 0;
+  for(const xPSI_PMT& PMT : m_PMTs) { NumStreams += static_cast<uint32_t>(PMT.getStreams().size()); }
+  return NumStreams;
+}
+
+uint64_t xPSI_ProgramTracker::getNumSections() const
+{
+  uint64_t NumSections = 0;
+  for(const std::unique_ptr<xPSI_SectionAssembler>& Assembler : m_Assemblers) { NumSections += Assembler->getNumSections(); }
+  return NumSections;
+}
+
+uint64_t xPSI_ProgramTracker::getNumSkipped() const
+{
+  uint64_t NumSkipped = 0;
+  for(const std::unique_ptr<xPSI_SectionAssembler>& Assembler : m_Assemblers) { NumSkipped += Assembler->getNumSkipped(); }
+  return NumSkipped;
+}
+
+uint64_t xPSI_ProgramTracker::getNumCRCErrors() const
+{
+  uint64_t NumCRCErrors = 0;
+  for(const std::unique_ptr<xPSI_SectionAssembler>& Assembler : m_Assemblers) { NumCRCErrors += Assembler->getNumCRCErrors(); }
+  return NumCRCErrors;
+}
+
+void xPSI_ProgramTracker::xAddPID(int32_t PID)
+{
+  if(PID < 0 || PID >= (int32_t)NumPIDs || m_SlotIdx[PID]) return;
+
+  std::unique_ptr<xPSI_SectionAssembler> Assembler(new xPSI_SectionAssembler());
+  Assembler->Init(PID);
+  Assembler->setCallback([this](int32_t SectionPID, const uint8_t* Section, uint32_t Size) { return xOnSection(SectionPID, Section, Size); });
+  m_Assemblers.push_back(std::move(Assembler));
+  m_SlotIdx[PID] = static_cast<uint16_t>(m_Assemblers.size());
+}
+
+/**
+ * @brief Parses a new or changed section - PAT activates PMT PIDs, PMT replaces the stored program description
+ * @return True if the section may be cached (skipped while it repeats unchanged)
+ */
+bool xPSI_ProgramTracker::xOnSection(int32_t PID, const uint8_t* Section, uint32_t Size)
+{
+  const uint8_t TableId = Section[0];
+
+  if(PID == (int32_t)xTS_PacketHeader::ePID::PAT && TableId == (uint8_t)xPSI_SectionHeader::eTableId::PAT)
+  {
+    if(m_PAT.Parse(Section, Size) == NOT_VALID) { m_NumInvalid++; return false; }
+    if(!m_PAT.getHeader().getCurrentNextIndicator()) return true; // not applicable yet
+    for(const xPSI_PAT::xProgram& Program : m_PAT.getPrograms())
+    {
+      if(Program.ProgramNumber != 0) xAddPID(Program.PID);
+    }
+    if(m_PATCallback) m_PATCallback(m_PAT);
+    return true;
+  }
+
+  if(PID != (int32_t)xTS_PacketHeader::ePID::PAT && TableId == (uint8_t)xPSI_SectionHeader::eTableId::PMT)
+  {
+    if(m_PMT.Parse(Section, Size) == NOT_VALID) { m_NumInvalid++; return false; }
+    if(!m_PMT.getHeader().getCurrentNextIndicator()) return true;
+
+    std::vector<xPSI_PMT>::iterator Known = std::find_if(m_PMTs.begin(), m_PMTs.end(),
+      [this](const xPSI_PMT& PMT) { return PMT.getProgramNumber() == m_PMT.getProgramNumber(); });
+    if(Known != m_PMTs.end()) *Known = m_PMT;
+    else                      m_PMTs.push_back(m_PMT);
+    if(m_PMTCallback) m_PMTCallback(PID, m_PMT);
+    return true;
+  }
+
+  return false; // other tables sharing a PSI PID are not interpreted (and not cached)
+}
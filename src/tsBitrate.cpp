@@ -0,0 +1,168 @@
+/**
+ * @file tsBitrate.cpp
+ * @brief Implementation of the windowed bitrate measurement
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsBitrate.h"
+#include "../include/tsTimeIndex.h"
+#include <cinttypes>
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xTS_BitrateMeter Implementation
+//=============================================================================================================================================================================
+
+namespace
+{
+  constexpr uint64_t TicksPerMs = xTS_TimeIndex::ClockRate / 1000;
+}
+
+xTS_BitrateMeter::xTS_BitrateMeter()
+  : m_File(nullptr)
+  , m_Window(0)
+  , m_Levels(NumLevels)
+{
+  for(xLevel& Level : m_Levels) Level.Ring.resize(RingSize);
+  Open(nullptr);
+}
+
+xTS_BitrateMeter::~xTS_BitrateMeter()
+{
+  Close();
+}
+
+bool xTS_BitrateMeter::Open(const char* FileName, uint32_t Window)
+{
+  Close();
+  if(FileName != nullptr)
+  {
+    m_File = std::fopen(FileName, "w");
+    if(m_File == nullptr) return false;
+  }
+
+  m_Window        = (Window ? Window : DefaultWindow) * TicksPerMs;
+  m_RefPID        = NOT_VALID;
+  m_RefPCR        = 0;
+  m_Now           = 0;
+  m_NumDropped    = 0;
+  m_TotalDuration = 0;
+  memset(m_Total, 0, sizeof(m_Total));
+  for(xLevel& Level : m_Levels)
+  {
+    memset(Level.Counts, 0, sizeof(Level.Counts));
+    Level.Start      = 0;
+    Level.Duration   = 0;
+    Level.NumParts   = 0;
+    Level.NumWindows = 0;
+    Level.Total      = xTS_RunningStats();
+  }
+
+  if(m_File == nullptr) return true;
+  std::fprintf(m_File, "# Bitrate [bit/s] per window (window: nominal length [ms], time: window start [s] since the first PCR)\n"
+                       "# window time duration total PID:bitrate...\n");
+  return true;
+}
+
+bool xTS_BitrateMeter::Close()
+{
+  if(m_File == nullptr) return true;
+  bool Written = std::ferror(m_File) == 0;
+  Written = std::fclose(m_File) == 0 && Written;
+  m_File  = nullptr;
+  return Written;
+}
+
+uint64_t xTS_BitrateMeter::getWindowLength(uint32_t Level) const
+{
+  uint64_t Length = m_Window / TicksPerMs;
+  for(uint32_t Idx = 0; Idx < Level; Idx++) Length *= LevelFactor;
+  return Length;
+}
+
+const xTS_BitrateMeter::xWindow& xTS_BitrateMeter::getWindow(uint32_t Level, uint32_t Age) const
+{
+  const xLevel& L = m_Levels[Level];
+  return L.Ring[(L.NumWindows - 1 - Age) % RingSize];
+}
+
+double xTS_BitrateMeter::getMeanBitrate(uint16_t PID) const
+{
+  return m_TotalDuration ? static_cast<double>(m_Total[PID]) * 188 * 8 * 27e6 / static_cast<double>(m_TotalDuration) : 0;
+}
+
+void xTS_BitrateMeter::xAddPCR(const xTS_PacketRecord& Record)
+{
+  const uint64_t PCR = Record.getPCR();
+  xLevel& Shortest = m_Levels[0];
+
+  // First PCR - packets before it have no time base
+  if(m_RefPID == NOT_VALID)
+  {
+    m_RefPID = Record.PID;
+    m_RefPCR = PCR;
+    memset(Shortest.Counts, 0, sizeof(Shortest.Counts));
+    return;
+  }
+
+  const uint64_t Delta = (PCR + xTS_TimeIndex::PCR_Range - m_RefPCR) % xTS_TimeIndex::PCR_Range;
+  m_RefPCR = PCR;
+  if((Record.AF_Flags & 0x80) || Delta > MaxPCRGap * TicksPerMs)
+  {
+    // The window in progress has no valid duration - restart it at this PCR
+    m_NumDropped++;
+    memset(Shortest.Counts, 0, sizeof(Shortest.Counts));
+    Shortest.Start = m_Now;
+    return;
+  }
+
+  m_Now += Delta;
+  if(m_Now - Shortest.Start >= m_Window)
+  {
+    Shortest.Duration = m_Now - Shortest.Start;
+    xCloseWindow(0);
+  }
+}
+
+void xTS_BitrateMeter::xCloseWindow(uint32_t LevelIdx)
+{
+  xLevel&  Level  = m_Levels[LevelIdx];
+  xLevel*  Next   = LevelIdx + 1 < NumLevels ? &m_Levels[LevelIdx + 1] : nullptr;
+  xWindow& Window = Level.Ring[Level.NumWindows++ % RingSize];
+  Window.Start      = Level.Start;
+  Window.Duration   = Level.Duration;
+  Window.NumPackets = 0;
+  Window.PIDs.clear();
+  for(uint32_t PID = 0; PID < NumPIDs; PID++)
+  {
+    const uint32_t Count = Level.Counts[PID];
+    if(Count == 0) continue;
+    Window.PIDs.emplace_back(static_cast<uint16_t>(PID), Count);
+    Window.NumPackets += Count;
+    if(Next)          Next->Counts[PID] += Count;
+    if(LevelIdx == 0) m_Total[PID]      += Count;
+    Level.Counts[PID] = 0;
+  }
+  if(LevelIdx == 0) m_TotalDuration += Window.Duration;
+  Level.Total.Add(Window.getBitrate());
+
+  if(m_File != nullptr)
+  {
+    std::fprintf(m_File, "%" PRIu64 " %.3f %.3f %.0f", getWindowLength(LevelIdx), static_cast<double>(Window.Start) / xTS_TimeIndex::ClockRate,
+                 static_cast<double>(Window.Duration) / TicksPerMs, Window.getBitrate());
+    for(const auto& PID : Window.PIDs) std::fprintf(m_File, " %u:%.0f", PID.first, Window.getBitrate(PID.second));
+    std::fprintf(m_File, "\n");
+  }
+
+  Level.Start    = Window.Start + Window.Duration;
+  Level.Duration = 0;
+  if(Next == nullptr) return;
+  if(Next->NumParts++ == 0) Next->Start = Window.Start; // dropped windows leave gaps
+  Next->Duration += Window.Duration;
+  if(Next->Duration < getWindowLength(LevelIdx + 1) * TicksPerMs) return;
+  Next->NumParts = 0;
+  xCloseWindow(LevelIdx + 1);
+}
@@ -0,0 +1,225 @@
+/**
+ * @file tsCRC32.cpp
+ * @brief Implementation of CRC32/MPEG-2 kernels
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsCRC32.h"
+#include <cstring>
+
+//=============================================================================================================================================================================
+// Tables and folding constants
+//=============================================================================================================================================================================
+
+namespace {
+
+/**
+ * @brief Slicing tables - Table[0] is the classic bytewise table, Table[k][b] is the CRC of byte b followed by k zero bytes
+ */
+struct xCRC32_Tables
+{
+  uint32_t Table[8][256];
+
+  xCRC32_Tables()
+  {
+    for(uint32_t Byte = 0; Byte < 256; Byte++)
+    {
+      uint32_t CRC = Byte << 24;
+      for(int32_t Bit = 0; Bit < 8; Bit++) { CRC = (CRC & 0x80000000) ? (CRC << 1) ^ xTS_CRC32::Polynomial : (CRC << 1); }
+      Table[0][Byte] = CRC;
+    }
+    for(uint32_t Slice = 1; Slice < 8; Slice++)
+    {
+      for(uint32_t Byte = 0; Byte < 256; Byte++)
+      {
+        const uint32_t Prev = Table[Slice - 1][Byte];
+        Table[Slice][Byte] = (Prev << 8) ^ Table[0][Prev >> 24];
+      }
+    }
+  }
+};
+
+static const xCRC32_Tables& xGetTables()
+{
+  static const xCRC32_Tables Tables;
+  return Tables;
+}
+
+/**
+ * @brief Computes x^Exponent mod P (degree < 32)
+ */
+static uint64_t xPowerModP(uint32_t Exponent)
+{
+  uint64_t Remainder = 1;
+  for(uint32_t Idx = 0; Idx < Exponent; Idx++)
+  {
+    Remainder <<= 1;
+    if(Remainder & 0x100000000ULL) Remainder ^= 0x100000000ULL | xTS_CRC32::Polynomial;
+  }
+  return Remainder;
+}
+
+} //namespace
+
+//=============================================================================================================================================================================
+// xTS_CRC32 Implementation
+//=============================================================================================================================================================================
+
+xTS_CRC32::xTS_CRC32(eKernel Kernel)
+  : m_Kernel(Kernel)
+{
+  if(m_Kernel == eKernel::Auto)
+  {
+    m_Kernel = xCpuHasPCLMUL() ? eKernel::PCLMUL : eKernel::Slicing8;
+  }
+  else if(m_Kernel == eKernel::PCLMUL && !xCpuHasPCLMUL())
+  {
+    m_Kernel = eKernel::Slicing8;
+  }
+  xGetTables(); // build tables outside of the first measured call
+}
+
+uint32_t xTS_CRC32::Calculate(const uint8_t* Data, size_t Size, uint32_t CRC) const
+{
+  switch(m_Kernel)
+  {
+    case eKernel::PCLMUL:   return CalculatePCLMUL  (Data, Size, CRC);
+    case eKernel::Bytewise: return CalculateBytewise(Data, Size, CRC);
+    default:                return CalculateSlicing8(Data, Size, CRC);
+  }
+}
+
+const char* xTS_CRC32::getKernelName() const
+{
+  switch(m_Kernel)
+  {
+    case eKernel::PCLMUL:   return "PCLMUL";
+    case eKernel::Bytewise: return "bytewise";
+    default:                return "slicing-by-8";
+  }
+}
+
+uint32_t xTS_CRC32::CalculateBytewise(const uint8_t* Data, size_t Size, uint32_t CRC)
+{
+  const uint32_t* Table = xGetTables().Table[0];
+  for(size_t Idx = 0; Idx < Size; Idx++) { CRC = (CRC << 8) ^ Table[(CRC >> 24) ^ Data[Idx]]; }
+  return CRC;
+}
+
+/**
+ * @brief Eight independent lookups per 8 input bytes - the first four are combined with the CRC register
+ */
+uint32_t xTS_CRC32::CalculateSlicing8(const uint8_t* Data, size_t Size, uint32_t CRC)
+{
+  const xCRC32_Tables& T = xGetTables();
+  while(Size >= 8)
+  {
+    const uint32_t Word = CRC ^ ((uint32_t)Data[0] << 24 | (uint32_t)Data[1] << 16 | (uint32_t)Data[2] << 8 | Data[3]);
+    CRC = T.Table[7][Word >> 24] ^ T.Table[6][(Word >> 16) & 0xFF] ^ T.Table[5][(Word >> 8) & 0xFF] ^ T.Table[4][Word & 0xFF] ^
+          T.Table[3][Data[4]]    ^ T.Table[2][Data[5]]             ^ T.Table[1][Data[6]]            ^ T.Table[0][Data[7]];
+    Data += 8;
+    Size -= 8;
+  }
+  return CalculateBytewise(Data, Size, CRC);
+}
+
+#if X_ARCH_X86
+
+/**
+ * @brief Folding constants - fold distance D bits: low qword x^D mod P, high qword x^(D+64) mod P
+ */
+struct xCRC32_FoldConstants
+{
+  __m128i Fold128;
+  __m128i Fold256;
+  __m128i Fold384;
+  __m128i Fold512;
+
+  xCRC32_FoldConstants()
+  {
+    Fold128 = _mm_set_epi64x((long long)xPowerModP(128 + 64), (long long)xPowerModP(128));
+    Fold256 = _mm_set_epi64x((long long)xPowerModP(256 + 64), (long long)xPowerModP(256));
+    Fold384 = _mm_set_epi64x((long long)xPowerModP(384 + 64), (long long)xPowerModP(384));
+    Fold512 = _mm_set_epi64x((long long)xPowerModP(512 + 64), (long long)xPowerModP(512));
+  }
+};
+
+/** @brief Multiplies a 128-bit polynomial by x^D and reduces it to at most 96 bits (congruent mod P) */
+X_ATTR_TARGET("pclmul,ssse3")
+static inline __m128i xFold(__m128i Value, __m128i Constants)
+{
+  return _mm_xor_si128(_mm_clmulepi64_si128(Value, Constants, 0x00), _mm_clmulepi64_si128(Value, Constants, 0x11));
+}
+
+/** @brief Loads 16 bytes as a polynomial - first byte holds the highest coefficients */
+X_ATTR_TARGET("pclmul,ssse3")
+static inline __m128i xLoadBE(const uint8_t* Data, __m128i Reverse)
+{
+  return _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Data)), Reverse);
+}
+
+/**
+ * @brief Carry-less multiplication kernel
+ *
+ * The message is treated as a polynomial M. Four 128-bit accumulators are folded
+ * forward by 512 bits per iteration, merged into one and folded by 128 bits over
+ * the remaining full blocks. The accumulator R then satisfies
+ * M = R * x^(8*Tail) + TailBytes (mod P), so the CRC equals the table CRC (initial
+ * value 0) of the 16 bytes of R followed by the tail.
+ */
+X_ATTR_TARGET("pclmul,ssse3")
+uint32_t xTS_CRC32::CalculatePCLMUL(const uint8_t* Data, size_t Size, uint32_t CRC)
+{
+  if(Size < 16) return CalculateSlicing8(Data, Size, CRC);
+
+  static const xCRC32_FoldConstants K;
+  const __m128i Reverse = _mm_setr_epi8(15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0);
+
+  // Initial CRC register value is added to the first 32 message bits
+  __m128i Acc = _mm_xor_si128(xLoadBE(Data, Reverse), _mm_set_epi32((int)CRC, 0, 0, 0));
+  Data += 16;
+  Size -= 16;
+
+  if(Size >= 48)
+  {
+    __m128i Acc1 = xLoadBE(Data     , Reverse);
+    __m128i Acc2 = xLoadBE(Data + 16, Reverse);
+    __m128i Acc3 = xLoadBE(Data + 32, Reverse);
+    Data += 48;
+    Size -= 48;
+    while(Size >= 64)
+    {
+      Acc  = _mm_xor_si128(xFold(Acc , K.Fold512), xLoadBE(Data     , Reverse));
+      Acc1 = _mm_xor_si128(xFold(Acc1, K.Fold512), xLoadBE(Data + 16, Reverse));
+      Acc2 = _mm_xor_si128(xFold(Acc2, K.Fold512), xLoadBE(Data + 32, Reverse));
+      Acc3 = _mm_xor_si128(xFold(Acc3, K.Fold512), xLoadBE(Data + 48, Reverse));
+      Data += 64;
+      Size -= 64;
+    }
+    Acc = _mm_xor_si128(_mm_xor_si128(xFold(Acc, K.Fold384), xFold(Acc1, K.Fold256)),
+                        _mm_xor_si128(xFold(Acc2, K.Fold128), Acc3));
+  }
+
+  while(Size >= 16)
+  {
+    Acc = _mm_xor_si128(xFold(Acc, K.Fold128), xLoadBE(Data, Reverse));
+    Data += 16;
+    Size -= 16;
+  }
+
+  alignas(16) uint8_t Remainder[16];
+  _mm_store_si128(reinterpret_cast<__m128i*>(Remainder), _mm_shuffle_epi8(Acc, Reverse));
+  return CalculateSlicing8(Data, Size, CalculateSlicing8(Remainder, sizeof(Remainder), 0));
+}
+
+#else //!X_ARCH_X86
+
+uint32_t xTS_CRC32::CalculatePCLMUL(const uint8_t* Data, size_t Size, uint32_t CRC)
+{
+  return CalculateSlicing8(Data, Size, CRC);
+}
+
+#endif //X_ARCH_X86
@@ -0,0 +1,149 @@
+/**
+ * @file tsFollowInputSource.cpp
+ * @brief Implementation of the growing file reader
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsFollowInputSource.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#define TS_HAS_INOTIFY 1
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#define TS_HAS_INOTIFY 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_FollowInputSource Implementation
+//=============================================================================================================================================================================
+
+xTS_FollowInputSource::xTS_FollowInputSource(size_t BlockSize, uint32_t IdleTimeout)
+  : xTS_BufferedInputSource(BlockSize)
+  , m_FileName(nullptr)
+  , m_IdleTimeout(IdleTimeout)
+  , m_NotifyFd(-1)
+  , m_NumWaits(0)
+  , m_NumEvents(0)
+{
+}
+
+xTS_FollowInputSource::~xTS_FollowInputSource()
+{
+  Close();
+}
+
+/**
+ * @brief Opens the file and starts watching it for modifications
+ *
+ * Without inotify (other platforms, exhausted watch limits) the file size is polled.
+ */
+bool xTS_FollowInputSource::Open(const char* FileName)
+{
+  Close();
+  if(!xTS_BufferedInputSource::Open(FileName)) return false;
+  m_FileName  = FileName;
+  m_NumWaits  = 0;
+  m_NumEvents = 0;
+#if TS_HAS_INOTIFY
+  m_NotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(m_NotifyFd >= 0 && inotify_add_watch(m_NotifyFd, FileName, IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB) < 0)
+  {
+    close(m_NotifyFd);
+    m_NotifyFd = -1;
+  }
+#endif
+  return true;
+}
+
+void xTS_FollowInputSource::Close()
+{
+#if TS_HAS_INOTIFY
+  if(m_NotifyFd >= 0)
+  {
+    close(m_NotifyFd);
+    m_NotifyFd = -1;
+  }
+#endif
+  m_FileName = nullptr;
+  xTS_BufferedInputSource::Close();
+}
+
+/**
+ * @brief Refills the block buffer, waiting for the writer at the end of the file
+ *
+ * @param MinBytes Minimal number of contiguous bytes requested (clamped to buffer size)
+ * @return Number of bytes available after the call (fewer than MinBytes once following stopped)
+ */
+size_t xTS_FollowInputSource::Request(size_t MinBytes)
+{
+  MinBytes = std::min(MinBytes, m_BufferSize);
+  for(;;)
+  {
+    xTS_BufferedInputSource::Request(MinBytes);
+    if(m_File == nullptr || m_Available >= MinBytes || !m_EndOfInput) return m_Available;
+
+    // Caught up with the writer - the end of file condition is cleared once the file grew
+    if(!xWaitForData(m_Position + m_Available)) return m_Available;
+    std::clearerr(m_File);
+    m_EndOfInput = false;
+  }
+}
+
+bool xTS_FollowInputSource::xWaitForData(uint64_t FileEnd)
+{
+  m_NumWaits++;
+  if(m_IdleCallback) m_IdleCallback();
+
+  const auto IdleStart = std::chrono::steady_clock::now();
+  for(;;)
+  {
+    if(isStopRequested()) return false;
+
+    const uint64_t FileSize = xGetFileSize();
+    if(FileSize > FileEnd) return true;
+    if(FileSize < FileEnd)
+    {
+      printf("Warning: %s was truncated, stopping\n", m_FileName);
+      return false;
+    }
+    if(m_IdleTimeout && std::chrono::steady_clock::now() - IdleStart >= std::chrono::seconds(m_IdleTimeout)) return false;
+
+#if TS_HAS_INOTIFY
+    if(m_NotifyFd >= 0)
+    {
+      // Sleep until the file changes (or the poll interval passes), then drain the event queue
+      pollfd PollFd = { m_NotifyFd, POLLIN, 0 };
+      if(poll(&PollFd, 1, PollInterval) > 0)
+      {
+        alignas(inotify_event) char Events[4096];
+        ssize_t NumBytes;
+        while((NumBytes = read(m_NotifyFd, Events, sizeof(Events))) > 0)
+        {
+          for(ssize_t Offset = 0; Offset < NumBytes; m_NumEvents++)
+          {
+            Offset += sizeof(inotify_event) + reinterpret_cast<const inotify_event*>(Events + Offset)->len;
+          }
+        }
+      }
+      continue;
+    }
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(PollInterval));
+  }
+}
+
+uint64_t xTS_FollowInputSource::xGetFileSize() const
+{
+  struct stat Status;
+  if(m_FileName == nullptr || stat(m_FileName, &Status) != 0) return 0;
+  return static_cast<uint64_t>(Status.st_size);
+}
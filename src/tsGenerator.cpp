@@ -0,0 +1,323 @@
+/**
+ * @file tsGenerator.cpp
+ * @brief Implementation of the deterministic synthetic Transport Stream generator
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsGenerator.h"
+#include "../include/tsCRC32.h"
+#include <algorithm>
+#include <cstring>
+
+/** @brief 27 MHz ticks times bits of a packet - divided by the bitrate gives the packet duration */
+static constexpr uint64_t PacketTicksBits = static_cast<uint64_t>(xTS::TS_PacketLength) * 8 * xTS::ExtendedClockFrequency_Hz;
+
+/** @brief PCR wraps at 2^33 * 300 */
+static constexpr uint64_t PCR_Range = (static_cast<uint64_t>(1) << 33) * xTS::BaseToExtendedClockMultiplier;
+
+static constexpr uint16_t NullPID = 0x1FFF;
+
+//=============================================================================================================================================================================
+// xTS_GeneratorConfig Implementation
+//=============================================================================================================================================================================
+
+xTS_GeneratorConfig xTS_GeneratorConfig::getDefault()
+{
+  xTS_GeneratorConfig Config;
+  xTS_GeneratorStream Video;
+  Video.PID = 0x0100; Video.StreamType = 0x1B; Video.StreamId = 0xE0; Video.Weight = 9;
+  Video.MinPESSize = 16 * 1024; Video.MaxPESSize = 128 * 1024; Video.Bounded = false; Video.DTS = true; Video.RandomAccess = true;
+  xTS_GeneratorStream Audio;
+  Audio.PID = 0x0101; Audio.StreamType = 0x0F; Audio.StreamId = 0xC0; Audio.Weight = 1;
+  Audio.MinPESSize = 384; Audio.MaxPESSize = 1536;
+  Config.Streams = { Video, Audio };
+  return Config;
+}
+
+//=============================================================================================================================================================================
+// xTS_Generator Implementation
+//=============================================================================================================================================================================
+
+xTS_Generator::xTS_Generator()
+  : m_RandomState(0)
+  , m_TotalWeight(0)
+  , m_PCR_Stream(NOT_VALID)
+  , m_Time(0)
+  , m_TimeFraction(0)
+  , m_NextPCR(0)
+  , m_NextPSI(0)
+  , m_PMT_Pending(false)
+  , m_PAT_CC(0), m_PMT_CC(0), m_NullCC(0)
+  , m_NumPackets(0)
+  , m_NumPES(0)
+  , m_NumNull(0)
+  , m_NumCC_Errors(0)
+  , m_NumSyncLosses(0)
+{
+}
+
+bool xTS_Generator::Init(const xTS_GeneratorConfig& Config)
+{
+  if (Config.Streams.empty() || Config.Bitrate == 0) return false;
+  m_Config = Config;
+  m_Config.MaxStuffing = std::min<uint32_t>(m_Config.MaxStuffing, 175); // adaptation field with PCR must leave one payload byte
+  m_Config.MaxSyncLoss = std::min<uint32_t>(std::max<uint32_t>(m_Config.MaxSyncLoss, 1), MaxOutputSize - xTS::TS_PacketLength);
+
+  m_TotalWeight = 0;
+  m_PCR_Stream  = NOT_VALID;
+  for (uint32_t StreamIdx = 0; StreamIdx < m_Config.Streams.size(); StreamIdx++) {
+    const xTS_GeneratorStream& Stream = m_Config.Streams[StreamIdx];
+    if (Stream.MinPESSize > Stream.MaxPESSize || Stream.PID < 0x0010 || Stream.PID >= NullPID || Stream.PID == m_Config.PMT_PID) return false;
+    for (uint32_t OtherIdx = 0; OtherIdx < StreamIdx; OtherIdx++) {
+      if (m_Config.Streams[OtherIdx].PID == Stream.PID) return false;
+    }
+    m_TotalWeight += Stream.Weight;
+    if (Stream.PID == m_Config.PCR_PID || (m_Config.PCR_PID == NOT_VALID && StreamIdx == 0)) m_PCR_Stream = static_cast<int32_t>(StreamIdx);
+  }
+  if (m_TotalWeight == 0) return false;
+  if (m_PCR_Stream == NOT_VALID) return false;
+
+  m_States.assign(m_Config.Streams.size(), xStreamState{ std::vector<uint8_t>(), 0, 0 });
+  m_RandomState  = m_Config.Seed;
+  m_Time         = 0;
+  m_TimeFraction = 0;
+  m_NextPCR      = 0;
+  m_NextPSI      = 0;
+  m_PMT_Pending  = false;
+  m_PAT_CC = m_PMT_CC = m_NullCC = 0;
+  m_NumPackets = m_NumPES = m_NumNull = m_NumCC_Errors = m_NumSyncLosses = 0;
+  xBuildPSI();
+  return true;
+}
+
+/**
+ * @brief Picks the packet for the current time slot
+ *
+ * Order of precedence: PCR due on the PCR PID, PAT/PMT repetition, null packet, weighted
+ * choice of a stream. Sync loss inserts garbage bytes (never 0x47) before the packet.
+ */
+uint32_t xTS_Generator::Generate(uint8_t* Output)
+{
+  uint32_t NumBytes = 0;
+  if (xRandomEvent(m_Config.SyncLossRate)) {
+    const uint32_t NumGarbage = xRandomRange(1, m_Config.MaxSyncLoss);
+    for (uint32_t Idx = 0; Idx < NumGarbage; Idx++) {
+      const uint8_t Byte = static_cast<uint8_t>(xRandom() >> 56);
+      Output[Idx] = Byte == 0x47 ? 0x00 : Byte;
+    }
+    NumBytes = NumGarbage;
+    m_NumSyncLosses++;
+  }
+
+  uint8_t* Packet = Output + NumBytes;
+  if (m_Config.PCR_Interval && xPCR_Due()) {
+    xStreamPacket(static_cast<uint32_t>(m_PCR_Stream), Packet);
+  } else if (m_Config.PSI_Interval && (m_PMT_Pending || m_Time >= m_NextPSI)) {
+    if (!m_PMT_Pending) {
+      xPSIPacket(Packet, m_PAT, m_PAT_CC);
+      m_NextPSI += static_cast<uint64_t>(m_Config.PSI_Interval) * xTS::ExtendedClockFrequency_kHz;
+    } else {
+      xPSIPacket(Packet, m_PMT, m_PMT_CC);
+    }
+    m_PMT_Pending = !m_PMT_Pending;
+  } else if (xRandomEvent(m_Config.NullRate)) {
+    Packet[0] = 0x47;
+    Packet[1] = static_cast<uint8_t>(NullPID >> 8);
+    Packet[2] = static_cast<uint8_t>(NullPID);
+    Packet[3] = static_cast<uint8_t>(0x10 | m_NullCC);
+    m_NullCC = (m_NullCC + 1) & 0x0F;
+    memset(Packet + xTS::TS_HeaderLength, 0xFF, xTS::TS_PacketLength - xTS::TS_HeaderLength);
+    m_NumNull++;
+  } else {
+    uint32_t Choice = xRandomRange(0, m_TotalWeight - 1), StreamIdx = 0;
+    while (Choice >= m_Config.Streams[StreamIdx].Weight) Choice -= m_Config.Streams[StreamIdx++].Weight;
+    xStreamPacket(StreamIdx, Packet);
+  }
+
+  // Advance the clock by one packet duration at the multiplex bitrate
+  m_TimeFraction += PacketTicksBits % m_Config.Bitrate;
+  m_Time         += PacketTicksBits / m_Config.Bitrate + m_TimeFraction / m_Config.Bitrate;
+  m_TimeFraction %= m_Config.Bitrate;
+  m_NumPackets++;
+  return NumBytes + xTS::TS_PacketLength;
+}
+
+/**
+ * @brief PCR scheduling - the configured interval is an upper bound
+ *
+ * The PCR goes into the last packet slot not after the deadline, so PCR intervals are up
+ * to one packet duration shorter than PCR_Interval, never longer.
+ */
+bool xTS_Generator::xPCR_Due() const
+{
+  const uint64_t SlotTicks = (PacketTicksBits + m_Config.Bitrate - 1) / m_Config.Bitrate;
+  return m_Time + SlotTicks > m_NextPCR;
+}
+
+uint64_t xTS_Generator::xRandom()
+{
+  uint64_t Value = (m_RandomState += 0x9E3779B97F4A7C15ull);
+  Value = (Value ^ (Value >> 30)) * 0xBF58476D1CE4E5B9ull;
+  Value = (Value ^ (Value >> 27)) * 0x94D049BB133111EBull;
+  return Value ^ (Value >> 31);
+}
+
+void xTS_Generator::xBuildPES(uint32_t StreamIdx)
+{
+  const xTS_GeneratorStream& Stream = m_Config.Streams[StreamIdx];
+  std::vector<uint8_t>&      PES    = m_States[StreamIdx].PES;
+  const uint32_t PayloadSize = xRandomRange(Stream.MinPESSize, Stream.MaxPESSize);
+  const uint8_t  HeaderDataLength = Stream.DTS ? 10 : 5;
+  const size_t   HeaderSize = xTS::PES_HeaderLength + 3 + HeaderDataLength;
+
+  PES.resize(HeaderSize + PayloadSize);
+  PES[0] = 0x00; PES[1] = 0x00; PES[2] = 0x01; PES[3] = Stream.StreamId;
+  const size_t Length = Stream.Bounded && PES.size() - xTS::PES_HeaderLength <= 0xFFFF ? PES.size() - xTS::PES_HeaderLength : 0;
+  PES[4] = static_cast<uint8_t>(Length >> 8);
+  PES[5] = static_cast<uint8_t>(Length);
+  PES[6] = 0x80;
+  PES[7] = Stream.DTS ? 0xC0 : 0x80;
+  PES[8] = HeaderDataLength;
+
+  // Presentation 500 ms after the current time, decoding one 25 fps frame earlier
+  const uint64_t PTS = (m_Time / xTS::BaseToExtendedClockMultiplier + xTS::BaseClockFrequency_Hz / 2) & ((static_cast<uint64_t>(1) << 33) - 1);
+  auto WriteTimestamp = [&PES](size_t Offset, uint8_t Prefix, uint64_t Timestamp)
+  {
+    PES[Offset + 0] = static_cast<uint8_t>(Prefix << 4 | (Timestamp >> 29 & 0x0E) | 1);
+    PES[Offset + 1] = static_cast<uint8_t>(Timestamp >> 22);
+    PES[Offset + 2] = static_cast<uint8_t>(Timestamp >> 14 | 1);
+    PES[Offset + 3] = static_cast<uint8_t>(Timestamp >> 7);
+    PES[Offset + 4] = static_cast<uint8_t>(Timestamp << 1 | 1);
+  };
+  WriteTimestamp(9, Stream.DTS ? 3 : 2, PTS);
+  if (Stream.DTS) WriteTimestamp(14, 1, (PTS - 3600) & ((static_cast<uint64_t>(1) << 33) - 1));
+
+  for (size_t Offset = HeaderSize; Offset < PES.size(); Offset += 8) {
+    const uint64_t Value = xRandom();
+    memcpy(PES.data() + Offset, &Value, std::min<size_t>(8, PES.size() - Offset));
+  }
+  m_States[StreamIdx].Offset = 0;
+  m_NumPES++;
+}
+
+/**
+ * @brief Packetizes the next part of the stream's PES packet
+ *
+ * The adaptation field carries the random access indicator on PES starts, the PCR when
+ * due, extra stuffing when drawn and the stuffing aligning the end of the PES packet.
+ */
+void xTS_Generator::xStreamPacket(uint32_t StreamIdx, uint8_t* Packet)
+{
+  const xTS_GeneratorStream& Stream = m_Config.Streams[StreamIdx];
+  xStreamState&              State  = m_States[StreamIdx];
+  if (State.Offset >= State.PES.size()) xBuildPES(StreamIdx);
+
+  const bool     First     = State.Offset == 0;
+  const bool     HasPCR    = static_cast<int32_t>(StreamIdx) == m_PCR_Stream && (m_Config.PCR_Interval == 0 || xPCR_Due());
+  const bool     HasRA     = First && Stream.RandomAccess;
+  const uint32_t Stuffing  = xRandomEvent(m_Config.StuffingRate) ? xRandomRange(1, m_Config.MaxStuffing) : 0;
+  const size_t   Remaining = State.PES.size() - State.Offset;
+  const bool     HasAF     = HasPCR || HasRA || Stuffing || Remaining < xTS::TS_PacketLength - xTS::TS_HeaderLength;
+
+  if (xRandomEvent(m_Config.CC_ErrorRate)) {
+    State.CC = (State.CC + 1) & 0x0F; // as if a packet was lost
+    m_NumCC_Errors++;
+  }
+  Packet[0] = 0x47;
+  Packet[1] = static_cast<uint8_t>((First ? 0x40 : 0x00) | (Stream.PID >> 8));
+  Packet[2] = static_cast<uint8_t>(Stream.PID);
+  Packet[3] = static_cast<uint8_t>((HasAF ? 0x30 : 0x10) | State.CC);
+  State.CC  = (State.CC + 1) & 0x0F;
+
+  size_t PayloadOffset = xTS::TS_HeaderLength;
+  if (HasAF) {
+    size_t AF_Length = 1 + (HasPCR ? 6 : 0) + Stuffing;
+    const size_t Space = xTS::TS_PacketLength - xTS::TS_HeaderLength - 1 - AF_Length;
+    if (Remaining < Space) AF_Length += Space - Remaining;
+
+    Packet[4] = static_cast<uint8_t>(AF_Length);
+    Packet[5] = static_cast<uint8_t>((HasRA ? 0x40 : 0x00) | (HasPCR ? 0x10 : 0x00));
+    size_t FieldOffset = 6;
+    if (HasPCR) {
+      const uint64_t PCR = m_Time % PCR_Range;
+      const uint64_t Base = PCR / xTS::BaseToExtendedClockMultiplier, Extension = PCR % xTS::BaseToExtendedClockMultiplier;
+      Packet[6]  = static_cast<uint8_t>(Base >> 25);
+      Packet[7]  = static_cast<uint8_t>(Base >> 17);
+      Packet[8]  = static_cast<uint8_t>(Base >> 9);
+      Packet[9]  = static_cast<uint8_t>(Base >> 1);
+      Packet[10] = static_cast<uint8_t>((Base & 1) << 7 | 0x7E | Extension >> 8);
+      Packet[11] = static_cast<uint8_t>(Extension);
+      FieldOffset = 12;
+
+      m_NextPCR = m_Time + static_cast<uint64_t>(m_Config.PCR_Interval) * xTS::ExtendedClockFrequency_kHz;
+    }
+    PayloadOffset = xTS::TS_HeaderLength + 1 + AF_Length;
+    memset(Packet + FieldOffset, 0xFF, PayloadOffset - FieldOffset);
+  }
+
+  const size_t PayloadLength = xTS::TS_PacketLength - PayloadOffset;
+  memcpy(Packet + PayloadOffset, State.PES.data() + State.Offset, PayloadLength);
+  State.Offset += PayloadLength;
+}
+
+/**
+ * @brief Builds the PAT (program 1) and PMT (all streams) packets with CRC_32
+ */
+void xTS_Generator::xBuildPSI()
+{
+  const xTS_CRC32 CRC32;
+  auto Finish = [&CRC32](uint8_t* Packet, uint16_t PID, size_t SectionEnd)
+  {
+    Packet[0] = 0x47;
+    Packet[1] = static_cast<uint8_t>(0x40 | PID >> 8);
+    Packet[2] = static_cast<uint8_t>(PID);
+    Packet[3] = 0x10;
+    Packet[4] = 0x00; // pointer_field
+    const size_t SectionLength = SectionEnd + 4 - 8; // bytes after section_length, including CRC_32
+    Packet[6] = static_cast<uint8_t>(0xB0 | SectionLength >> 8);
+    Packet[7] = static_cast<uint8_t>(SectionLength);
+    const uint32_t CRC = CRC32.Calculate(Packet + 5, SectionEnd - 5);
+    Packet[SectionEnd + 0] = static_cast<uint8_t>(CRC >> 24);
+    Packet[SectionEnd + 1] = static_cast<uint8_t>(CRC >> 16);
+    Packet[SectionEnd + 2] = static_cast<uint8_t>(CRC >> 8);
+    Packet[SectionEnd + 3] = static_cast<uint8_t>(CRC);
+    memset(Packet + SectionEnd + 4, 0xFF, xTS::TS_PacketLength - SectionEnd - 4);
+  };
+
+  // PAT: transport_stream_id 1, program 1 -> PMT PID
+  uint8_t* PAT = m_PAT;
+  PAT[5] = 0x00; PAT[8] = 0x00; PAT[9] = 0x01; PAT[10] = 0xC1; PAT[11] = 0x00; PAT[12] = 0x00;
+  PAT[13] = 0x00; PAT[14] = 0x01;
+  PAT[15] = static_cast<uint8_t>(0xE0 | m_Config.PMT_PID >> 8);
+  PAT[16] = static_cast<uint8_t>(m_Config.PMT_PID);
+  Finish(PAT, 0x0000, 17);
+
+  // PMT: program 1, PCR PID, one entry per stream (the stream loop is limited to one packet)
+  uint8_t* PMT = m_PMT;
+  const uint16_t PCR_PID = m_Config.Streams[static_cast<uint32_t>(m_PCR_Stream)].PID;
+  PMT[5] = 0x02; PMT[8] = 0x00; PMT[9] = 0x01; PMT[10] = 0xC1; PMT[11] = 0x00; PMT[12] = 0x00;
+  PMT[13] = static_cast<uint8_t>(0xE0 | PCR_PID >> 8);
+  PMT[14] = static_cast<uint8_t>(PCR_PID);
+  PMT[15] = 0xF0; PMT[16] = 0x00;
+  size_t Offset = 17;
+  for (const xTS_GeneratorStream& Stream : m_Config.Streams) {
+    if (Offset + 5 + 4 > xTS::TS_PacketLength) break;
+    PMT[Offset + 0] = Stream.StreamType;
+    PMT[Offset + 1] = static_cast<uint8_t>(0xE0 | Stream.PID >> 8);
+    PMT[Offset + 2] = static_cast<uint8_t>(Stream.PID);
+    PMT[Offset + 3] = 0xF0;
+    PMT[Offset + 4] = 0x00;
+    Offset += 5;
+  }
+  Finish(PMT, m_Config.PMT_PID, Offset);
+}
+
+void xTS_Generator::xPSIPacket(uint8_t* Packet, const uint8_t* Template, uint8_t& CC)
+{
+  memcpy(Packet, Template, xTS::TS_PacketLength);
+  Packet[3] = static_cast<uint8_t>(Template[3] | CC);
+  CC = (CC + 1) & 0x0F;
+}
@@ -0,0 +1,375 @@
+/**
+ * @file tsInputSource.cpp
+ * @brief Implementation of buffered and memory mapped Transport Stream input sources
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsInputSource.h"
+#include "../include/tsUringInputSource.h"
+#include "../include/tsFollowInputSource.h"
+#include "../include/tsUdpInputSource.h"
+#include <algorithm>
+#include <cstring>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#else
+#define TS_HAS_MMAP 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_InputSource Implementation
+//=============================================================================================================================================================================
+
+std::atomic<bool> xTS_InputSource::ms_StopRequested(false);
+
+/**
+ * @brief Creates input source of requested type
+ *
+ * eType::Auto resolves to the memory mapped source when the input is a regular file
+ * and mapping is supported; the standard input ("-"), pipes, character devices and
+ * unsupported platforms use the buffered reader. The io_uring source requires a regular file and a kernel
+ * permitting io_uring, otherwise the buffered reader is used as well. udp:// and rtp:// names always
+ * select the network receiver.
+ *
+ * @param Type     Requested backend
+ * @param FileName Path of the input (inspected for eType::Auto and eType::Uring)
+ * @param Config   Backend tuning parameters
+ * @return New input source, never null
+ */
+std::unique_ptr<xTS_InputSource> xTS_InputSource::Create(eType Type, const char* FileName, const xTS_InputConfig& Config)
+{
+  struct stat Status;
+  const bool isStdin       = FileName && strcmp(FileName, StdinName) == 0;
+  const bool isRegularFile = FileName && !isStdin && stat(FileName, &Status) == 0 && (Status.st_mode & S_IFMT) == S_IFREG;
+
+  if(xTS_UdpInputSource::isURL(FileName))
+  {
+    return std::unique_ptr<xTS_InputSource>(new xTS_UdpInputSource(Config.BlockSize, Config.IdleTimeout, Config.RecvBufferSize, Config.Interface));
+  }
+
+  if(Config.Follow && !isStdin)
+  {
+    return std::unique_ptr<xTS_InputSource>(new xTS_FollowInputSource(Config.BlockSize, Config.IdleTimeout));
+  }
+
+  if(Type == eType::Auto)
+  {
+    Type = (isRegularFile && xTS_MmapInputSource::isSupported()) ? eType::Mmap : eType::Buffered;
+  }
+
+  if(Type == eType::Mmap && isRegularFile && xTS_MmapInputSource::isSupported())
+  {
+    return std::unique_ptr<xTS_InputSource>(new xTS_MmapInputSource());
+  }
+
+  if(Type == eType::Uring && isRegularFile && xTS_UringInputSource::isSupported())
+  {
+    return std::unique_ptr<xTS_InputSource>(new xTS_UringInputSource(Config.BlockSize, Config.QueueDepth, Config.DirectIO));
+  }
+
+  return std::unique_ptr<xTS_InputSource>(new xTS_BufferedInputSource(Config.BlockSize));
+}
+
+//=============================================================================================================================================================================
+// xTS_BufferedInputSource Implementation
+//=============================================================================================================================================================================
+
+xTS_BufferedInputSource::xTS_BufferedInputSource(size_t BlockSize)
+  : m_File(nullptr)
+  , m_Buffer(nullptr)
+  , m_BufferSize(BlockSize)
+  , m_FileSize(0)
+  , m_EndOfInput(false)
+  , m_OwnsFile(false)
+{
+}
+
+xTS_BufferedInputSource::~xTS_BufferedInputSource()
+{
+  Close();
+}
+
+/**
+ * @brief Opens input file and allocates the block buffer
+ *
+ * stdio buffering is disabled because every fread() already targets a multi-megabyte
+ * block; a second buffer would only add a copy.
+ *
+ * @param FileName Path of the input file, "-" for the standard input
+ * @return True on success
+ */
+bool xTS_BufferedInputSource::Open(const char* FileName)
+{
+  Close();
+
+  m_OwnsFile = strcmp(FileName, StdinName) != 0;
+  if(m_OwnsFile)
+  {
+    m_File = std::fopen(FileName, "rb");
+    if(m_File == nullptr) return false;
+  }
+  else
+  {
+    m_File = stdin;
+#if defined(_WIN32)
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+  }
+  std::setvbuf(m_File, nullptr, _IONBF, 0);
+
+  struct stat Status;
+  if(m_OwnsFile && stat(FileName, &Status) == 0 && (Status.st_mode & S_IFMT) == S_IFREG)
+  {
+    m_FileSize = static_cast<uint64_t>(Status.st_size);
+  }
+
+  m_BufferRef.reset(new uint8_t[m_BufferSize], std::default_delete<uint8_t[]>());
+  m_Buffer     = m_BufferRef.get();
+  m_Data       = m_Buffer;
+  m_Available  = 0;
+  m_Position   = 0;
+  m_EndOfInput = false;
+  return true;
+}
+
+/**
+ * @brief Closes input file and releases the block buffer
+ */
+void xTS_BufferedInputSource::Close()
+{
+  if(m_File)
+  {
+    if(m_OwnsFile) std::fclose(m_File);
+    m_File = nullptr;
+  }
+  m_BufferRef.reset();
+  m_Buffer    = nullptr;
+  m_Data      = nullptr;
+  m_Available = 0;
+  m_FileSize  = 0;
+}
+
+/**
+ * @brief Refills the block buffer
+ *
+ * Unconsumed bytes are moved to the start of the buffer and the rest of the buffer is
+ * filled with fread(). Short reads (pipes, terminals) are retried until MinBytes are
+ * available or the end of input is reached. If consumed bytes are still referenced
+ * (getBlockRef()), the tail is copied into a fresh buffer instead.
+ *
+ * @param MinBytes Minimal number of contiguous bytes requested (clamped to buffer size)
+ * @return Number of bytes available after the call
+ */
+size_t xTS_BufferedInputSource::Request(size_t MinBytes)
+{
+  if(m_File == nullptr) return 0;
+  if(MinBytes > m_BufferSize) MinBytes = m_BufferSize;
+  if(m_Available >= MinBytes || m_EndOfInput) return m_Available;
+
+  // Consumed bytes are still referenced - continue in a fresh buffer
+  if(m_Data != m_Buffer && m_BufferRef.use_count() > 1)
+  {
+    std::shared_ptr<uint8_t> Fresh(new uint8_t[m_BufferSize], std::default_delete<uint8_t[]>());
+    if(m_Available > 0) std::memcpy(Fresh.get(), m_Data, m_Available);
+    m_BufferRef = Fresh;
+    m_Buffer    = Fresh.get();
+    m_Data      = m_Buffer;
+  }
+
+  // Move unconsumed tail to the front of the buffer
+  if(m_Data != m_Buffer && m_Available > 0)
+  {
+    std::memmove(m_Buffer, m_Data, m_Available);
+  }
+  m_Data = m_Buffer;
+
+  while(m_Available < MinBytes)
+  {
+    size_t NumRead = std::fread(m_Buffer + m_Available, 1, m_BufferSize - m_Available, m_File);
+    m_Available += NumRead;
+    if(NumRead == 0)
+    {
+      m_EndOfInput = true;
+      break;
+    }
+  }
+
+  return m_Available;
+}
+
+/**
+ * @brief Repositions the file (regular files only); a referenced buffer is replaced by a fresh one
+ */
+bool xTS_BufferedInputSource::Seek(uint64_t Position)
+{
+  if(m_File == nullptr || m_FileSize == 0 || Position > m_FileSize) return false;
+#if TS_HAS_MMAP
+  if(fseeko(m_File, static_cast<off_t>(Position), SEEK_SET) != 0) return false;
+#else
+  if(_fseeki64(m_File, static_cast<__int64>(Position), SEEK_SET) != 0) return false;
+#endif
+
+  if(m_BufferRef.use_count() > 1)
+  {
+    m_BufferRef.reset(new uint8_t[m_BufferSize], std::default_delete<uint8_t[]>());
+    m_Buffer = m_BufferRef.get();
+  }
+  m_Data       = m_Buffer;
+  m_Available  = 0;
+  m_Position   = Position;
+  m_EndOfInput = false;
+  return true;
+}
+
+//=============================================================================================================================================================================
+// xTS_MmapInputSource Implementation
+//=============================================================================================================================================================================
+
+xTS_MmapInputSource::xTS_MmapInputSource()
+  : m_FileDescriptor(-1)
+  , m_Mapping(nullptr)
+  , m_MappingSize(0)
+  , m_PrefetchEnd(0)
+{
+}
+
+xTS_MmapInputSource::~xTS_MmapInputSource()
+{
+  Close();
+}
+
+bool xTS_MmapInputSource::isSupported()
+{
+  return TS_HAS_MMAP != 0;
+}
+
+/**
+ * @brief Maps the whole input file read-only
+ *
+ * Access pattern hints are advisory only - failures of madvise() are ignored.
+ * An empty file is opened successfully and simply yields no data.
+ *
+ * @param FileName Path of a regular file
+ * @return True on success
+ */
+bool xTS_MmapInputSource::Open(const char* FileName)
+{
+  Close();
+#if TS_HAS_MMAP
+  m_FileDescriptor = ::open(FileName, O_RDONLY);
+  if(m_FileDescriptor < 0) return false;
+
+  struct stat Status;
+  if(fstat(m_FileDescriptor, &Status) != 0 || (Status.st_mode & S_IFMT) != S_IFREG)
+  {
+    Close();
+    return false;
+  }
+
+  m_MappingSize = static_cast<uint64_t>(Status.st_size);
+  m_Position    = 0;
+  m_Available   = 0;
+  m_PrefetchEnd = 0;
+  if(m_MappingSize == 0) return true;
+
+  void* Mapping = mmap(nullptr, m_MappingSize, PROT_READ, MAP_PRIVATE, m_FileDescriptor, 0);
+  if(Mapping == MAP_FAILED)
+  {
+    Close();
+    return false;
+  }
+  m_Mapping    = static_cast<uint8_t*>(Mapping);
+  m_MappingRef = xBlockRef(m_Mapping, [Size = m_MappingSize](const uint8_t* Mapping) { munmap(const_cast<uint8_t*>(Mapping), Size); });
+  m_Data       = m_Mapping;
+
+  madvise(m_Mapping, m_MappingSize, MADV_SEQUENTIAL);
+#if defined(MADV_HUGEPAGE)
+  madvise(m_Mapping, m_MappingSize, MADV_HUGEPAGE);
+#endif
+  return true;
+#else
+  (void)FileName;
+  return false;
+#endif
+}
+
+/**
+ * @brief Unmaps the file and closes its descriptor
+ *
+ * The mapping itself is released once no block reference is held any more.
+ */
+void xTS_MmapInputSource::Close()
+{
+#if TS_HAS_MMAP
+  m_MappingRef.reset();
+  m_Mapping = nullptr;
+  if(m_FileDescriptor >= 0)
+  {
+    ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+  }
+#endif
+  m_Data        = nullptr;
+  m_Available   = 0;
+  m_MappingSize = 0;
+}
+
+/**
+ * @brief Extends the window over the mapping
+ *
+ * The window grows to at least WindowSize bytes (or MinBytes if larger) and the
+ * following window is prefetched with MADV_WILLNEED, so page faults are mostly
+ * served from the page cache while the current window is being parsed.
+ *
+ * @param MinBytes Minimal number of contiguous bytes requested
+ * @return Number of bytes available after the call
+ */
+size_t xTS_MmapInputSource::Request(size_t MinBytes)
+{
+  if(m_Mapping == nullptr) return 0;
+
+  uint64_t Remaining = m_MappingSize - m_Position;
+  uint64_t Wanted    = std::max<uint64_t>(MinBytes, WindowSize);
+  m_Available = static_cast<size_t>(std::min(Remaining, Wanted));
+
+#if TS_HAS_MMAP && defined(MADV_WILLNEED)
+  uint64_t PrefetchEnd = std::min(m_MappingSize, m_Position + m_Available + WindowSize);
+  if(PrefetchEnd > m_PrefetchEnd)
+  {
+    static const uint64_t PageMask = static_cast<uint64_t>(sysconf(_SC_PAGESIZE)) - 1;
+    uint64_t PrefetchBegin = std::max(m_PrefetchEnd, m_Position + m_Available) & ~PageMask;
+    if(PrefetchEnd > PrefetchBegin)
+    {
+      madvise(m_Mapping + PrefetchBegin, PrefetchEnd - PrefetchBegin, MADV_WILLNEED);
+    }
+    m_PrefetchEnd = PrefetchEnd;
+  }
+#endif
+
+  return m_Available;
+}
+
+/**
+ * @brief Moves the window start; pages are read ahead from the new position
+ */
+bool xTS_MmapInputSource::Seek(uint64_t Position)
+{
+  if(m_Mapping == nullptr || Position > m_MappingSize) return false;
+  m_Data        = m_Mapping + Position;
+  m_Available   = 0;
+  m_Position    = Position;
+  m_PrefetchEnd = Position;
+  return true;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file tsMappedFile.cpp
+ * @brief Implementation of read-only whole file access
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsMappedFile.h"
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TS_HAS_MMAP 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_MappedFile Implementation
+//=============================================================================================================================================================================
+
+xTS_MappedFile::xTS_MappedFile()
+  : m_Data(nullptr)
+  , m_Size(0)
+  , m_Mapped(false)
+{
+}
+
+xTS_MappedFile::~xTS_MappedFile()
+{
+  Close();
+}
+
+bool xTS_MappedFile::Open(const char* FileName, size_t MinSize)
+{
+  Close();
+#if TS_HAS_MMAP
+  int FileDescriptor = ::open(FileName, O_RDONLY);
+  if(FileDescriptor < 0) return false;
+  struct stat Stat;
+  if(fstat(FileDescriptor, &Stat) != 0 || Stat.st_size <= 0 || (size_t)Stat.st_size < MinSize)
+  {
+    ::close(FileDescriptor);
+    return false;
+  }
+  void* Mapping = mmap(nullptr, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+  ::close(FileDescriptor);
+  if(Mapping == MAP_FAILED) return false;
+  m_Data   = static_cast<const uint8_t*>(Mapping);
+  m_Size   = (size_t)Stat.st_size;
+  m_Mapped = true;
+#else
+  std::FILE* File = std::fopen(FileName, "rb");
+  if(File == nullptr) return false;
+  uint8_t Chunk[65536];
+  size_t  Read;
+  while((Read = std::fread(Chunk, 1, sizeof(Chunk), File)) > 0) { m_Buffer.insert(m_Buffer.end(), Chunk, Chunk + Read); }
+  std::fclose(File);
+  if(m_Buffer.empty() || m_Buffer.size() < MinSize) { m_Buffer.clear(); return false; }
+  m_Data = m_Buffer.data();
+  m_Size = m_Buffer.size();
+#endif
+  return true;
+}
+
+void xTS_MappedFile::Close()
+{
+#if TS_HAS_MMAP
+  if(m_Mapped && m_Data) munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+  m_Data   = nullptr;
+  m_Size   = 0;
+  m_Mapped = false;
+  m_Buffer.clear();
+}
@@ -0,0 +1,176 @@
+/**
+ * @file tsOutputWriter.cpp
+ * @brief Implementation of asynchronous buffered text output
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsOutputWriter.h"
+#include <algorithm>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_POSIX_WRITE 1
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#else
+#define TS_HAS_POSIX_WRITE 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_OutputWriter Implementation
+//=============================================================================================================================================================================
+
+xTS_OutputWriter::xTS_OutputWriter()
+  : m_FileDescriptor(-1)
+  , m_File(nullptr)
+  , m_ChunkSize(0)
+  , m_Stop(false)
+  , m_Failed(false)
+  , m_NumBytes(0)
+  , m_NumCalls(0)
+  , m_NumStalls(0)
+{
+}
+
+xTS_OutputWriter::~xTS_OutputWriter()
+{
+  Close();
+}
+
+bool xTS_OutputWriter::Open(const char* FileName, size_t ChunkSize, uint32_t NumChunks)
+{
+  Close();
+#if TS_HAS_POSIX_WRITE
+  m_FileDescriptor = ::open(FileName, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(m_FileDescriptor < 0) return false;
+#else
+  m_File = std::fopen(FileName, "wb");
+  if(m_File == nullptr) return false;
+#endif
+
+  m_ChunkSize = std::max<size_t>(ChunkSize, 4 * MaxNumberLength);
+  NumChunks   = std::max<uint32_t>(NumChunks, 2);
+  m_Storage.clear();
+  m_FreeChunks.clear();
+  m_FullChunks.clear();
+  for(uint32_t Idx = 0; Idx < NumChunks; Idx++)
+  {
+    m_Storage.emplace_back(new char[m_ChunkSize]);
+    m_FreeChunks.push_back(m_Storage.back().get());
+  }
+  m_Begin = m_FreeChunks.back();
+  m_FreeChunks.pop_back();
+  m_Cur   = m_Begin;
+  m_End   = m_Begin + m_ChunkSize;
+
+  m_Stop   = false;
+  m_Failed = false;
+  m_Thread = std::thread(&xTS_OutputWriter::xWriterLoop, this);
+  return true;
+}
+
+bool xTS_OutputWriter::Close()
+{
+  if(!isOpen()) return !m_Failed;
+
+  // Queue the partially filled chunk and let the writer thread drain the queue
+  {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    if(m_Cur != m_Begin) m_FullChunks.push_back(xChunk{ m_Begin, static_cast<size_t>(m_Cur - m_Begin) });
+    m_Stop = true;
+  }
+  m_FullCondition.notify_one();
+  m_Thread.join();
+
+  m_Begin = m_Cur = m_End = nullptr;
+  m_Storage.clear();
+  m_FreeChunks.clear();
+
+#if TS_HAS_POSIX_WRITE
+  if(m_FileDescriptor >= 0)
+  {
+    ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+  }
+#endif
+  if(m_File)
+  {
+    std::fclose(m_File);
+    m_File = nullptr;
+  }
+  return !m_Failed;
+}
+
+/**
+ * @brief Queues the current chunk for writing and continues in a free one (waits if none is free)
+ */
+void xTS_OutputWriter::xSubmit()
+{
+  std::unique_lock<std::mutex> Lock(m_Mutex);
+  if(m_Cur != m_Begin) m_FullChunks.push_back(xChunk{ m_Begin, static_cast<size_t>(m_Cur - m_Begin) });
+  else                 m_FreeChunks.push_back(m_Begin);
+  m_FullCondition.notify_one();
+
+  if(m_FreeChunks.empty())
+  {
+    m_NumStalls++;
+    m_FreeCondition.wait(Lock, [this]() { return !m_FreeChunks.empty(); });
+  }
+  m_Begin = m_FreeChunks.back();
+  m_FreeChunks.pop_back();
+  m_Cur   = m_Begin;
+  m_End   = m_Begin + m_ChunkSize;
+}
+
+void xTS_OutputWriter::xWriterLoop()
+{
+  std::unique_lock<std::mutex> Lock(m_Mutex);
+  for(;;)
+  {
+    m_FullCondition.wait(Lock, [this]() { return m_Stop || !m_FullChunks.empty(); });
+    if(m_FullChunks.empty()) return; // stopped and drained
+
+    const xChunk Chunk = m_FullChunks.front();
+    m_FullChunks.pop_front();
+    const bool WriteChunk = !m_Failed;
+    Lock.unlock();
+    const bool Written = WriteChunk && xWrite(Chunk.Data, Chunk.Size);
+    Lock.lock();
+
+    if(WriteChunk && !Written) m_Failed = true;
+    m_FreeChunks.push_back(Chunk.Data);
+    m_FreeCondition.notify_one();
+  }
+}
+
+/**
+ * @brief Writes a whole chunk, resuming after partial writes (writer thread)
+ */
+bool xTS_OutputWriter::xWrite(const char* Data, size_t Size)
+{
+#if TS_HAS_POSIX_WRITE
+  while(Size > 0)
+  {
+    ssize_t Written = ::write(m_FileDescriptor, Data, Size);
+    m_NumCalls++;
+    if(Written < 0)
+    {
+      if(errno == EINTR) continue;
+      return false;
+    }
+    if(Written == 0) return false;
+    m_NumBytes += static_cast<uint64_t>(Written);
+    Data       += Written;
+    Size       -= static_cast<size_t>(Written);
+  }
+  return true;
+#else
+  size_t Written = std::fwrite(Data, 1, Size, m_File);
+  m_NumCalls++;
+  m_NumBytes += Written;
+  return Written == Size;
+#endif
+}
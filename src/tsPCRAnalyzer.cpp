@@ -0,0 +1,173 @@
+/**
+ * @file tsPCRAnalyzer.cpp
+ * @brief Implementation of the PCR timing analysis
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsPCRAnalyzer.h"
+#include "../include/tsTimeIndex.h"
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xTS_LogHistogram Implementation
+//=============================================================================================================================================================================
+
+uint32_t xTS_LogHistogram::xFloorLog2(uint64_t Value)
+{
+  uint32_t Log2 = 0;
+  for(uint32_t Shift = 32; Shift > 0; Shift >>= 1)
+  {
+    if(Value >> Shift) { Value >>= Shift; Log2 += Shift; }
+  }
+  return Log2;
+}
+
+uint32_t xTS_LogHistogram::xBucket(uint64_t Value)
+{
+  if(Value < SubBuckets) return static_cast<uint32_t>(Value);
+  const uint32_t Shift = xFloorLog2(Value) - SubBucketBits;
+  return (Shift + 1) * SubBuckets + static_cast<uint32_t>(Value >> Shift) - SubBuckets;
+}
+
+uint64_t xTS_LogHistogram::xLowerBound(uint32_t Bucket)
+{
+  if(Bucket < SubBuckets) return Bucket;
+  const uint32_t Shift = Bucket / SubBuckets - 1;
+  return static_cast<uint64_t>(Bucket % SubBuckets + SubBuckets) << Shift;
+}
+
+uint64_t xTS_LogHistogram::xMidpoint(uint32_t Bucket)
+{
+  const uint64_t Width = Bucket < SubBuckets ? 1 : 1ull << (Bucket / SubBuckets - 1);
+  return xLowerBound(Bucket) + (Width - 1) / 2;
+}
+
+uint64_t xTS_LogHistogram::getPercentile(double Percentile) const
+{
+  if(m_Total == 0) return 0;
+  uint64_t Rank = static_cast<uint64_t>(std::ceil(Percentile / 100.0 * static_cast<double>(m_Total)));
+  if(Rank == 0) Rank = 1;
+  uint64_t Seen = 0;
+  for(uint32_t Bucket = 0; Bucket < NumBuckets; Bucket++)
+  {
+    Seen += m_Counts[Bucket];
+    if(Seen >= Rank) return std::min(std::max(xMidpoint(Bucket), m_Min), m_Max);
+  }
+  return m_Max;
+}
+
+//=============================================================================================================================================================================
+// xTS_PCRAnalyzer Implementation
+//=============================================================================================================================================================================
+
+namespace
+{
+  constexpr uint32_t ATS_Mask     = 0x3FFFFFFF;                            ///< M2TS arrival timestamps are 30 bits wide
+  constexpr uint64_t TicksPerMs   = xTS_TimeIndex::ClockRate / 1000;
+  constexpr double   TicksPerHour = 3600.0 * xTS_TimeIndex::ClockRate;
+}
+
+xTS_PCRAnalyzer::xTS_PCRAnalyzer()
+{
+  memset(m_SlotIdx, 0, sizeof(m_SlotIdx));
+}
+
+uint16_t xTS_PCRAnalyzer::xAddStream(const xTS_PacketRecord& Record)
+{
+  m_Streams.emplace_back();
+  xStream& Stream = m_Streams.back();
+  Stream.PID = Record.PID;
+  Stream.ATS = (Record.Flags & xTS_PacketRecord::FlagATS) != 0;
+  m_SlotIdx[Record.PID] = static_cast<uint16_t>(m_Streams.size());
+  return m_SlotIdx[Record.PID];
+}
+
+void xTS_PCRAnalyzer::xAddPCR(xStream& Stream, const xTS_PacketRecord& Record, uint64_t Offset)
+{
+  const uint64_t PCR = Record.getPCR();
+
+  // Arrival: unwrapped ATS (27 MHz) or byte offset
+  double Arrival;
+  if(Stream.ATS)
+  {
+    const uint32_t RawATS = Record.ATS & ATS_Mask;
+    Stream.LastATS   += Stream.NumPCRs ? (RawATS - Stream.LastRawATS) & ATS_Mask : RawATS;
+    Stream.LastRawATS = RawATS;
+    Arrival = static_cast<double>(Stream.LastATS);
+  }
+  else
+  {
+    Arrival = static_cast<double>(Offset);
+  }
+
+  if(Stream.NumPCRs++ == 0)
+  {
+    Stream.LastPCR = PCR;
+    xRestart(Stream, Arrival);
+    return;
+  }
+
+  // Flagged discontinuities, backward steps and gaps restart the fit
+  const uint64_t Delta = (PCR + xTS_TimeIndex::PCR_Range - Stream.LastPCR) % xTS_TimeIndex::PCR_Range;
+  Stream.LastPCR = PCR;
+  if((Record.AF_Flags & 0x80) || Delta > MaxPCRGap * TicksPerMs)
+  {
+    Stream.NumDiscontinuities++;
+    xRestart(Stream, Arrival);
+    return;
+  }
+  Stream.Interval.Add(static_cast<double>(Delta) / TicksPerMs);
+  Stream.IntervalHist.Add(Delta / 27);
+  Stream.PCRTime += Delta;
+
+  // Overall jitter - PCR against the fit of the preceding PCRs of the segment
+  const double X = Arrival - Stream.Origin;
+  const double Y = static_cast<double>(Stream.PCRTime);
+  if(Stream.Fit.getCount() >= MinFitPCRs)
+  {
+    const double Jitter_ns = (Y - Stream.Fit.getPrediction(X)) * 1000.0 / 27.0;
+    Stream.Jitter.Add(Jitter_ns);
+    Stream.JitterHist.Add(static_cast<uint64_t>(std::fabs(Jitter_ns) + 0.5));
+  }
+  Stream.Fit.Add(X, Y);
+  Stream.BlockFit.Add(X, Y);
+  if(Y - Stream.BlockStart >= static_cast<double>(BlockDuration) * xTS_TimeIndex::ClockRate) xCloseBlock(Stream, X, Y);
+}
+
+void xTS_PCRAnalyzer::xRestart(xStream& Stream, double Arrival)
+{
+  Stream.DriftTime += static_cast<double>(Stream.PCRTime) / TicksPerHour;
+  Stream.Origin     = Arrival;
+  Stream.PCRTime    = 0;
+  Stream.BlockStart = 0;
+  Stream.Fit.Reset();
+  Stream.BlockFit.Reset();
+  Stream.Fit.Add(0, 0);
+  Stream.BlockFit.Add(0, 0);
+}
+
+void xTS_PCRAnalyzer::xCloseBlock(xStream& Stream, double X, double Y)
+{
+  const double Slope = Stream.BlockFit.getSlope();
+  if(Slope > 0)
+  {
+    if(Stream.ATS)
+    {
+      const double Offset_ppm = (Slope - 1.0) * 1e6;
+      Stream.BlockSlope.Add(Offset_ppm);
+      Stream.Drift.Add(Stream.DriftTime + Y / TicksPerHour, Offset_ppm);
+    }
+    else
+    {
+      Stream.BlockSlope.Add(8.0 * xTS_TimeIndex::ClockRate / Slope / 1e6);
+    }
+  }
+  // The block boundary PCR also starts the next block
+  Stream.BlockStart = Y;
+  Stream.BlockFit.Reset();
+  Stream.BlockFit.Add(X, Y);
+}
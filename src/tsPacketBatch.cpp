@@ -0,0 +1,157 @@
+/**
+ * @file tsPacketBatch.cpp
+ * @brief Implementation of batch TS packet header decoding
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsPacketBatch.h"
+#include <algorithm>
+
+//=============================================================================================================================================================================
+// xTS_PacketBatch Implementation
+//=============================================================================================================================================================================
+
+xTS_PacketBatch::xTS_PacketBatch(uint32_t Capacity)
+  : m_Capacity(Capacity > 0 ? Capacity : 1)
+  , m_NumPackets(0)
+  , m_UseAVX2(xCpuHasAVX2())
+  , m_PID(m_Capacity)
+  , m_Flags(m_Capacity)
+  , m_TSC(m_Capacity)
+  , m_AFC(m_Capacity)
+  , m_CC(m_Capacity)
+  , m_PayloadOffset(m_Capacity)
+{
+}
+
+/**
+ * @brief Decodes headers of consecutive packets into the column table
+ *
+ * The AVX2 kernel handles groups of 8 packets, the remaining packets are decoded
+ * by the scalar kernel.
+ */
+uint32_t xTS_PacketBatch::Decode(const uint8_t* Data, uint32_t NumPackets, uint32_t Stride)
+{
+  m_NumPackets = std::min(NumPackets, m_Capacity);
+
+  uint32_t Done = 0;
+  if(m_UseAVX2)
+  {
+    Done = m_NumPackets & ~7u;
+    xDecodeAVX2(Data, Done, Stride);
+  }
+  xDecodeScalar(Data, Done, m_NumPackets, Stride);
+  return m_NumPackets;
+}
+
+/**
+ * @brief Reference decoder - one packet per iteration
+ */
+void xTS_PacketBatch::xDecodeScalar(const uint8_t* Data, uint32_t Begin, uint32_t End, uint32_t Stride)
+{
+  for(uint32_t Idx = Begin; Idx < End; Idx++)
+  {
+    const uint8_t* Packet = Data + static_cast<size_t>(Idx) * Stride;
+    const uint8_t  AFC    = (Packet[3] & 0x30) >> 4;
+
+    uint32_t PayloadOffset = xTS::TS_PacketLength; // AFC = 0 (reserved) or 2 (adaptation field only)
+    if     (AFC == 1) PayloadOffset = xTS::TS_HeaderLength;
+    else if(AFC == 3) PayloadOffset = std::min<uint32_t>(xTS::TS_HeaderLength + 1 + Packet[4], xTS::TS_PacketLength);
+
+    const uint16_t PID  = static_cast<uint16_t>(((Packet[1] & 0x1F) << 8) | Packet[2]);
+    const bool     Sync = Packet[0] == 0x47;
+    const bool     Null = Sync && PID == static_cast<uint16_t>(xTS_PacketHeader::ePID::NuLL);
+
+    m_PID          [Idx] = PID;
+    m_Flags        [Idx] = static_cast<uint8_t>((Packet[1] & 0xE0) | (Sync ? FlagSyncValid : 0) | (Null ? FlagNull : 0));
+    m_TSC          [Idx] = (Packet[3] & 0xC0) >> 6;
+    m_AFC          [Idx] = AFC;
+    m_CC           [Idx] = Packet[3] & 0x0F;
+    m_PayloadOffset[Idx] = static_cast<uint8_t>(PayloadOffset);
+  }
+}
+
+#if X_ARCH_X86
+
+/** @brief Store the low byte of each 32-bit lane (8 bytes) */
+X_ATTR_TARGET("avx2")
+static inline void xStoreLowBytes(uint8_t* Dst, __m256i Value)
+{
+  const __m256i Shuffle = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i Packed  = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(Value, Shuffle), _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1));
+  _mm_storel_epi64(reinterpret_cast<__m128i*>(Dst), _mm256_castsi256_si128(Packed));
+}
+
+/** @brief Store the low 16 bits of each 32-bit lane (8 words) */
+X_ATTR_TARGET("avx2")
+static inline void xStoreLowWords(uint16_t* Dst, __m256i Value)
+{
+  const __m256i Shuffle = _mm256_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                           0, 1, 4, 5, 8, 9, 12, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+  const __m256i Packed  = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(Value, Shuffle), _mm256_setr_epi32(0, 1, 4, 5, 2, 2, 2, 2));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(Dst), _mm256_castsi256_si128(Packed));
+}
+
+/**
+ * @brief Gather kernel - 8 packets per iteration
+ *
+ * Each 32-bit lane holds the little endian header word of one packet:
+ * bits 0-7 sync byte, 8-15 E/S/P/PID[12:8], 16-23 PID[7:0], 24-31 TSC/AFC/CC.
+ */
+X_ATTR_TARGET("avx2")
+void xTS_PacketBatch::xDecodeAVX2(const uint8_t* Data, uint32_t NumPackets, uint32_t Stride)
+{
+  const __m256i Offsets     = _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(Stride)));
+  const __m256i ByteMask    = _mm256_set1_epi32(0xFF);
+  const __m256i SyncByte    = _mm256_set1_epi32(0x47);
+  const __m256i NoPayload   = _mm256_set1_epi32(xTS::TS_PacketLength);
+  const __m256i HeaderOnly  = _mm256_set1_epi32(xTS::TS_HeaderLength);
+  const __m256i HeaderAndAF = _mm256_set1_epi32(xTS::TS_HeaderLength + 1);
+  const __m256i AFC_Payload = _mm256_set1_epi32(1);
+  const __m256i AFC_Both    = _mm256_set1_epi32(3);
+  const __m256i NullPID     = _mm256_set1_epi32(static_cast<int>(xTS_PacketHeader::ePID::NuLL));
+
+  for(uint32_t Idx = 0; Idx < NumPackets; Idx += 8)
+  {
+    const uint8_t* Base   = Data + static_cast<size_t>(Idx) * Stride;
+    const __m256i  Header = _mm256_i32gather_epi32(reinterpret_cast<const int*>(Base    ), Offsets, 1);
+    const __m256i  AFLen  = _mm256_and_si256(_mm256_i32gather_epi32(reinterpret_cast<const int*>(Base + 4), Offsets, 1), ByteMask);
+
+    const __m256i Sync      = _mm256_cmpeq_epi32(_mm256_and_si256(Header, ByteMask), SyncByte);
+    const __m256i PID       = _mm256_or_si256(_mm256_and_si256(Header, _mm256_set1_epi32(0x1F00)),
+                                              _mm256_and_si256(_mm256_srli_epi32(Header, 16), ByteMask));
+    const __m256i Null      = _mm256_and_si256(Sync, _mm256_cmpeq_epi32(PID, NullPID));
+    const __m256i Flags     = _mm256_or_si256(_mm256_and_si256(_mm256_srli_epi32(Header, 8), _mm256_set1_epi32(0xE0)),
+                                              _mm256_or_si256(_mm256_and_si256(Sync, _mm256_set1_epi32(FlagSyncValid)),
+                                                              _mm256_and_si256(Null, _mm256_set1_epi32(FlagNull))));
+    const __m256i TSC       = _mm256_srli_epi32(Header, 30);
+    const __m256i AFC       = _mm256_and_si256(_mm256_srli_epi32(Header, 28), _mm256_set1_epi32(0x3));
+    const __m256i CC        = _mm256_and_si256(_mm256_srli_epi32(Header, 24), _mm256_set1_epi32(0xF));
+
+    // AFC = 1: payload follows header, AFC = 3: payload follows adaptation field, otherwise no payload
+    __m256i PayloadOffset = NoPayload;
+    PayloadOffset = _mm256_blendv_epi8(PayloadOffset, HeaderOnly, _mm256_cmpeq_epi32(AFC, AFC_Payload));
+    PayloadOffset = _mm256_blendv_epi8(PayloadOffset, _mm256_min_epi32(_mm256_add_epi32(AFLen, HeaderAndAF), NoPayload),
+                                       _mm256_cmpeq_epi32(AFC, AFC_Both));
+
+    xStoreLowWords(m_PID.data()           + Idx, PID);
+    xStoreLowBytes(m_Flags.data()         + Idx, Flags);
+    xStoreLowBytes(m_TSC.data()           + Idx, TSC);
+    xStoreLowBytes(m_AFC.data()           + Idx, AFC);
+    xStoreLowBytes(m_CC.data()            + Idx, CC);
+    xStoreLowBytes(m_PayloadOffset.data() + Idx, PayloadOffset);
+  }
+}
+
+#else //!X_ARCH_X86
+
+void xTS_PacketBatch::xDecodeAVX2(const uint8_t* Data, uint32_t NumPackets, uint32_t Stride)
+{
+  xDecodeScalar(Data, 0, NumPackets, Stride);
+}
+
+#endif //X_ARCH_X86
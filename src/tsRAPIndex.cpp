@@ -0,0 +1,261 @@
+/**
+ * @file tsRAPIndex.cpp
+ * @brief Implementation of the per-PID random access point index sidecar
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsRAPIndex.h"
+#include <algorithm>
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xTS_RAPIndexWriter Implementation
+//=============================================================================================================================================================================
+
+xTS_RAPIndexWriter::xTS_RAPIndexWriter()
+  : m_File(nullptr)
+  , m_FirstTime(xTS_RAPIndex::NoTimestamp)
+  , m_NumEntries(0)
+  , m_NumFlushed(0)
+  , m_NumBlocks(0)
+{
+}
+
+xTS_RAPIndexWriter::~xTS_RAPIndexWriter()
+{
+  Close();
+}
+
+bool xTS_RAPIndexWriter::Open(const char* FileName)
+{
+  Close();
+  m_File = std::fopen(FileName, "wb");
+  if(m_File == nullptr) return false;
+
+  m_Timeline.Reset();
+  m_FirstTime  = xTS_RAPIndex::NoTimestamp;
+  m_NumEntries = 0;
+  m_NumFlushed = 0;
+  m_NumBlocks  = 0;
+  m_PIDs.clear();
+  m_PIDs.resize(xTS_RAPIndex::NumPIDs, xPIDState{ {}, 0, xTS_RAPIndex::BlockEntries, 0, 0 });
+  return Flush();
+}
+
+bool xTS_RAPIndexWriter::Close()
+{
+  if(m_File == nullptr) return true;
+  bool Written = Flush();
+  Written = std::fclose(m_File) == 0 && Written;
+  m_File  = nullptr;
+  m_PIDs.clear();
+  return Written;
+}
+
+/**
+ * @brief Writes the new entries of every PID into its latest block (new blocks when full), then the file header
+ *
+ * Entries are written before the block header counting them and blocks before the file
+ * header, so a reader of the live file never sees unwritten entries.
+ */
+bool xTS_RAPIndexWriter::Flush()
+{
+  if(m_File == nullptr) return false;
+
+  bool Written = true;
+  for(uint32_t PID = 0; PID < m_PIDs.size() && Written; PID++)
+  {
+    xPIDState& State = m_PIDs[PID];
+    size_t Done = 0;
+    while(Written && Done < State.Pending.size())
+    {
+      if(State.BlockFill == xTS_RAPIndex::BlockEntries) { State.Block = m_NumBlocks++; State.BlockFill = 0; }
+      const size_t   NumNew = std::min<size_t>(xTS_RAPIndex::BlockEntries - State.BlockFill, State.Pending.size() - Done);
+      const uint64_t Offset = xTS_RAPIndex::getBlockOffset(State.Block);
+      Written = std::fseek(m_File, static_cast<long>(Offset + sizeof(xTS_RAPIndex::xBlockHeader) + State.BlockFill * sizeof(xTS_RAPIndex::xEntry)), SEEK_SET) == 0 &&
+                std::fwrite(State.Pending.data() + Done, sizeof(xTS_RAPIndex::xEntry), NumNew, m_File) == NumNew;
+      if(!Written) break;
+      State.BlockFill += static_cast<uint32_t>(NumNew);
+
+      const xTS_RAPIndex::xBlockHeader BlockHeader = { PID, State.BlockFill, 0 };
+      Written = std::fseek(m_File, static_cast<long>(Offset), SEEK_SET) == 0 && std::fwrite(&BlockHeader, sizeof(BlockHeader), 1, m_File) == 1;
+      State.NumEntries += NumNew;
+      m_NumFlushed     += NumNew;
+      Done             += NumNew;
+    }
+    State.Pending.erase(State.Pending.begin(), State.Pending.begin() + Done);
+  }
+
+  xTS_RAPIndex::xFileHeader Header;
+  memset(&Header, 0, sizeof(Header));
+  memcpy(Header.Magic, xTS_RAPIndex::Magic, sizeof(Header.Magic));
+  Header.Version      = xTS_RAPIndex::Version;
+  Header.EntrySize    = sizeof(xTS_RAPIndex::xEntry);
+  Header.BlockEntries = xTS_RAPIndex::BlockEntries;
+  Header.PCR_PID      = static_cast<uint32_t>(m_Timeline.getPID()); // 0xFFFFFFFF if no PCR was seen
+  Header.NumEntries   = m_NumFlushed;
+  Header.NumBlocks    = m_NumBlocks;
+
+  Written = Written && std::fseek(m_File, 0, SEEK_SET) == 0 && std::fwrite(&Header, sizeof(Header), 1, m_File) == 1;
+  return std::fflush(m_File) == 0 && Written;
+}
+
+void xTS_RAPIndexWriter::AddRAP(uint16_t PID, uint64_t Offset, uint64_t PTS, uint64_t DTS)
+{
+  if(m_File == nullptr) return;
+
+  xTS_RAPIndex::xEntry Entry;
+  Entry.Offset = Offset;
+  Entry.Time   = m_Timeline.hasPCR() ? m_Timeline.getTime() - m_FirstTime : 0;
+  Entry.PCR    = m_Timeline.hasPCR() ? m_Timeline.getLastPCR() : xTS_RAPIndex::NoTimestamp;
+  Entry.PTS    = PTS;
+  Entry.DTS    = DTS;
+
+  // A PCR step backwards (discontinuity) must not break the time order of the entries
+  xPIDState& State = m_PIDs[PID & (xTS_RAPIndex::NumPIDs - 1)];
+  if(Entry.Time < State.LastTime) Entry.Time = State.LastTime;
+  State.LastTime = Entry.Time;
+  State.Pending.push_back(Entry);
+  m_NumEntries++;
+}
+
+uint32_t xTS_RAPIndexWriter::getNumPIDs() const
+{
+  uint32_t NumPIDs = 0;
+  for(const xPIDState& State : m_PIDs) { NumPIDs += State.NumEntries || !State.Pending.empty(); }
+  return NumPIDs;
+}
+
+//=============================================================================================================================================================================
+// xTS_RAPIndexReader Implementation
+//=============================================================================================================================================================================
+
+xTS_RAPIndexReader::xTS_RAPIndexReader()
+  : m_NumEntries(0)
+{
+}
+
+bool xTS_RAPIndexReader::Open(const char* FileName)
+{
+  Close();
+  if(!m_File.Open(FileName, sizeof(xTS_RAPIndex::xFileHeader))) return false;
+
+  xTS_RAPIndex::xFileHeader Header;
+  memcpy(&Header, m_File.getData(), sizeof(Header));
+  const uint64_t FileSize = m_File.getSize();
+  bool Valid = memcmp(Header.Magic, xTS_RAPIndex::Magic, sizeof(Header.Magic)) == 0 &&
+               Header.Version      == xTS_RAPIndex::Version &&
+               Header.EntrySize    == sizeof(xTS_RAPIndex::xEntry) &&
+               Header.BlockEntries == xTS_RAPIndex::BlockEntries &&
+               Header.NumBlocks    <= (FileSize - sizeof(Header)) / sizeof(xTS_RAPIndex::xBlockHeader);
+  if(!Valid) { Close(); return false; }
+
+  // Blocks of every PID - the last block may lie partly beyond the end of the file, only its used slots must be within
+  std::vector<uint16_t> SlotIdx(xTS_RAPIndex::NumPIDs, 0); // PID -> index into m_PIDs + 1
+  uint64_t NumEntries = 0;
+  for(uint64_t BlockIdx = 0; BlockIdx < Header.NumBlocks && Valid; BlockIdx++)
+  {
+    const uint64_t Offset = xTS_RAPIndex::getBlockOffset(BlockIdx);
+    Valid = Offset + sizeof(xTS_RAPIndex::xBlockHeader) <= FileSize;
+    if(!Valid) break;
+    const xTS_RAPIndex::xBlockHeader* Block = reinterpret_cast<const xTS_RAPIndex::xBlockHeader*>(m_File.getData() + Offset);
+    Valid = Block->PID < xTS_RAPIndex::NumPIDs && Block->NumEntries <= xTS_RAPIndex::BlockEntries &&
+            Offset + sizeof(xTS_RAPIndex::xBlockHeader) + Block->NumEntries * sizeof(xTS_RAPIndex::xEntry) <= FileSize;
+    if(!Valid || Block->NumEntries == 0) continue; // allocated ahead of the header update
+    if(SlotIdx[Block->PID] == 0)
+    {
+      m_PIDs.push_back(xPIDEntry{ static_cast<uint16_t>(Block->PID), 0, {} });
+      SlotIdx[Block->PID] = static_cast<uint16_t>(m_PIDs.size());
+    }
+    xPIDEntry& PIDEntry = m_PIDs[SlotIdx[Block->PID] - 1];
+    PIDEntry.Blocks.push_back(Block);
+    PIDEntry.NumEntries += Block->NumEntries;
+    NumEntries          += Block->NumEntries;
+  }
+  if(!Valid) { Close(); return false; }
+
+  std::sort(m_PIDs.begin(), m_PIDs.end(), [](const xPIDEntry& A, const xPIDEntry& B) { return A.PID < B.PID; });
+  m_NumEntries = NumEntries;
+  return true;
+}
+
+void xTS_RAPIndexReader::Close()
+{
+  m_File.Close();
+  m_PIDs.clear();
+  m_NumEntries = 0;
+}
+
+int32_t xTS_RAPIndexReader::getMainPID() const
+{
+  int32_t  MainPID    = NOT_VALID;
+  uint64_t NumEntries = 0;
+  for(const xPIDEntry& PIDEntry : m_PIDs)
+  {
+    if(PIDEntry.NumEntries > NumEntries) { MainPID = PIDEntry.PID; NumEntries = PIDEntry.NumEntries; }
+  }
+  return MainPID;
+}
+
+/**
+ * @brief Last entry of a PID whose field (offset or time) is at or before Value
+ *
+ * The last block starting at or before Value holds the entry, as blocks follow each other
+ * in stream order.
+ */
+template<uint64_t xTS_RAPIndex::xEntry::*Field>
+static const xTS_RAPIndex::xEntry* FindLastAtOrBefore(const std::vector<const xTS_RAPIndex::xBlockHeader*>& Blocks, uint64_t Value)
+{
+  auto Entries = [](const xTS_RAPIndex::xBlockHeader* Block) { return reinterpret_cast<const xTS_RAPIndex::xEntry*>(Block + 1); };
+
+  size_t Low = 0, High = Blocks.size();
+  while(Low < High)
+  {
+    const size_t Mid = Low + (High - Low) / 2;
+    if(Entries(Blocks[Mid])[0].*Field <= Value) Low  = Mid + 1;
+    else                                        High = Mid;
+  }
+  if(Low == 0) return nullptr;
+
+  const xTS_RAPIndex::xBlockHeader* Block      = Blocks[Low - 1];
+  const xTS_RAPIndex::xEntry*       BlockEntries = Entries(Block);
+  Low  = 1; // the block's first entry is at or before Value
+  High = Block->NumEntries;
+  while(Low < High)
+  {
+    const size_t Mid = Low + (High - Low) / 2;
+    if(BlockEntries[Mid].*Field <= Value) Low  = Mid + 1;
+    else                                  High = Mid;
+  }
+  return &BlockEntries[Low - 1];
+}
+
+const xTS_RAPIndex::xEntry* xTS_RAPIndexReader::FindByOffset(uint16_t PID, uint64_t Offset) const
+{
+  const xPIDEntry* PIDEntry = xFindPID(PID);
+  if(PIDEntry == nullptr) return nullptr;
+  return FindLastAtOrBefore<&xTS_RAPIndex::xEntry::Offset>(PIDEntry->Blocks, Offset);
+}
+
+const xTS_RAPIndex::xEntry* xTS_RAPIndexReader::FindByTime(uint16_t PID, uint64_t Time) const
+{
+  const xPIDEntry* PIDEntry = xFindPID(PID);
+  if(PIDEntry == nullptr) return nullptr;
+  return FindLastAtOrBefore<&xTS_RAPIndex::xEntry::Time>(PIDEntry->Blocks, Time);
+}
+
+const xTS_RAPIndexReader::xPIDEntry* xTS_RAPIndexReader::xFindPID(uint16_t PID) const
+{
+  size_t Low = 0, High = m_PIDs.size();
+  while(Low < High)
+  {
+    const size_t Mid = Low + (High - Low) / 2;
+    if     (m_PIDs[Mid].PID < PID) Low  = Mid + 1;
+    else if(m_PIDs[Mid].PID > PID) High = Mid;
+    else                           return &m_PIDs[Mid];
+  }
+  return nullptr;
+}
@@ -0,0 +1,399 @@
+/**
+ * @file tsRecordFile.cpp
+ * @brief Implementation of binary per-packet analysis records
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsRecordFile.h"
+#include <cstddef>
+#include <cstdlib>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define TS_HAS_MMAP 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_PacketRecord Implementation
+//=============================================================================================================================================================================
+
+/**
+ * @brief Produces exactly the lines the parser writes in text mode
+ */
+void xTS_PacketRecord::Render(xTS_TextFormatter& Output) const
+{
+  switch(static_cast<eKind>(Kind))
+  {
+    case eKind::PacketError:
+      Output.Put("Error parsing packet ");
+      Output.PutInt(static_cast<int32_t>(Index));
+      Output.Put('\n');
+      return;
+
+    case eKind::SyncLoss:
+      Output.Put("Sync lost at byte ");    Output.PutUInt(PCR);
+      Output.Put(", re-locked at byte ");  Output.PutUInt(OPCR);
+      Output.Put(" (");                    Output.PutUInt(OPCR - PCR);
+      Output.Put(" bytes skipped)\n");
+      return;
+
+    case eKind::SyncLossFinal:
+      Output.Put("Sync lost at byte ");                Output.PutUInt(PCR);
+      Output.Put(", no re-lock until end of input ("); Output.PutUInt(OPCR - PCR);
+      Output.Put(" bytes skipped)\n");
+      return;
+
+    default:
+      break;
+  }
+
+  if(Flags & FlagAFError)
+  {
+    Output.Put("Error parsing adaptation field in packet ");
+    Output.PutInt(static_cast<int32_t>(Index));
+    Output.Put('\n');
+  }
+
+  // "%010d TS: SB=%02X E=%d S=%d P=%d PID=%4d TSC=%d AF=%d CC=%2d"
+  Output.PutUInt(Index, 10, '0');
+  Output.Put(" TS: SB=47");
+  Output.Put(" E=");   Output.PutUInt((Header & HeaderE) ? 1 : 0);
+  Output.Put(" S=");   Output.PutUInt((Header & HeaderS) ? 1 : 0);
+  Output.Put(" P=");   Output.PutUInt((Header & HeaderP) ? 1 : 0);
+  Output.Put(" PID="); Output.PutUInt(PID, 4, ' ');
+  Output.Put(" TSC="); Output.PutUInt(getTSC());
+  Output.Put(" AF=");  Output.PutUInt(getAFC());
+  Output.Put(" CC=");  Output.PutUInt(CC, 2, ' ');
+
+  if(Flags & FlagATS)
+  {
+    Output.Put(" ATS=");
+    Output.PutUInt(ATS);
+  }
+
+  if(hasAF())
+  {
+    // " AF: L=%d DC=%d RA=%d SP=%d PR=%d OR=%d SF=%d TP=%d EX=%d"
+    static const char* const FlagNames[8] = { " DC=", " RA=", " SP=", " PR=", " OR=", " SF=", " TP=", " EX=" };
+    Output.Put(" AF: L="); Output.PutUInt(AF_Length);
+    for(uint32_t Bit = 0; Bit < 8; Bit++)
+    {
+      Output.Put(FlagNames[Bit]);
+      Output.PutUInt((AF_Flags >> (7 - Bit)) & 1);
+    }
+
+    if(AF_Flags & 0x10)
+    {
+      Output.Put(" PCR_base="); Output.PutUInt(PCR >> 9);
+      Output.Put(" PCR_ext=");  Output.PutUInt(PCR & 0x1FF);
+      Output.Put(" PCR=");      Output.PutUInt((PCR >> 9) * 300 + (PCR & 0x1FF));
+    }
+    if(AF_Flags & 0x08)
+    {
+      Output.Put(" OPCR_base="); Output.PutUInt(OPCR >> 9);
+      Output.Put(" OPCR_ext=");  Output.PutUInt(OPCR & 0x1FF);
+      Output.Put(" OPCR=");      Output.PutUInt((OPCR >> 9) * 300 + (OPCR & 0x1FF));
+    }
+    Output.Put(" StuffingBytes=");
+    Output.PutInt(AF_Stuffing);
+  }
+
+  switch(static_cast<ePES_Event>(PES_Event))
+  {
+    case ePES_Event::Lost:
+      Output.Put(" PES: PacketLost");
+      break;
+
+    case ePES_Event::Started:
+      // Assembly starts only on a valid packet_start_code_prefix (0x000001)
+      Output.Put(" PES: Started PES: PSCP=1");
+      Output.Put(" SID="); Output.PutUInt(PES_StreamId);
+      Output.Put(" L=");   Output.PutUInt(PES_PacketLength);
+      if(Flags & FlagPTS) { Output.Put(" PTS="); Output.PutUInt(PES_PTS); }
+      if(Flags & FlagDTS) { Output.Put(" DTS="); Output.PutUInt(PES_DTS); }
+      break;
+
+    case ePES_Event::Continue:
+      Output.Put(" PES: Continue");
+      break;
+
+    case ePES_Event::Finished:
+      Output.Put(" PES: Finished Length=");
+      Output.PutInt(PES_Length);
+      if(PES_PacketLength > 0)
+      {
+        // Expected size: 6-byte header + PES_packet_length (stuffing bytes don't affect PES length)
+        const uint32_t ExpectedLength = PES_PacketLength + 6;
+        const uint32_t ActualLength   = static_cast<uint32_t>(PES_Length);
+        const int32_t  Difference     = std::abs(static_cast<int32_t>(ExpectedLength - ActualLength));
+
+        Output.Put(" StuffingBytes=");
+        Output.PutUInt(PES_Stuffing);
+        if     (Difference == 0) { Output.Put(" (Verified OK - exact match)"); }
+        else if(Difference <= 4) { Output.Put(" (Verified OK with tolerance)"); }
+        else
+        {
+          Output.Put(" (Length mismatch: expected="); Output.PutUInt(ExpectedLength);
+          Output.Put(", actual=");                    Output.PutUInt(ActualLength);
+          Output.Put(", diff=");                      Output.PutInt(Difference);
+          Output.Put(')');
+        }
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  Output.Put('\n');
+}
+
+//=============================================================================================================================================================================
+// xTS_RecordFile Implementation
+//=============================================================================================================================================================================
+
+constexpr char xTS_RecordFile::Magic[8];
+
+namespace {
+
+#define X_RECORD_COLUMN(Field) { #Field, sizeof(xTS_PacketRecord::Field), offsetof(xTS_PacketRecord, Field) }
+
+/** @brief Column table - one column per record field, block offsets computed once */
+struct xRecordLayout
+{
+  struct xEntry { const char* Name; uint32_t Size; uint32_t RecordOffset; };
+
+  static constexpr uint32_t NumColumns = 19;
+  xTS_RecordFile::xColumn Columns[NumColumns];
+  uint32_t                RecordOffsets[NumColumns];
+  uint32_t                BlockSize;
+  uint32_t                RecordSize;
+
+  xRecordLayout()
+  {
+    const xEntry Entries[NumColumns] =
+    {
+      X_RECORD_COLUMN(Index), X_RECORD_COLUMN(PID), X_RECORD_COLUMN(Kind), X_RECORD_COLUMN(Header), X_RECORD_COLUMN(CC),
+      X_RECORD_COLUMN(Flags), X_RECORD_COLUMN(AF_Length), X_RECORD_COLUMN(AF_Flags), X_RECORD_COLUMN(AF_Stuffing),
+      X_RECORD_COLUMN(PCR), X_RECORD_COLUMN(OPCR), X_RECORD_COLUMN(ATS), X_RECORD_COLUMN(PES_Event),
+      X_RECORD_COLUMN(PES_StreamId), X_RECORD_COLUMN(PES_PacketLength), X_RECORD_COLUMN(PES_PTS), X_RECORD_COLUMN(PES_DTS),
+      X_RECORD_COLUMN(PES_Length), X_RECORD_COLUMN(PES_Stuffing),
+    };
+
+    uint32_t Offset = xTS_RecordFile::BlockHeaderSize;
+    RecordSize      = 0;
+    for(uint32_t ColumnIdx = 0; ColumnIdx < NumColumns; ColumnIdx++)
+    {
+      xTS_RecordFile::xColumn& Column = Columns[ColumnIdx];
+      memset(&Column, 0, sizeof(Column));
+      strncpy(Column.Name, Entries[ColumnIdx].Name, sizeof(Column.Name) - 1);
+      Column.ElementSize       = Entries[ColumnIdx].Size;
+      Column.BlockOffset       = Offset;
+      RecordOffsets[ColumnIdx] = Entries[ColumnIdx].RecordOffset;
+      Offset     += (Column.ElementSize * xTS_RecordFile::BlockCapacity + 63) & ~63u;
+      RecordSize += Column.ElementSize;
+    }
+    BlockSize = (Offset + 4095) & ~4095u;
+  }
+};
+
+#undef X_RECORD_COLUMN
+
+static const xRecordLayout& xGetLayout()
+{
+  static const xRecordLayout Layout;
+  return Layout;
+}
+
+} //namespace
+
+uint32_t xTS_RecordFile::getNumColumns() { return xRecordLayout::NumColumns; }
+const xTS_RecordFile::xColumn& xTS_RecordFile::getColumn(uint32_t ColumnIdx) { return xGetLayout().Columns[ColumnIdx]; }
+uint32_t xTS_RecordFile::getRecordOffset(uint32_t ColumnIdx) { return xGetLayout().RecordOffsets[ColumnIdx]; }
+uint32_t xTS_RecordFile::getBlockSize() { return xGetLayout().BlockSize; }
+uint32_t xTS_RecordFile::getRecordSize() { return xGetLayout().RecordSize; }
+
+//=============================================================================================================================================================================
+// xTS_RecordWriter Implementation
+//=============================================================================================================================================================================
+
+xTS_RecordWriter::xTS_RecordWriter()
+  : m_NumRecords(0)
+  , m_NumWritten(0)
+{
+}
+
+xTS_RecordWriter::~xTS_RecordWriter()
+{
+  Close();
+}
+
+bool xTS_RecordWriter::Open(const char* FileName)
+{
+  if(!m_Output.Open(FileName)) return false;
+
+  // File header and column table
+  std::vector<uint8_t> FileHeader(xTS_RecordFile::FileHeaderSize, 0);
+  xTS_RecordFile::xFileHeader Header;
+  memset(&Header, 0, sizeof(Header));
+  memcpy(Header.Magic, xTS_RecordFile::Magic, sizeof(Header.Magic));
+  Header.Version       = xTS_RecordFile::Version;
+  Header.BlockCapacity = xTS_RecordFile::BlockCapacity;
+  Header.BlockSize     = xTS_RecordFile::getBlockSize();
+  Header.NumColumns    = xTS_RecordFile::getNumColumns();
+  Header.RecordSize    = xTS_RecordFile::getRecordSize();
+  memcpy(FileHeader.data(), &Header, sizeof(Header));
+  for(uint32_t ColumnIdx = 0; ColumnIdx < Header.NumColumns; ColumnIdx++)
+  {
+    memcpy(FileHeader.data() + sizeof(Header) + ColumnIdx * sizeof(xTS_RecordFile::xColumn), &xTS_RecordFile::getColumn(ColumnIdx), sizeof(xTS_RecordFile::xColumn));
+  }
+  m_Output.Put(reinterpret_cast<const char*>(FileHeader.data()), FileHeader.size());
+
+  m_Block.assign(xTS_RecordFile::getBlockSize(), 0);
+  m_NumRecords = 0;
+  m_NumWritten = 0;
+  return true;
+}
+
+bool xTS_RecordWriter::Close()
+{
+  if(!m_Output.isOpen()) return true;
+  if(m_NumRecords) xFlushBlock();
+  return m_Output.Close();
+}
+
+/**
+ * @brief Scatters record fields into the column arrays of the current block
+ */
+void xTS_RecordWriter::Append(const xTS_PacketRecord& Record)
+{
+  const uint8_t* Row = reinterpret_cast<const uint8_t*>(&Record);
+  for(uint32_t ColumnIdx = 0; ColumnIdx < xTS_RecordFile::getNumColumns(); ColumnIdx++)
+  {
+    const xTS_RecordFile::xColumn& Column = xTS_RecordFile::getColumn(ColumnIdx);
+    memcpy(m_Block.data() + Column.BlockOffset + (size_t)m_NumRecords * Column.ElementSize,
+           Row + xTS_RecordFile::getRecordOffset(ColumnIdx), Column.ElementSize);
+  }
+  if(++m_NumRecords == xTS_RecordFile::BlockCapacity) xFlushBlock();
+}
+
+void xTS_RecordWriter::xFlushBlock()
+{
+  xTS_RecordFile::xBlockHeader Header;
+  memset(&Header, 0, sizeof(Header));
+  Header.Magic       = xTS_RecordFile::BlockMagic;
+  Header.NumRecords  = m_NumRecords;
+  Header.FirstRecord = m_NumWritten;
+  memcpy(m_Block.data(), &Header, sizeof(Header));
+
+  m_Output.Put(reinterpret_cast<const char*>(m_Block.data()), m_Block.size());
+  m_NumWritten += m_NumRecords;
+  m_NumRecords  = 0;
+  memset(m_Block.data(), 0, m_Block.size()); // unused slots of the last block stay zero
+}
+
+//=============================================================================================================================================================================
+// xTS_RecordReader Implementation
+//=============================================================================================================================================================================
+
+xTS_RecordReader::xTS_RecordReader()
+  : m_Data(nullptr)
+  , m_Size(0)
+  , m_Mapped(false)
+  , m_NumBlocks(0)
+  , m_NumRecords(0)
+{
+}
+
+xTS_RecordReader::~xTS_RecordReader()
+{
+  Close();
+}
+
+bool xTS_RecordReader::Open(const char* FileName)
+{
+  Close();
+#if TS_HAS_MMAP
+  int FileDescriptor = ::open(FileName, O_RDONLY);
+  if(FileDescriptor < 0) return false;
+  struct stat Stat;
+  if(fstat(FileDescriptor, &Stat) != 0 || Stat.st_size < (off_t)xTS_RecordFile::FileHeaderSize)
+  {
+    ::close(FileDescriptor);
+    return false;
+  }
+  void* Mapping = mmap(nullptr, (size_t)Stat.st_size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+  ::close(FileDescriptor);
+  if(Mapping == MAP_FAILED) return false;
+  madvise(Mapping, (size_t)Stat.st_size, MADV_SEQUENTIAL);
+  m_Data   = static_cast<const uint8_t*>(Mapping);
+  m_Size   = (size_t)Stat.st_size;
+  m_Mapped = true;
+#else
+  std::FILE* File = std::fopen(FileName, "rb");
+  if(File == nullptr) return false;
+  uint8_t Chunk[65536];
+  size_t  Read;
+  while((Read = std::fread(Chunk, 1, sizeof(Chunk), File)) > 0) { m_Buffer.insert(m_Buffer.end(), Chunk, Chunk + Read); }
+  std::fclose(File);
+  m_Data = m_Buffer.data();
+  m_Size = m_Buffer.size();
+  if(m_Size < xTS_RecordFile::FileHeaderSize) { Close(); return false; }
+#endif
+
+  // Header and column table must match the layout compiled into this reader
+  xTS_RecordFile::xFileHeader Header;
+  memcpy(&Header, m_Data, sizeof(Header));
+  bool Valid = memcmp(Header.Magic, xTS_RecordFile::Magic, sizeof(Header.Magic)) == 0 &&
+               Header.Version       == xTS_RecordFile::Version &&
+               Header.BlockCapacity == xTS_RecordFile::BlockCapacity &&
+               Header.BlockSize     == xTS_RecordFile::getBlockSize() &&
+               Header.NumColumns    == xTS_RecordFile::getNumColumns() &&
+               (m_Size - xTS_RecordFile::FileHeaderSize) % Header.BlockSize == 0;
+  for(uint32_t ColumnIdx = 0; Valid && ColumnIdx < Header.NumColumns; ColumnIdx++)
+  {
+    Valid = memcmp(m_Data + sizeof(Header) + ColumnIdx * sizeof(xTS_RecordFile::xColumn), &xTS_RecordFile::getColumn(ColumnIdx), sizeof(xTS_RecordFile::xColumn)) == 0;
+  }
+  if(!Valid) { Close(); return false; }
+
+  m_NumBlocks  = static_cast<uint32_t>((m_Size - xTS_RecordFile::FileHeaderSize) / Header.BlockSize);
+  m_NumRecords = 0;
+  for(uint32_t BlockIdx = 0; BlockIdx < m_NumBlocks; BlockIdx++)
+  {
+    const xTS_RecordFile::xBlockHeader* Block = getBlockHeader(BlockIdx);
+    if(Block->Magic != xTS_RecordFile::BlockMagic || Block->NumRecords > xTS_RecordFile::BlockCapacity) { Close(); return false; }
+    m_NumRecords += Block->NumRecords;
+  }
+  return true;
+}
+
+void xTS_RecordReader::Close()
+{
+#if TS_HAS_MMAP
+  if(m_Mapped && m_Data) munmap(const_cast<uint8_t*>(m_Data), m_Size);
+#endif
+  m_Buffer.clear();
+  m_Data       = nullptr;
+  m_Size       = 0;
+  m_Mapped     = false;
+  m_NumBlocks  = 0;
+  m_NumRecords = 0;
+}
+
+void xTS_RecordReader::getRecord(uint32_t BlockIdx, uint32_t RecordIdx, xTS_PacketRecord& Record) const
+{
+  uint8_t* Row = reinterpret_cast<uint8_t*>(&Record);
+  for(uint32_t ColumnIdx = 0; ColumnIdx < xTS_RecordFile::getNumColumns(); ColumnIdx++)
+  {
+    const uint32_t ElementSize = xTS_RecordFile::getColumn(ColumnIdx).ElementSize;
+    memcpy(Row + xTS_RecordFile::getRecordOffset(ColumnIdx), getColumnData(BlockIdx, ColumnIdx) + (size_t)RecordIdx * ElementSize, ElementSize);
+  }
+}
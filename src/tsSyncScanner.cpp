@@ -0,0 +1,254 @@
+/**
+ * @file tsSyncScanner.cpp
+ * @brief Implementation of Transport Stream sync byte acquisition
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsSyncScanner.h"
+#include <algorithm>
+
+//=============================================================================================================================================================================
+// xTS_SyncScanner Implementation
+//=============================================================================================================================================================================
+
+xTS_SyncScanner::xTS_SyncScanner(uint32_t Stride, uint32_t NumConfirm, eKernel Kernel)
+  : m_Stride(Stride)
+  , m_NumConfirm(NumConfirm > 0 ? NumConfirm : 1)
+  , m_Kernel(Kernel)
+{
+  if(m_Kernel == eKernel::Auto)
+  {
+    m_Kernel = xCpuHasAVX2() ? eKernel::AVX2 : xCpuHasSSE2() ? eKernel::SSE2 : eKernel::Scalar;
+  }
+  else if((m_Kernel == eKernel::AVX2 && !xCpuHasAVX2()) || (m_Kernel == eKernel::SSE2 && !xCpuHasSSE2()))
+  {
+    m_Kernel = eKernel::Scalar;
+  }
+  Reset();
+}
+
+/**
+ * @brief Resets scanner to locked state and clears loss statistics
+ */
+void xTS_SyncScanner::Reset()
+{
+  m_Locked        = true;
+  m_LossBegin     = 0;
+  m_LossEnd       = 0;
+  m_NumSyncLosses = 0;
+  m_NumLostBytes  = 0;
+}
+
+void xTS_SyncScanner::Append(const xTS_SyncScanner& Following)
+{
+  m_Locked         = Following.m_Locked;
+  if(Following.m_NumSyncLosses)
+  {
+    m_LossBegin    = Following.m_LossBegin;
+    m_LossEnd      = Following.m_LossEnd;
+  }
+  m_NumSyncLosses += Following.m_NumSyncLosses;
+  m_NumLostBytes  += Following.m_NumLostBytes;
+}
+
+const char* xTS_SyncScanner::getKernelName() const
+{
+  switch(m_Kernel)
+  {
+    case eKernel::AVX2: return "AVX2";
+    case eKernel::SSE2: return "SSE2";
+    default:            return "scalar";
+  }
+}
+
+/**
+ * @brief Searches for a new lock position after sync loss
+ *
+ * Candidates confirmed by all NumConfirm sync bytes are searched with the SIMD kernel.
+ * At the end of input the last few candidates cannot be fully confirmed; they are
+ * accepted when every complete packet that follows them starts with a sync byte.
+ *
+ * @param Data       Remaining input bytes (Data[0] is not a sync byte of an aligned packet)
+ * @param Size       Number of bytes at Data
+ * @param Position   Absolute stream offset of Data
+ * @param EndOfInput True if no more data follows
+ * @return Number of bytes to skip (see header for interpretation)
+ */
+size_t xTS_SyncScanner::Resync(const uint8_t* Data, size_t Size, uint64_t Position, bool EndOfInput)
+{
+  if(m_Locked)
+  {
+    m_Locked    = false;
+    m_LossBegin = Position;
+    m_NumSyncLosses++;
+  }
+
+  const size_t ConfirmSpan = static_cast<size_t>(m_NumConfirm - 1) * m_Stride;
+  const size_t Limit       = Size > ConfirmSpan ? Size - ConfirmSpan : 0;
+
+  int64_t Lock = FindLock(Data, Size);
+
+  if(Lock == NOT_VALID && EndOfInput)
+  {
+    // Partial confirmation - only complete packets remaining in the input are checked
+    for(size_t Candidate = Limit; Candidate + m_Stride <= Size && Lock == NOT_VALID; Candidate++)
+    {
+      bool Confirmed = true;
+      for(size_t Probe = Candidate; Probe + m_Stride <= Size && Confirmed; Probe += m_Stride)
+      {
+        Confirmed = Data[Probe] == SyncByte;
+      }
+      if(Confirmed) Lock = static_cast<int64_t>(Candidate);
+    }
+  }
+
+  if(Lock != NOT_VALID)
+  {
+    m_Locked        = true;
+    m_LossEnd       = Position + static_cast<uint64_t>(Lock);
+    m_NumLostBytes += static_cast<uint64_t>(Lock);
+    return static_cast<size_t>(Lock);
+  }
+
+  // Every candidate below Limit (or everything at end of input) is proven not to be a lock position
+  size_t Skipped  = EndOfInput ? Size : Limit;
+  m_LossEnd       = Position + Skipped;
+  m_NumLostBytes += Skipped;
+  return Skipped;
+}
+
+/**
+ * @brief Finds the first offset confirmed by NumConfirm sync bytes at Stride
+ * @return Offset of the lock candidate or NOT_VALID
+ */
+int64_t xTS_SyncScanner::FindLock(const uint8_t* Data, size_t Size) const
+{
+  const size_t ConfirmSpan = static_cast<size_t>(m_NumConfirm - 1) * m_Stride;
+  if(Size <= ConfirmSpan) return NOT_VALID;
+  const size_t Limit = Size - ConfirmSpan;
+
+  size_t Lock;
+  switch(m_Kernel)
+  {
+    case eKernel::AVX2: Lock = xFindLockAVX2  (Data, Limit, m_Stride, m_NumConfirm); break;
+    case eKernel::SSE2: Lock = xFindLockSSE2  (Data, Limit, m_Stride, m_NumConfirm); break;
+    default:            Lock = xFindLockScalar(Data, Limit, m_Stride, m_NumConfirm); break;
+  }
+  return Lock < Limit ? static_cast<int64_t>(Lock) : NOT_VALID;
+}
+
+/**
+ * @brief Detects packet layout by locking with every supported stride
+ *
+ * Up to ProbeConfirm packets are required for lock, fewer when the input is short.
+ * A false lock at a foreign stride would need that many 0x47 bytes at exactly the
+ * wrong distance, which does not happen in practice.
+ *
+ * @return Detected layout, TS188 when no layout locks
+ */
+xTS_PacketFormat xTS_SyncScanner::ProbeFormat(const uint8_t* Data, size_t Size)
+{
+  static constexpr uint32_t ProbeConfirm = 8;
+  static const xTS_PacketFormat::eFormat Formats[] =
+  {
+    xTS_PacketFormat::eFormat::TS188, xTS_PacketFormat::eFormat::M2TS192, xTS_PacketFormat::eFormat::RS204
+  };
+
+  xTS_PacketFormat Best;
+  size_t BestStart = SIZE_MAX;
+  for(xTS_PacketFormat::eFormat Format : Formats)
+  {
+    const xTS_PacketFormat Candidate(Format);
+    const uint32_t Stride = Candidate.getStride();
+    const uint32_t Prefix = Candidate.getPrefixLength();
+    if(Size < Prefix + 2 * Stride) continue;
+
+    const uint32_t NumConfirm = std::min<uint32_t>(ProbeConfirm, static_cast<uint32_t>((Size - Prefix) / Stride));
+    xTS_SyncScanner Scanner(Stride, NumConfirm);
+    int64_t Lock = Scanner.FindLock(Data + Prefix, Size - Prefix);
+    if(Lock == NOT_VALID) continue;
+
+    // Position of the first complete source packet
+    if(static_cast<size_t>(Lock) < BestStart)
+    {
+      BestStart = static_cast<size_t>(Lock);
+      Best      = Candidate;
+    }
+  }
+  return Best;
+}
+
+//=============================================================================================================================================================================
+// Search kernels - return first candidate below Limit confirmed by all probes, or Limit
+//=============================================================================================================================================================================
+
+size_t xTS_SyncScanner::xFindLockScalar(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm)
+{
+  for(size_t Candidate = 0; Candidate < Limit; Candidate++)
+  {
+    if(Data[Candidate] != SyncByte) continue;
+    uint32_t Probe = 1;
+    while(Probe < NumConfirm && Data[Candidate + Probe * Stride] == SyncByte) { Probe++; }
+    if(Probe == NumConfirm) return Candidate;
+  }
+  return Limit;
+}
+
+#if X_ARCH_X86
+
+X_ATTR_TARGET("sse2")
+size_t xTS_SyncScanner::xFindLockSSE2(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm)
+{
+  const __m128i Sync = _mm_set1_epi8(static_cast<char>(SyncByte));
+  size_t Candidate = 0;
+  for(; Candidate + 16 <= Limit; Candidate += 16)
+  {
+    const uint8_t* Base = Data + Candidate;
+    uint32_t Mask = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(Base)), Sync)));
+    for(uint32_t Probe = 1; Probe < NumConfirm && Mask; Probe++)
+    {
+      const __m128i Bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Base + static_cast<size_t>(Probe) * Stride));
+      Mask &= static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(Bytes, Sync)));
+    }
+    if(Mask) return Candidate + xCountTrailingZeros32(Mask);
+  }
+  size_t Tail = xFindLockScalar(Data + Candidate, Limit - Candidate, Stride, NumConfirm);
+  return Candidate + Tail;
+}
+
+X_ATTR_TARGET("avx2")
+size_t xTS_SyncScanner::xFindLockAVX2(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm)
+{
+  const __m256i Sync = _mm256_set1_epi8(static_cast<char>(SyncByte));
+  size_t Candidate = 0;
+  for(; Candidate + 32 <= Limit; Candidate += 32)
+  {
+    const uint8_t* Base = Data + Candidate;
+    uint32_t Mask = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(Base)), Sync)));
+    for(uint32_t Probe = 1; Probe < NumConfirm && Mask; Probe++)
+    {
+      const __m256i Bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(Base + static_cast<size_t>(Probe) * Stride));
+      Mask &= static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(Bytes, Sync)));
+    }
+    if(Mask) return Candidate + xCountTrailingZeros32(Mask);
+  }
+  size_t Tail = xFindLockSSE2(Data + Candidate, Limit - Candidate, Stride, NumConfirm);
+  return Candidate + Tail;
+}
+
+#else //!X_ARCH_X86
+
+size_t xTS_SyncScanner::xFindLockSSE2(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm)
+{
+  return xFindLockScalar(Data, Limit, Stride, NumConfirm);
+}
+
+size_t xTS_SyncScanner::xFindLockAVX2(const uint8_t* Data, size_t Limit, uint32_t Stride, uint32_t NumConfirm)
+{
+  return xFindLockScalar(Data, Limit, Stride, NumConfirm);
+}
+
+#endif //X_ARCH_X86
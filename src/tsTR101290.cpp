@@ -0,0 +1,522 @@
+/**
+ * @file tsTR101290.cpp
+ * @brief Implementation of the ETSI TR 101 290 measurement engine
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsTR101290.h"
+#include "../include/tsTimeIndex.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xTS_TR101290 Implementation
+//=============================================================================================================================================================================
+
+namespace
+{
+  struct xIndicatorInfo
+  {
+    const char* Number;
+    const char* Name;
+    uint32_t    Priority;
+  };
+
+  const xIndicatorInfo IndicatorInfo[xTS_TR101290::NumIndicators] =
+  {
+    { "1.1" , "TS_sync_loss"                      , 1 },
+    { "1.2" , "Sync_byte_error"                   , 1 },
+    { "1.3" , "PAT_error"                         , 1 },
+    { "1.4" , "Continuity_count_error"            , 1 },
+    { "1.5" , "PMT_error"                         , 1 },
+    { "1.6" , "PID_error"                         , 1 },
+    { "2.1" , "Transport_error"                   , 2 },
+    { "2.2" , "CRC_error"                         , 2 },
+    { "2.3a", "PCR_repetition_error"              , 2 },
+    { "2.3b", "PCR_discontinuity_indicator_error" , 2 },
+    { "2.4" , "PCR_accuracy_error"                , 2 },
+    { "2.5" , "PTS_error"                         , 2 },
+    { "2.6" , "CAT_error"                         , 2 },
+    { "3.1" , "NIT_error"                         , 3 },
+    { "3.4" , "Unreferenced_PID"                  , 3 },
+    { "3.5" , "SDT_error"                         , 3 },
+    { "3.6" , "EIT_error"                         , 3 },
+    { "3.7" , "RST_error"                         , 3 },
+    { "3.8" , "TDT_error"                         , 3 },
+  };
+
+  // DVB SI PIDs (EN 300 468)
+  constexpr uint16_t CAT_PID = 0x0001;
+  constexpr uint16_t NIT_PID = 0x0010;
+  constexpr uint16_t SDT_PID = 0x0011;
+  constexpr uint16_t EIT_PID = 0x0012;
+  constexpr uint16_t RST_PID = 0x0013;
+  constexpr uint16_t TDT_PID = 0x0014;
+
+  /** @brief Forward distance between two PCR values (modulo the PCR range) */
+  inline uint64_t PCRDelta(uint64_t From, uint64_t To)
+  {
+    return To >= From ? To - From : To + xTS_TimeIndex::PCR_Range - From;
+  }
+}
+
+const char* xTS_TR101290::getName(eIndicator Indicator)
+{
+  return IndicatorInfo[static_cast<uint32_t>(Indicator)].Name;
+}
+
+const char* xTS_TR101290::getNumber(eIndicator Indicator)
+{
+  return IndicatorInfo[static_cast<uint32_t>(Indicator)].Number;
+}
+
+uint32_t xTS_TR101290::getPriority(eIndicator Indicator)
+{
+  return IndicatorInfo[static_cast<uint32_t>(Indicator)].Priority;
+}
+
+//=============================================================================================================================================================================
+// xTS_TR101290Monitor Implementation
+//=============================================================================================================================================================================
+
+xTS_TR101290Monitor::xTS_TR101290Monitor()
+  : m_File(nullptr)
+  , m_Window(0)
+  , m_Stride(xTS::TS_PacketLength)
+{
+  m_Slots.reserve(NumPIDs); // slots never move - section callbacks add slots while a slot is being processed
+  Open(nullptr);
+}
+
+xTS_TR101290Monitor::~xTS_TR101290Monitor()
+{
+  Close();
+}
+
+bool xTS_TR101290Monitor::Open(const char* FileName, uint32_t Window)
+{
+  Close();
+  if(FileName != nullptr)
+  {
+    m_File = std::fopen(FileName, "w");
+    if(m_File == nullptr) return false;
+  }
+
+  m_Window = xTicks(Window ? Window : xTS_TR101290::DefaultWindow);
+  memset(m_CC,      0, sizeof(m_CC));
+  memset(m_SlotIdx, 0, sizeof(m_SlotIdx));
+  m_Slots.clear();
+  m_HasCAT          = false;
+  m_CATReported     = false;
+  m_BadSyncRun      = 0;
+  m_RefPID          = NOT_VALID;
+  m_RefPCR          = 0;
+  m_RefOffset       = 0;
+  m_RefTime         = 0;
+  m_TicksPerByte    = 0;
+  m_Now             = 0;
+  m_NextCheck       = 0;
+  m_NextCheckOffset = UINT64_MAX;
+  m_WindowStart     = 0;
+  m_NumWindows      = 0;
+  m_NumPackets      = 0;
+  memset(m_Total,  0, sizeof(m_Total));
+  memset(m_Counts, 0, sizeof(m_Counts));
+
+  // PAT is expected from the start, SI PIDs are followed as soon as they appear
+  xAddSlot(0);
+
+  if(m_File == nullptr) return true;
+  std::fprintf(m_File, "# TR 101 290 indicators per %" PRIu64 " ms window (time: window start [s] since the monitor clock started)\n# time",
+               m_Window * 1000 / xTS::ExtendedClockFrequency_Hz);
+  for(uint32_t Idx = 0; Idx < xTS_TR101290::NumIndicators; Idx++)
+  {
+    std::fprintf(m_File, " %s", xTS_TR101290::getName(static_cast<eIndicator>(Idx)));
+  }
+  std::fprintf(m_File, "\n");
+  return true;
+}
+
+bool xTS_TR101290Monitor::Close()
+{
+  if(m_File == nullptr) return true;
+  if(m_NumPackets) xWriteWindow(); // window in progress
+  bool Written = std::ferror(m_File) == 0;
+  Written = std::fclose(m_File) == 0 && Written;
+  m_File  = nullptr;
+  return Written;
+}
+
+//=============================================================================================================================================================================
+
+void xTS_TR101290Monitor::xArm(xTimer& Timer, uint32_t Limit)
+{
+  Timer.Limit    = xTicks(Limit);
+  Timer.Last     = xIsRunning() ? m_Now : NotArmed;
+  Timer.Reported = false;
+}
+
+void xTS_TR101290Monitor::xHit(xTimer& Timer, eIndicator Indicator)
+{
+  if(!xIsRunning() || Timer.Last == NotArmed) return;
+  if(!Timer.Reported && m_Now - Timer.Last > Timer.Limit) xCount(Indicator);
+  Timer.Last     = m_Now;
+  Timer.Reported = false;
+}
+
+void xTS_TR101290Monitor::xCheck(xTimer& Timer, eIndicator Indicator)
+{
+  if(Timer.Last == NotArmed || Timer.Reported || m_Now - Timer.Last <= Timer.Limit) return;
+  xCount(Indicator);
+  Timer.Reported = true;
+}
+
+/**
+ * @brief Creates the state of a newly seen PID; PSI/SI PIDs get a section assembler
+ */
+uint16_t xTS_TR101290Monitor::xAddSlot(uint16_t PID)
+{
+  m_Slots.emplace_back();
+  xPIDSlot& Slot = m_Slots.back();
+  Slot.PID = PID;
+  m_SlotIdx[PID] = static_cast<uint16_t>(m_Slots.size());
+
+  uint32_t Limit = 0;
+  switch(PID)
+  {
+    case 0      : Slot.SectionIndicator = eIndicator::PAT; Limit = xTS_TR101290::PAT_Interval; break;
+    case NIT_PID: Slot.SectionIndicator = eIndicator::NIT; Limit = xTS_TR101290::NIT_Interval; break;
+    case SDT_PID: Slot.SectionIndicator = eIndicator::SDT; Limit = xTS_TR101290::SDT_Interval; break;
+    case EIT_PID: Slot.SectionIndicator = eIndicator::EIT; Limit = xTS_TR101290::EIT_Interval; break;
+    case TDT_PID: Slot.SectionIndicator = eIndicator::TDT; Limit = xTS_TR101290::TDT_Interval; break;
+    case CAT_PID: case RST_PID: break;
+    default     : return m_SlotIdx[PID];
+  }
+  Slot.Section.Limit = xTicks(Limit);
+  Slot.Assembler.reset(new xPSI_SectionAssembler());
+  Slot.Assembler->Init(PID);
+  Slot.Assembler->setCallback([this](int32_t SectionPID, const uint8_t* Section, uint32_t Size) { return xOnSection(SectionPID, Section, Size); });
+  return m_SlotIdx[PID];
+}
+
+/**
+ * @brief Sync loss records (scanner re-lock or end of input) and packets without sync byte (--no-resync)
+ *
+ * 1.2 counts every packet slot whose sync byte is not 0x47: each slot of a skipped byte
+ * range, or each packet without sync byte. 1.1 applies the loss of sync hysteresis of
+ * TR 101 290 - two or more consecutive corrupted sync bytes.
+ */
+void xTS_TR101290Monitor::xAddEvent(const xTS_PacketRecord& Record)
+{
+  if(Record.Kind == static_cast<uint8_t>(xTS_PacketRecord::eKind::PacketError))
+  {
+    xCount(eIndicator::SyncByte);
+    if(++m_BadSyncRun == 2) xCount(eIndicator::TS_SyncLoss);
+    return;
+  }
+
+  // Skipped byte range [PCR, OPCR) - at least the slot where the sync byte was expected
+  const uint64_t Lost  = Record.OPCR > Record.PCR ? Record.OPCR - Record.PCR : 0;
+  const uint64_t Slots = std::max<uint64_t>(1, (Lost + m_Stride - 1) / m_Stride);
+  xCount(eIndicator::SyncByte, static_cast<uint32_t>(std::min<uint64_t>(Slots, UINT32_MAX)));
+  if(Slots >= 2) xCount(eIndicator::TS_SyncLoss);
+}
+
+/**
+ * @brief 1.4 - packets with payload increment the counter, one duplicate is allowed, packets without payload repeat it
+ */
+void xTS_TR101290Monitor::xCheckContinuity(const xTS_PacketRecord& Record)
+{
+  constexpr uint8_t Valid = 0x80, Duplicate = 0x40;
+  uint8_t&      State         = m_CC[Record.PID];
+  const uint8_t CC            = Record.CC;
+  const bool    Discontinuity = Record.hasAF() && (Record.AF_Flags & 0x80);
+  if((State & Valid) && !Discontinuity)
+  {
+    const uint8_t Last = State & 0x0F;
+    if(Record.getAFC() & 0x1)
+    {
+      if(CC == Last)
+      {
+        if(State & Duplicate) xCount(eIndicator::ContinuityCount);
+        State |= Duplicate;
+        return;
+      }
+      if(CC != ((Last + 1) & 0x0F)) xCount(eIndicator::ContinuityCount);
+    }
+    else if(CC != Last)
+    {
+      xCount(eIndicator::ContinuityCount);
+    }
+  }
+  State = Valid | CC;
+}
+
+/**
+ * @brief 2.3a/2.3b/2.4 per PCR PID, then advances the monitor clock on the reference PID
+ *
+ * PCR accuracy compares the PCR with the value extrapolated from the previous PCR at the
+ * byte rate of the previous PCR interval (constant rate between PCRs).
+ */
+void xTS_TR101290Monitor::xAddPCR(xPIDSlot& Slot, const xTS_PacketRecord& Record, uint64_t Offset)
+{
+  const uint64_t PCR           = Record.getPCR();
+  const bool     Discontinuity = (Record.AF_Flags & 0x80) != 0;
+  const uint64_t Delta         = Slot.LastPCR != NotArmed ? PCRDelta(Slot.LastPCR, PCR) : 0;
+  const bool     Continuous    = Slot.LastPCR != NotArmed && !Discontinuity && Delta > 0 && Delta <= xTicks(xTS_TR101290::PCR_DiscontinuityLimit);
+
+  if(Slot.LastPCR != NotArmed && !Discontinuity && !Continuous) xCount(eIndicator::PCR_Discontinuity);
+  if(Continuous)
+  {
+    if(Delta > xTicks(xTS_TR101290::PCR_Interval) && !Slot.PCR.Reported) xCount(eIndicator::PCR_Repetition);
+    const uint64_t Bytes = Offset - Slot.LastPCROffset;
+    if(Slot.PCRTicksPerByte > 0 &&
+       std::fabs(static_cast<double>(Delta) - static_cast<double>(Bytes) * Slot.PCRTicksPerByte) > xTS_TR101290::PCR_AccuracyLimit * 27.0 / 1000.0)
+    {
+      xCount(eIndicator::PCR_Accuracy);
+    }
+    Slot.PCRTicksPerByte = Bytes ? static_cast<double>(Delta) / static_cast<double>(Bytes) : 0;
+  }
+  else
+  {
+    Slot.PCRTicksPerByte = 0;
+  }
+  Slot.LastPCR       = PCR;
+  Slot.LastPCROffset = Offset;
+
+  // Monitor clock - follows the first PID carrying PCRs
+  if(m_RefPID == NOT_VALID) m_RefPID = Record.PID;
+  if(m_RefPID == Record.PID)
+  {
+    const bool Started = xIsRunning();
+    if(Continuous && Offset > m_RefOffset)
+    {
+      m_TicksPerByte = static_cast<double>(Delta) / static_cast<double>(Offset - m_RefOffset);
+      m_RefTime     += Delta;
+    }
+    else
+    {
+      m_RefTime = m_Now; // discontinuity - the clock continues from the interpolated time
+    }
+    m_RefPCR    = PCR;
+    m_RefOffset = Offset;
+    if(m_RefTime > m_Now) m_Now = m_RefTime;
+    if(!Started && xIsRunning()) xStartClock();
+    else if(xIsRunning())        m_NextCheckOffset = m_RefOffset + static_cast<uint64_t>(static_cast<double>(m_NextCheck > m_RefTime ? m_NextCheck - m_RefTime : 0) / m_TicksPerByte);
+  }
+
+  if(Slot.PCR.Last == NotArmed) xArm(Slot.PCR, xTS_TR101290::PCR_Interval);
+  else                          { Slot.PCR.Last = m_Now; Slot.PCR.Reported = false; }
+}
+
+/**
+ * @brief Arms the timers of everything known when the monitor clock starts
+ */
+void xTS_TR101290Monitor::xStartClock()
+{
+  m_WindowStart = m_Now;
+  m_NextCheck   = m_Now;
+  m_NextCheckOffset = m_RefOffset;
+  for(xPIDSlot& Slot : m_Slots)
+  {
+    if(Slot.PID == 0)            xArm(Slot.Section, xTS_TR101290::PAT_Interval);
+    if(Slot.PMT)                 xArm(Slot.Section, xTS_TR101290::PMT_Interval);
+    if(Slot.ES && Slot.RefCount) xArm(Slot.Occurrence, xTS_TR101290::PID_Interval);
+    if(Slot.PCR.Limit)           xArm(Slot.PCR, xTS_TR101290::PCR_Interval);
+  }
+}
+
+/**
+ * @brief Scrambling, PID occurrence, PTS repetition and section assembly of PSI/SI PIDs
+ */
+void xTS_TR101290Monitor::xAddPacket(xPIDSlot& Slot, const xTS_PacketRecord& Record, const uint8_t* Packet)
+{
+  if(Record.getTSC())
+  {
+    if(Slot.PID == 0) xCount(eIndicator::PAT);
+    if(Slot.PMT)      xCount(eIndicator::PMT);
+    if(!m_HasCAT && !m_CATReported) { xCount(eIndicator::CAT); m_CATReported = true; }
+  }
+  xHit(Slot.Occurrence, eIndicator::PID);
+
+  // 2.5 - PES packets starting in the packet with PTS_DTS_flags set
+  const bool     Payload       = (Record.getAFC() & 0x1) != 0;
+  const uint32_t PayloadOffset = xTS::TS_HeaderLength + (Record.hasAF() ? Record.AF_Length + 1 : 0);
+  if(Slot.ES && Payload && (Record.Header & xTS_PacketRecord::HeaderS) && !Record.getTSC() &&
+     PayloadOffset + 8 <= xTS::TS_PacketLength)
+  {
+    const uint8_t* PES = Packet + PayloadOffset;
+    if(PES[0] == 0 && PES[1] == 0 && PES[2] == 1 && (PES[6] & 0xC0) == 0x80 && (PES[7] & 0x80))
+    {
+      if(Slot.PTS.Last == NotArmed) xArm(Slot.PTS, xTS_TR101290::PTS_Interval);
+      else                          xHit(Slot.PTS, eIndicator::PTS);
+    }
+  }
+
+  if(!Slot.Assembler || !Payload) return;
+  m_Header.Parse(Packet);
+  m_AdaptationField.Reset();
+  if(m_Header.hasAdaptationField()) m_AdaptationField.Parse(Packet + xTS::TS_HeaderLength, m_Header.getAdaptationFieldControl());
+  const uint64_t NumCRCErrors = Slot.Assembler->getNumCRCErrors();
+  Slot.Assembler->AbsorbPacket(Packet, &m_Header, &m_AdaptationField);
+  if(Slot.Assembler->getNumCRCErrors() != NumCRCErrors) xCount(eIndicator::CRC);
+}
+
+/**
+ * @brief Complete, CRC checked section of a PSI/SI PID - table_id checks, repetition timers, PAT/PMT references
+ * @return False, so every repetition is assembled and CRC checked again
+ */
+bool xTS_TR101290Monitor::xOnSection(int32_t PID, const uint8_t* Section, uint32_t Size)
+{
+  xPIDSlot&     Slot    = m_Slots[m_SlotIdx[PID] - 1];
+  const uint8_t TableId = Section[0];
+  switch(PID)
+  {
+    case 0:
+      if(TableId != static_cast<uint8_t>(xPSI_SectionHeader::eTableId::PAT)) { xCount(eIndicator::PAT); return false; }
+      xHit(Slot.Section, eIndicator::PAT);
+      break;
+    case CAT_PID:
+      if(TableId != static_cast<uint8_t>(xPSI_SectionHeader::eTableId::CAT)) { xCount(eIndicator::CAT); return false; }
+      m_HasCAT = true; m_CATReported = false;
+      return false;
+    case NIT_PID:
+      if(TableId == 0x40)                           { if(Slot.Section.Last == NotArmed) xArm(Slot.Section, xTS_TR101290::NIT_Interval); else xHit(Slot.Section, eIndicator::NIT); }
+      else if(TableId != 0x41 && TableId != 0x72)   xCount(eIndicator::NIT);
+      return false;
+    case SDT_PID:
+      if(TableId == 0x42)                           { if(Slot.Section.Last == NotArmed) xArm(Slot.Section, xTS_TR101290::SDT_Interval); else xHit(Slot.Section, eIndicator::SDT); }
+      else if(TableId != 0x46 && TableId != 0x4A && TableId != 0x72) xCount(eIndicator::SDT);
+      return false;
+    case EIT_PID:
+      if(TableId == 0x4E)                           { if(Slot.Section.Last == NotArmed) xArm(Slot.Section, xTS_TR101290::EIT_Interval); else xHit(Slot.Section, eIndicator::EIT); }
+      else if((TableId < 0x4F || TableId > 0x6F) && TableId != 0x72) xCount(eIndicator::EIT);
+      return false;
+    case RST_PID:
+      if(TableId != 0x71 && TableId != 0x72)        xCount(eIndicator::RST);
+      return false;
+    case TDT_PID:
+      if(TableId == 0x70)                           { if(Slot.Section.Last == NotArmed) xArm(Slot.Section, xTS_TR101290::TDT_Interval); else xHit(Slot.Section, eIndicator::TDT); }
+      else if(TableId != 0x72 && TableId != 0x73)   xCount(eIndicator::TDT);
+      return false;
+    default:
+      if(!Slot.PMT || TableId != static_cast<uint8_t>(xPSI_SectionHeader::eTableId::PMT)) return false;
+      xHit(Slot.Section, eIndicator::PMT);
+      break;
+  }
+
+  // PAT or PMT - references are updated when the section changes
+  if(Slot.LastTable.size() == Size && memcmp(Slot.LastTable.data(), Section, Size) == 0) return false;
+  Slot.LastTable.assign(Section, Section + Size);
+  std::vector<uint16_t> Listed;
+  if(PID == 0)
+  {
+    xPSI_PAT PAT;
+    if(PAT.Parse(Section, Size) == NOT_VALID) return false;
+    for(const xPSI_PAT::xProgram& Program : PAT.getPrograms())
+    {
+      Listed.push_back(Program.PID);
+      if(Program.ProgramNumber == 0) continue; // network PID
+      uint16_t SlotIdx = m_SlotIdx[Program.PID];
+      if(SlotIdx == 0) SlotIdx = xAddSlot(Program.PID);
+      xPIDSlot& PMT_Slot = m_Slots[SlotIdx - 1];
+      if(PMT_Slot.PMT) continue;
+      PMT_Slot.PMT              = true;
+      PMT_Slot.SectionIndicator = eIndicator::PMT;
+      xArm(PMT_Slot.Section, xTS_TR101290::PMT_Interval);
+      if(!PMT_Slot.Assembler)
+      {
+        PMT_Slot.Assembler.reset(new xPSI_SectionAssembler());
+        PMT_Slot.Assembler->Init(Program.PID);
+        PMT_Slot.Assembler->setCallback([this](int32_t SectionPID, const uint8_t* Data, uint32_t DataSize) { return xOnSection(SectionPID, Data, DataSize); });
+      }
+    }
+  }
+  else
+  {
+    xPSI_PMT PMT;
+    if(PMT.Parse(Section, Size) == NOT_VALID) return false;
+    Listed.push_back(PMT.getPCR_PID());
+    for(const xPSI_PMT::xStream& Stream : PMT.getStreams())
+    {
+      Listed.push_back(Stream.PID);
+      uint16_t SlotIdx = m_SlotIdx[Stream.PID];
+      if(SlotIdx == 0) SlotIdx = xAddSlot(Stream.PID);
+      if(xPSI_PMT::isPES(Stream.StreamType)) m_Slots[SlotIdx - 1].ES = true;
+    }
+  }
+  xUpdateReferences(Slot, std::move(Listed));
+  return false;
+}
+
+/**
+ * @brief Replaces the PIDs a PAT/PMT section lists - PIDs no longer listed by any table stop their timers
+ */
+void xTS_TR101290Monitor::xUpdateReferences(xPIDSlot& Slot, std::vector<uint16_t>&& Listed)
+{
+  for(uint16_t PID : Listed)
+  {
+    uint16_t SlotIdx = m_SlotIdx[PID];
+    if(SlotIdx == 0) SlotIdx = xAddSlot(PID);
+    xPIDSlot& Referenced = m_Slots[SlotIdx - 1];
+    if(Referenced.RefCount++ == 0 && Referenced.ES) xArm(Referenced.Occurrence, xTS_TR101290::PID_Interval);
+  }
+  for(uint16_t PID : Slot.Listed)
+  {
+    xPIDSlot& Referenced = m_Slots[m_SlotIdx[PID] - 1];
+    if(--Referenced.RefCount > 0) continue;
+    Referenced.Occurrence.Last = NotArmed;
+    Referenced.ES              = false;
+    if(Referenced.PMT) { Referenced.PMT = false; Referenced.Section.Last = NotArmed; }
+  }
+  Slot.Listed = std::move(Listed);
+}
+
+/**
+ * @brief Periodic check of all timers (tables or PIDs which stopped completely) and report windows
+ */
+void xTS_TR101290Monitor::xSweep()
+{
+  if(!xIsRunning()) { m_NextCheckOffset = UINT64_MAX; return; }
+  if(m_Now >= m_NextCheck)
+  {
+    for(xPIDSlot& Slot : m_Slots)
+    {
+      xCheck(Slot.Section,    Slot.SectionIndicator);
+      xCheck(Slot.Occurrence, eIndicator::PID);
+      xCheck(Slot.PCR,        eIndicator::PCR_Repetition);
+      xCheck(Slot.PTS,        eIndicator::PTS);
+
+      // 3.4 - PID other than PSI/SI not listed in any table
+      if(Slot.PID > 0x1F && Slot.RefCount == 0 && !Slot.Reported)
+      {
+        if(Slot.FirstSeen == NotArmed)                                                   Slot.FirstSeen = m_Now;
+        else if(m_Now - Slot.FirstSeen > xTicks(xTS_TR101290::UnreferencedInterval)) { xCount(eIndicator::UnreferencedPID); Slot.Reported = true; }
+      }
+    }
+    while(m_Now >= m_WindowStart + m_Window)
+    {
+      xWriteWindow();
+      m_WindowStart += m_Window;
+    }
+    m_NextCheck = m_Now + xTicks(xTS_TR101290::CheckInterval);
+  }
+  m_NextCheckOffset = m_RefOffset + static_cast<uint64_t>(static_cast<double>(m_NextCheck > m_RefTime ? m_NextCheck - m_RefTime : 0) / m_TicksPerByte);
+}
+
+void xTS_TR101290Monitor::xWriteWindow()
+{
+  m_NumWindows++;
+  if(m_File != nullptr)
+  {
+    std::fprintf(m_File, "%.3f", static_cast<double>(m_WindowStart) / xTS::ExtendedClockFrequency_Hz);
+    for(uint32_t Idx = 0; Idx < xTS_TR101290::NumIndicators; Idx++) std::fprintf(m_File, " %u", m_Counts[Idx]);
+    std::fprintf(m_File, "\n");
+  }
+  memset(m_Counts, 0, sizeof(m_Counts));
+}
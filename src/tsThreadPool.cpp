@@ -0,0 +1,68 @@
+/**
+ * @file tsThreadPool.cpp
+ * @brief Implementation of the worker thread pool
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsThreadPool.h"
+#include <algorithm>
+
+//=============================================================================================================================================================================
+// xTS_ThreadPool Implementation
+//=============================================================================================================================================================================
+
+xTS_ThreadPool::xTS_ThreadPool(uint32_t NumThreads)
+  : m_Stop(false)
+{
+  NumThreads = std::max<uint32_t>(NumThreads, 1);
+  for(uint32_t Idx = 0; Idx < NumThreads; Idx++)
+  {
+    m_Threads.emplace_back(&xTS_ThreadPool::xWorkerLoop, this);
+  }
+}
+
+xTS_ThreadPool::~xTS_ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Stop = true;
+  }
+  m_Condition.notify_all();
+  for(std::thread& Thread : m_Threads) { Thread.join(); }
+}
+
+std::future<void> xTS_ThreadPool::Submit(std::function<void()> Task)
+{
+  std::packaged_task<void()> PackagedTask(std::move(Task));
+  std::future<void>          Future = PackagedTask.get_future();
+  {
+    std::lock_guard<std::mutex> Lock(m_Mutex);
+    m_Tasks.push_back(std::move(PackagedTask));
+  }
+  m_Condition.notify_one();
+  return Future;
+}
+
+uint32_t xTS_ThreadPool::getNumHardwareThreads()
+{
+  return std::max<uint32_t>(std::thread::hardware_concurrency(), 1);
+}
+
+void xTS_ThreadPool::xWorkerLoop()
+{
+  std::unique_lock<std::mutex> Lock(m_Mutex);
+  for(;;)
+  {
+    m_Condition.wait(Lock, [this]() { return m_Stop || !m_Tasks.empty(); });
+    if(m_Tasks.empty()) return; // stopped and drained
+
+    std::packaged_task<void()> Task = std::move(m_Tasks.front());
+    m_Tasks.pop_front();
+    Lock.unlock();
+    Task();
+    Lock.lock();
+  }
+}
@@ -0,0 +1,157 @@
+/**
+ * @file tsTimeIndex.cpp
+ * @brief Implementation of the PCR time index sidecar
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsTimeIndex.h"
+#include <cstring>
+
+//=============================================================================================================================================================================
+// xTS_TimeIndexWriter Implementation
+//=============================================================================================================================================================================
+
+xTS_TimeIndexWriter::xTS_TimeIndexWriter()
+  : m_File(nullptr)
+  , m_Interval(0)
+  , m_IntervalTicks(0)
+  , m_NumFlushed(0)
+{
+}
+
+xTS_TimeIndexWriter::~xTS_TimeIndexWriter()
+{
+  Close();
+}
+
+bool xTS_TimeIndexWriter::Open(const char* FileName, uint32_t Interval, int32_t PCR_PID)
+{
+  Close();
+  m_File = std::fopen(FileName, "wb");
+  if(m_File == nullptr) return false;
+
+  m_Timeline.Reset(PCR_PID);
+  m_Interval      = Interval;
+  m_IntervalTicks = static_cast<uint64_t>(Interval) * xTS_TimeIndex::ClockRate / 1000;
+  m_Entries.clear();
+  m_NumFlushed = 0;
+  return Flush();
+}
+
+bool xTS_TimeIndexWriter::Close()
+{
+  if(m_File == nullptr) return true;
+  bool Written = Flush();
+  Written = std::fclose(m_File) == 0 && Written;
+  m_File  = nullptr;
+  return Written;
+}
+
+/**
+ * @brief Appends the new entries, then rewrites the header with the new number of entries
+ */
+bool xTS_TimeIndexWriter::Flush()
+{
+  if(m_File == nullptr) return false;
+
+  bool Written = std::fseek(m_File, static_cast<long>(sizeof(xTS_TimeIndex::xFileHeader) + m_NumFlushed * sizeof(xTS_TimeIndex::xEntry)), SEEK_SET) == 0;
+  if(Written && m_Entries.size() > m_NumFlushed)
+  {
+    const size_t NumNew = m_Entries.size() - m_NumFlushed;
+    Written = std::fwrite(m_Entries.data() + m_NumFlushed, sizeof(xTS_TimeIndex::xEntry), NumNew, m_File) == NumNew;
+  }
+  if(Written) m_NumFlushed = m_Entries.size();
+
+  xTS_TimeIndex::xFileHeader Header;
+  memset(&Header, 0, sizeof(Header));
+  memcpy(Header.Magic, xTS_TimeIndex::Magic, sizeof(Header.Magic));
+  Header.Version    = xTS_TimeIndex::Version;
+  Header.EntrySize  = sizeof(xTS_TimeIndex::xEntry);
+  Header.PCR_PID    = static_cast<uint32_t>(m_Timeline.getPID()); // 0xFFFFFFFF if no PCR was seen
+  Header.Interval   = m_Interval;
+  Header.NumEntries = m_NumFlushed;
+
+  Written = std::fseek(m_File, 0, SEEK_SET) == 0 && std::fwrite(&Header, sizeof(Header), 1, m_File) == 1 && Written;
+  return std::fflush(m_File) == 0 && Written;
+}
+
+/**
+ * @brief Keeps one entry per interval
+ */
+void xTS_TimeIndexWriter::xAddEntry(uint64_t Time, uint64_t Offset)
+{
+  if(m_Entries.empty() || Time >= m_Entries.back().Time + m_IntervalTicks)
+  {
+    m_Entries.push_back(xTS_TimeIndex::xEntry{ Time, Offset });
+  }
+}
+
+//=============================================================================================================================================================================
+// xTS_TimeIndexReader Implementation
+//=============================================================================================================================================================================
+
+xTS_TimeIndexReader::xTS_TimeIndexReader()
+  : m_Entries(nullptr)
+  , m_NumEntries(0)
+  , m_PCR_PID(0)
+  , m_Interval(0)
+{
+}
+
+bool xTS_TimeIndexReader::Open(const char* FileName)
+{
+  Close();
+  if(!m_File.Open(FileName, sizeof(xTS_TimeIndex::xFileHeader))) return false;
+
+  xTS_TimeIndex::xFileHeader Header;
+  memcpy(&Header, m_File.getData(), sizeof(Header));
+  const bool Valid = memcmp(Header.Magic, xTS_TimeIndex::Magic, sizeof(Header.Magic)) == 0 &&
+                     Header.Version   == xTS_TimeIndex::Version &&
+                     Header.EntrySize == sizeof(xTS_TimeIndex::xEntry) &&
+                     Header.NumEntries <= (m_File.getSize() - sizeof(Header)) / sizeof(xTS_TimeIndex::xEntry); // entries may be appended ahead of the header update
+  if(!Valid) { Close(); return false; }
+
+  m_Entries    = reinterpret_cast<const xTS_TimeIndex::xEntry*>(m_File.getData() + sizeof(Header));
+  m_NumEntries = Header.NumEntries;
+  m_PCR_PID    = Header.PCR_PID;
+  m_Interval   = Header.Interval;
+  return true;
+}
+
+void xTS_TimeIndexReader::Close()
+{
+  m_File.Close();
+  m_Entries    = nullptr;
+  m_NumEntries = 0;
+  m_PCR_PID    = 0;
+  m_Interval   = 0;
+}
+
+uint64_t xTS_TimeIndexReader::FindStartOffset(uint64_t Time) const
+{
+  const uint64_t EntryIdx = xUpperBound(Time);
+  return EntryIdx ? m_Entries[EntryIdx - 1].Offset : 0;
+}
+
+uint64_t xTS_TimeIndexReader::FindEndOffset(uint64_t Time) const
+{
+  const uint64_t EntryIdx = xUpperBound(Time);
+  return EntryIdx < m_NumEntries ? m_Entries[EntryIdx].Offset : UINT64_MAX;
+}
+
+uint64_t xTS_TimeIndexReader::xUpperBound(uint64_t Time) const
+{
+  if(m_NumEntries == 0) return 0;
+  const uint64_t Absolute = m_Entries[0].Time + Time;
+  uint64_t Low = 0, High = m_NumEntries;
+  while(Low < High)
+  {
+    const uint64_t Mid = Low + (High - Low) / 2;
+    if(m_Entries[Mid].Time <= Absolute) Low  = Mid + 1;
+    else                                High = Mid;
+  }
+  return Low;
+}
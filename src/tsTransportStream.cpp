@@ -231,7 +231,7 @@ int32_t xTS_AdaptationField::Parse(const uint8_t* PacketBuffer, uint8_t Adaptati
       int currentOffset = 2; // Start parsing after flags byte
       
       // Parse Program Clock Reference (PCR) - 48 bits total
-      if (m_PR && m_Len >= currentOffset + 6) {
+      if (m_PR && m_Len + 1 >= currentOffset + 6) { // m_Len counts the bytes following the length byte
           // PCR_base: 33 bits = bytes 2-5 + upper 7 bits of byte 6
           // Format: [byte2][byte3][byte4][byte5][byte6_bits7-1][reserved][byte6_bit0 + byte7]
           m_PCR_base = ((uint64_t)PacketBuffer[currentOffset] << 25) |
@@ -248,7 +248,7 @@ int32_t xTS_AdaptationField::Parse(const uint8_t* PacketBuffer, uint8_t Adaptati
       }
       
       // Parse Original Program Clock Reference (OPCR) - same format as PCR
-      if (m_OR && m_Len >= currentOffset + 6) {
+      if (m_OR && m_Len + 1 >= currentOffset + 6) {
           // OPCR_base: 33 bits in same format as PCR_base
           m_OPCR_base = ((uint64_t)PacketBuffer[currentOffset] << 25) |
                         ((uint64_t)PacketBuffer[currentOffset + 1] << 17) |
@@ -0,0 +1,400 @@
+/**
+ * @file tsUdpInputSource.cpp
+ * @brief Implementation of the batched UDP/RTP receiver
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsUdpInputSource.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TS_HAS_SOCKETS 1
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <cerrno>
+#else
+#define TS_HAS_SOCKETS 0
+#endif
+
+#if TS_HAS_SOCKETS && defined(__linux__)
+#define TS_HAS_RECVMMSG 1
+#else
+#define TS_HAS_RECVMMSG 0
+#endif
+
+//=============================================================================================================================================================================
+// xTS_UdpInputSource Implementation
+//=============================================================================================================================================================================
+
+xTS_UdpInputSource::xTS_UdpInputSource(size_t BlockSize, uint32_t IdleTimeout, uint32_t RecvBufferSize, const char* Interface)
+  : m_BlockSize(std::max<size_t>(BlockSize, MaxDatagramSize))
+  , m_IdleTimeout(IdleTimeout)
+  , m_RecvBufferSize(RecvBufferSize)
+  , m_Interface(Interface)
+  , m_ForceRTP(false)
+  , m_Socket(-1)
+  , m_Buffer(nullptr)
+  , m_BufferSize(0)
+  , m_EndOfInput(false)
+  , m_HasSequence(false)
+  , m_NextSequence(0)
+  , m_ActualBufferSize(0)
+  , m_NumDatagrams(0)
+  , m_NumCalls(0)
+  , m_NumWaits(0)
+  , m_NumRTP(0)
+  , m_NumLost(0)
+  , m_NumReordered(0)
+  , m_NumInvalid(0)
+  , m_NumKernelDrops(0)
+{
+}
+
+xTS_UdpInputSource::~xTS_UdpInputSource()
+{
+  Close();
+}
+
+bool xTS_UdpInputSource::isSupported()
+{
+  return TS_HAS_SOCKETS != 0;
+}
+
+bool xTS_UdpInputSource::isURL(const char* FileName)
+{
+  return FileName && (strncmp(FileName, "udp://", 6) == 0 || strncmp(FileName, "rtp://", 6) == 0);
+}
+
+const char* xTS_UdpInputSource::getName() const
+{
+  if(m_ForceRTP) return TS_HAS_RECVMMSG ? "rtp+recvmmsg" : "rtp";
+  return TS_HAS_RECVMMSG ? "udp+recvmmsg" : "udp";
+}
+
+/**
+ * @brief Parses the input name, then creates and configures the socket
+ *
+ * The receive buffer is requested with SO_RCVBUFFORCE first (ignores net.core.rmem_max
+ * when privileged) and SO_RCVBUF otherwise; the size the kernel granted is kept for the
+ * statistics and a warning is printed when it is smaller than requested.
+ */
+bool xTS_UdpInputSource::Open(const char* FileName)
+{
+  Close();
+  if(!isURL(FileName)) return false;
+#if TS_HAS_SOCKETS
+  m_ForceRTP = strncmp(FileName, "rtp://", 6) == 0;
+
+  // [@][<address>]:<port>
+  const char* Address = FileName + 6;
+  if(*Address == '@') Address++;
+  const char* Colon = strrchr(Address, ':');
+  if(Colon == nullptr || Colon[1] == '\0')
+  {
+    printf("Error: UDP input %s has no port\n", FileName);
+    return false;
+  }
+  const std::string Host(Address, Colon);
+  const unsigned long Port = strtoul(Colon + 1, nullptr, 10);
+
+  sockaddr_in Local;
+  memset(&Local, 0, sizeof(Local));
+  Local.sin_family      = AF_INET;
+  Local.sin_port        = htons(static_cast<uint16_t>(Port));
+  Local.sin_addr.s_addr = htonl(INADDR_ANY);
+  if(Port == 0 || Port > 0xFFFF || (!Host.empty() && inet_pton(AF_INET, Host.c_str(), &Local.sin_addr) != 1))
+  {
+    printf("Error: UDP input %s is not <IPv4 address>:<port>\n", FileName);
+    return false;
+  }
+  const bool Multicast = IN_MULTICAST(ntohl(Local.sin_addr.s_addr));
+
+  m_Socket = socket(AF_INET, SOCK_DGRAM, 0);
+  if(m_Socket < 0) return false;
+
+  // Several receivers may listen to the same group
+  int Enable = 1;
+  setsockopt(m_Socket, SOL_SOCKET, SO_REUSEADDR, &Enable, sizeof(Enable));
+#if defined(SO_RXQ_OVFL)
+  setsockopt(m_Socket, SOL_SOCKET, SO_RXQ_OVFL, &Enable, sizeof(Enable));
+#endif
+
+  int Size = static_cast<int>(std::min<uint32_t>(m_RecvBufferSize, INT32_MAX));
+  bool Sized = false;
+#if defined(SO_RCVBUFFORCE)
+  Sized = setsockopt(m_Socket, SOL_SOCKET, SO_RCVBUFFORCE, &Size, sizeof(Size)) == 0;
+#endif
+  if(!Sized) setsockopt(m_Socket, SOL_SOCKET, SO_RCVBUF, &Size, sizeof(Size));
+  int Actual = 0;
+  socklen_t ActualLength = sizeof(Actual);
+  getsockopt(m_Socket, SOL_SOCKET, SO_RCVBUF, &Actual, &ActualLength);
+  m_ActualBufferSize = static_cast<uint32_t>(std::max(Actual, 0));
+  if(m_ActualBufferSize < m_RecvBufferSize)
+  {
+    printf("Warning: socket receive buffer is %u bytes (requested %u), raise net.core.rmem_max\n", m_ActualBufferSize, m_RecvBufferSize);
+  }
+
+  if(bind(m_Socket, reinterpret_cast<const sockaddr*>(&Local), sizeof(Local)) != 0)
+  {
+    printf("Error: Could not bind %s (%s)\n", FileName, strerror(errno));
+    Close();
+    return false;
+  }
+
+  if(Multicast)
+  {
+    ip_mreq Membership;
+    memset(&Membership, 0, sizeof(Membership));
+    Membership.imr_multiaddr        = Local.sin_addr;
+    Membership.imr_interface.s_addr = htonl(INADDR_ANY);
+    if(m_Interface && inet_pton(AF_INET, m_Interface, &Membership.imr_interface) != 1)
+    {
+      printf("Error: Interface %s is not an IPv4 address\n", m_Interface);
+      Close();
+      return false;
+    }
+    if(setsockopt(m_Socket, IPPROTO_IP, IP_ADD_MEMBERSHIP, &Membership, sizeof(Membership)) != 0)
+    {
+      printf("Error: Could not join multicast group %s (%s)\n", Host.c_str(), strerror(errno));
+      Close();
+      return false;
+    }
+  }
+
+  m_BufferSize = m_BlockSize + BatchSize * MaxDatagramSize;
+  m_BufferRef.reset(new uint8_t[m_BufferSize], std::default_delete<uint8_t[]>());
+  m_Buffer       = m_BufferRef.get();
+  m_Data         = m_Buffer;
+  m_Available    = 0;
+  m_Position     = 0;
+  m_EndOfInput   = false;
+  m_HasSequence  = false;
+  m_NextSequence = 0;
+  m_Lengths.assign(BatchSize, 0);
+  m_Truncated.assign(BatchSize, 0);
+  m_NumDatagrams = m_NumCalls = m_NumWaits = m_NumRTP = m_NumLost = m_NumReordered = m_NumInvalid = m_NumKernelDrops = 0;
+  return true;
+#else
+  printf("Error: UDP input is not supported on this platform\n");
+  return false;
+#endif
+}
+
+void xTS_UdpInputSource::Close()
+{
+#if TS_HAS_SOCKETS
+  if(m_Socket >= 0)
+  {
+    close(m_Socket);
+    m_Socket = -1;
+  }
+#endif
+  m_BufferRef.reset();
+  m_Buffer    = nullptr;
+  m_Data      = nullptr;
+  m_Available = 0;
+}
+
+/**
+ * @brief Receives batches of datagrams until MinBytes stream bytes are available
+ *
+ * Unconsumed bytes are moved to the start of the buffer first (into a fresh buffer if
+ * the old one is still referenced). Every batch lands in the slots behind the stream
+ * data; each payload is then moved down to the end of the stream data, dropping RTP
+ * headers and padding on the way.
+ *
+ * @param MinBytes Minimal number of contiguous bytes requested (clamped to the block size)
+ * @return Number of bytes available after the call (fewer than MinBytes once receiving stopped)
+ */
+size_t xTS_UdpInputSource::Request(size_t MinBytes)
+{
+  if(m_Socket < 0) return 0;
+  MinBytes = std::min(MinBytes, m_BlockSize);
+  if(m_Available >= MinBytes || m_EndOfInput) return m_Available;
+
+  // Consumed bytes are still referenced - continue in a fresh buffer
+  if(m_Data != m_Buffer && m_BufferRef.use_count() > 1)
+  {
+    std::shared_ptr<uint8_t> Fresh(new uint8_t[m_BufferSize], std::default_delete<uint8_t[]>());
+    if(m_Available > 0) std::memcpy(Fresh.get(), m_Data, m_Available);
+    m_BufferRef = Fresh;
+    m_Buffer    = Fresh.get();
+    m_Data      = m_Buffer;
+  }
+  if(m_Data != m_Buffer && m_Available > 0)
+  {
+    std::memmove(m_Buffer, m_Data, m_Available);
+  }
+  m_Data = m_Buffer;
+
+  while(m_Available < MinBytes)
+  {
+    uint8_t* Slots = m_Buffer + m_Available;
+    const uint32_t NumReceived = xReceiveBatch(Slots);
+    if(NumReceived == 0)
+    {
+      if(!xWaitForData()) { m_EndOfInput = true; break; }
+      continue;
+    }
+
+    for(uint32_t Idx = 0; Idx < NumReceived; Idx++)
+    {
+      const uint8_t* Datagram = Slots + Idx * MaxDatagramSize;
+      size_t Payload = 0;
+      const size_t PayloadLength = m_Truncated[Idx] ? 0 : xStripRTP(Datagram, m_Lengths[Idx], Payload);
+      if(PayloadLength == 0) { m_NumInvalid++; continue; }
+      // payloads only move towards the buffer start - each slot adds at most one slot of stream data
+      if(m_Buffer + m_Available != Datagram + Payload) std::memmove(m_Buffer + m_Available, Datagram + Payload, PayloadLength);
+      m_Available += PayloadLength;
+    }
+    m_NumDatagrams += NumReceived;
+    m_NumCalls++;
+  }
+  return m_Available;
+}
+
+/**
+ * @brief Receives up to BatchSize pending datagrams without blocking
+ *
+ * With recvmmsg() the whole batch is a single system call; the SO_RXQ_OVFL control
+ * message carries the number of datagrams the kernel dropped on this socket so far.
+ */
+uint32_t xTS_UdpInputSource::xReceiveBatch(uint8_t* Slots)
+{
+#if TS_HAS_RECVMMSG
+  mmsghdr Messages[BatchSize];
+  iovec   Vectors [BatchSize];
+  alignas(cmsghdr) uint8_t Controls[BatchSize][CMSG_SPACE(sizeof(uint32_t))];
+  for(uint32_t Idx = 0; Idx < BatchSize; Idx++)
+  {
+    Vectors[Idx].iov_base = Slots + Idx * MaxDatagramSize;
+    Vectors[Idx].iov_len  = MaxDatagramSize;
+    memset(&Messages[Idx], 0, sizeof(mmsghdr));
+    Messages[Idx].msg_hdr.msg_iov        = &Vectors[Idx];
+    Messages[Idx].msg_hdr.msg_iovlen     = 1;
+    Messages[Idx].msg_hdr.msg_control    = Controls[Idx];
+    Messages[Idx].msg_hdr.msg_controllen = sizeof(Controls[Idx]);
+  }
+
+  const int NumReceived = recvmmsg(m_Socket, Messages, BatchSize, MSG_DONTWAIT, nullptr);
+  if(NumReceived <= 0) return 0;
+
+  for(int Idx = 0; Idx < NumReceived; Idx++)
+  {
+    m_Lengths  [Idx] = Messages[Idx].msg_len;
+    m_Truncated[Idx] = (Messages[Idx].msg_hdr.msg_flags & MSG_TRUNC) != 0;
+#if defined(SO_RXQ_OVFL)
+    for(cmsghdr* Control = CMSG_FIRSTHDR(&Messages[Idx].msg_hdr); Control; Control = CMSG_NXTHDR(&Messages[Idx].msg_hdr, Control))
+    {
+      if(Control->cmsg_level != SOL_SOCKET || Control->cmsg_type != SO_RXQ_OVFL) continue;
+      uint32_t Drops;
+      memcpy(&Drops, CMSG_DATA(Control), sizeof(Drops));
+      m_NumKernelDrops = Drops;
+    }
+#endif
+  }
+  return static_cast<uint32_t>(NumReceived);
+#elif TS_HAS_SOCKETS
+  uint32_t NumReceived = 0;
+  for(; NumReceived < BatchSize; NumReceived++)
+  {
+    const ssize_t Length = recv(m_Socket, Slots + NumReceived * MaxDatagramSize, MaxDatagramSize, MSG_DONTWAIT | MSG_TRUNC);
+    if(Length < 0) break;
+    m_Lengths  [NumReceived] = static_cast<uint32_t>(std::min<size_t>(static_cast<size_t>(Length), MaxDatagramSize));
+    m_Truncated[NumReceived] = static_cast<size_t>(Length) > MaxDatagramSize;
+  }
+  return NumReceived;
+#else
+  (void)Slots;
+  return 0;
+#endif
+}
+
+/**
+ * @brief Finds the TS payload behind an RTP header (12 bytes, CSRC list, extension, padding)
+ *
+ * udp:// inputs treat datagrams starting with the sync byte as raw TS and anything with
+ * RTP version 2 as RTP. A sequence number ahead of the expected one counts the skipped
+ * numbers as lost; one behind it (late arrival) counts as reordered and corrects the loss.
+ */
+size_t xTS_UdpInputSource::xStripRTP(const uint8_t* Datagram, size_t Length, size_t& Payload)
+{
+  Payload = 0;
+  if(Length == 0) return 0;
+  if(!m_ForceRTP && Datagram[0] == 0x47) return Length;
+  if(Length < RTP_HeaderLength || (Datagram[0] >> 6) != 2) return 0;
+
+  const uint32_t NumCSRC   = Datagram[0] & 0x0F;
+  const bool     Padding   = (Datagram[0] & 0x20) != 0;
+  const bool     Extension = (Datagram[0] & 0x10) != 0;
+  size_t HeaderLength = RTP_HeaderLength + 4 * NumCSRC;
+  if(Extension)
+  {
+    if(Length < HeaderLength + 4) return 0;
+    HeaderLength += 4 + 4 * static_cast<size_t>((Datagram[HeaderLength + 2] << 8) | Datagram[HeaderLength + 3]);
+  }
+  const size_t PaddingLength = Padding ? Datagram[Length - 1] : 0;
+  if(HeaderLength + PaddingLength >= Length) return 0;
+
+  const uint16_t Sequence = static_cast<uint16_t>((Datagram[2] << 8) | Datagram[3]);
+  if(m_HasSequence && Sequence != m_NextSequence)
+  {
+    const uint16_t Ahead = static_cast<uint16_t>(Sequence - m_NextSequence);
+    if(Ahead < 0x8000)
+    {
+      m_NumLost += Ahead;
+      m_NextSequence = static_cast<uint16_t>(Sequence + 1);
+    }
+    else
+    {
+      m_NumReordered++;
+      if(m_NumLost) m_NumLost--;
+    }
+  }
+  else
+  {
+    m_NextSequence = static_cast<uint16_t>(Sequence + 1);
+  }
+  m_HasSequence = true;
+  m_NumRTP++;
+
+  Payload = HeaderLength;
+  return Length - HeaderLength - PaddingLength;
+}
+
+/**
+ * @brief Waits until a datagram is readable
+ *
+ * The idle callback runs only once the socket stayed silent for a whole PollInterval, so
+ * the gaps between the datagrams of a paced stream do not flush the output every time.
+ */
+bool xTS_UdpInputSource::xWaitForData()
+{
+  m_NumWaits++;
+
+  const auto IdleStart = std::chrono::steady_clock::now();
+  bool       Notified  = false;
+  for(;;)
+  {
+    if(isStopRequested()) return false;
+    if(m_IdleTimeout && std::chrono::steady_clock::now() - IdleStart >= std::chrono::seconds(m_IdleTimeout)) return false;
+#if TS_HAS_SOCKETS
+    pollfd PollFd = { m_Socket, POLLIN, 0 };
+    const int Result = poll(&PollFd, 1, PollInterval);
+    if(Result > 0) return true;
+    if(Result < 0 && errno != EINTR) return false;
+    if(Result == 0 && !Notified && m_IdleCallback) { m_IdleCallback(); Notified = true; }
+#else
+    return false;
+#endif
+  }
+}
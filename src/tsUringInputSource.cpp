@@ -0,0 +1,487 @@
+/**
+ * @file tsUringInputSource.cpp
+ * @brief Implementation of the io_uring based asynchronous block reader
+ *
+ * The submission and completion rings are mapped and driven directly via the raw
+ * io_uring system calls. Reads are submitted as IORING_OP_READV (available since the
+ * very first io_uring kernels) with one iovec per queue slot.
+ *
+ * @author Bartosz Berezowski
+ * @date 2025
+ * @version 1.0
+ */
+
+#include "../include/tsUringInputSource.h"
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define TS_HAS_URING 1
+#endif
+#endif
+#ifndef TS_HAS_URING
+#define TS_HAS_URING 0
+#endif
+
+#if TS_HAS_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
+static inline int xSysUringSetup(uint32_t Entries, io_uring_params* Params)
+{
+  return static_cast<int>(syscall(__NR_io_uring_setup, Entries, Params));
+}
+
+static inline int xSysUringEnter(int RingFd, uint32_t ToSubmit, uint32_t MinComplete, uint32_t Flags)
+{
+  return static_cast<int>(syscall(__NR_io_uring_enter, RingFd, ToSubmit, MinComplete, Flags, nullptr, 0));
+}
+#endif
+
+//=============================================================================================================================================================================
+// xTS_UringInputSource Implementation
+//=============================================================================================================================================================================
+
+xTS_UringInputSource::xTS_UringInputSource(size_t BlockSize, uint32_t QueueDepth, bool DirectIO)
+  : m_BlockSize(std::max<size_t>((BlockSize + 4095) & ~static_cast<size_t>(4095), 4096)) // page multiple (O_DIRECT)
+  , m_QueueDepth(std::max<uint32_t>(QueueDepth, 2))
+  , m_DirectIO(DirectIO)
+  , m_FileDescriptor(-1)
+  , m_FileSize(0)
+  , m_NextReadOffset(0)
+  , m_RingFd(-1)
+  , m_SQ_Ring(nullptr), m_SQ_RingSize(0)
+  , m_CQ_Ring(nullptr), m_CQ_RingSize(0)
+  , m_SQEs(nullptr), m_SQEsSize(0)
+  , m_SQ_Head(nullptr), m_SQ_Tail(nullptr), m_SQ_Mask(nullptr), m_SQ_Array(nullptr)
+  , m_CQ_Head(nullptr), m_CQ_Tail(nullptr), m_CQ_Mask(nullptr), m_CQEs(nullptr)
+  , m_NumToSubmit(0)
+  , m_CurrentSlot(0)
+  , m_Started(false)
+  , m_EndOfInput(false)
+  , m_NumReads(0)
+  , m_NumWaits(0)
+{
+}
+
+xTS_UringInputSource::~xTS_UringInputSource()
+{
+  Close();
+}
+
+/**
+ * @brief Checks whether io_uring is usable
+ *
+ * Kernels without io_uring return ENOSYS and container runtimes commonly block the
+ * system call with EPERM. The probe creates (and immediately closes) a tiny ring
+ * the first time it is called; the result is cached.
+ *
+ * @return True when an io_uring instance can be created
+ */
+bool xTS_UringInputSource::isSupported()
+{
+#if TS_HAS_URING
+  static const bool Supported = []()
+  {
+    io_uring_params Params;
+    memset(&Params, 0, sizeof(Params));
+    int RingFd = xSysUringSetup(2, &Params);
+    if(RingFd < 0) return false;
+    close(RingFd);
+    return true;
+  }();
+  return Supported;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Opens the file, creates the ring and queues the first QueueDepth reads
+ *
+ * @param FileName Path of a regular file
+ * @return True on success
+ */
+bool xTS_UringInputSource::Open(const char* FileName)
+{
+  Close();
+#if TS_HAS_URING
+  int Flags = O_RDONLY;
+#if defined(O_DIRECT)
+  if(m_DirectIO) Flags |= O_DIRECT;
+#endif
+  m_FileDescriptor = ::open(FileName, Flags);
+  if(m_FileDescriptor < 0) return false;
+
+  struct stat Status;
+  if(fstat(m_FileDescriptor, &Status) != 0 || (Status.st_mode & S_IFMT) != S_IFREG || !xSetupRing())
+  {
+    Close();
+    return false;
+  }
+  m_FileSize = static_cast<uint64_t>(Status.st_size);
+#if defined(POSIX_FADV_SEQUENTIAL)
+  if(!m_DirectIO) posix_fadvise(m_FileDescriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+  m_Slots.resize(m_QueueDepth);
+  for(uint32_t SlotIdx = 0; SlotIdx < m_QueueDepth; SlotIdx++)
+  {
+    if(!xAllocateBuffer(SlotIdx))
+    {
+      Close();
+      return false;
+    }
+    xSlot& Slot = m_Slots[SlotIdx];
+    Slot.FileOffset = 0;
+    Slot.Result     = 0;
+    Slot.Pending    = false;
+    Slot.Used       = false;
+  }
+
+  m_NextReadOffset = 0;
+  m_CurrentSlot    = 0;
+  m_Started        = false;
+  m_EndOfInput     = false;
+  m_Data           = nullptr;
+  m_Available      = 0;
+  m_Position       = 0;
+  m_NumReads       = 0;
+  m_NumWaits       = 0;
+
+  for(uint32_t SlotIdx = 0; SlotIdx < m_QueueDepth; SlotIdx++) { xSubmitRead(SlotIdx); }
+  if(!xFlushSubmissions(0))
+  {
+    Close();
+    return false;
+  }
+  return true;
+#else
+  (void)FileName;
+  return false;
+#endif
+}
+
+/**
+ * @brief Waits for outstanding reads, destroys the ring and releases all buffers
+ */
+void xTS_UringInputSource::Close()
+{
+#if TS_HAS_URING
+  // Buffers may still be written by the kernel - drain all pending reads first
+  if(m_RingFd >= 0)
+  {
+    xReapCompletions();
+    while(std::any_of(m_Slots.begin(), m_Slots.end(), [](const xSlot& Slot) { return Slot.Pending; }))
+    {
+      if(!xFlushSubmissions(1)) break;
+      xReapCompletions();
+    }
+  }
+  xDestroyRing();
+  m_Slots.clear(); // buffers are freed once no block reference is held any more
+  if(m_FileDescriptor >= 0)
+  {
+    ::close(m_FileDescriptor);
+    m_FileDescriptor = -1;
+  }
+#endif
+  m_Data      = nullptr;
+  m_Available = 0;
+  m_FileSize  = 0;
+}
+
+/**
+ * @brief Moves the window to the next completed block
+ *
+ * When fewer than MinBytes remain in the current block, the unconsumed tail is copied
+ * into the head room of the next block (in file order), the next block is awaited and
+ * the now free current slot is resubmitted for the next file offset.
+ *
+ * @param MinBytes Minimal number of contiguous bytes requested (clamped to BlockSize)
+ * @return Number of bytes available after the call
+ */
+size_t xTS_UringInputSource::Request(size_t MinBytes)
+{
+#if TS_HAS_URING
+  if(m_RingFd < 0) return 0;
+  if(MinBytes > m_BlockSize) MinBytes = m_BlockSize;
+  if(m_Started && (m_Available >= MinBytes || m_EndOfInput)) return m_Available;
+
+  while(!m_EndOfInput && m_Available < MinBytes)
+  {
+    uint32_t NextSlot = m_Started ? (m_CurrentSlot + 1) % m_QueueDepth : 0;
+    xSlot&   Next     = m_Slots[NextSlot];
+
+    if(!Next.Used || !xWaitForSlot(NextSlot) || Next.Result <= 0)
+    {
+      // No further data (end of file or read error)
+      if(Next.Used && Next.Result < 0)
+      {
+        printf("Error: io_uring read at offset %" PRIu64 " failed: %s\n", Next.FileOffset, strerror(-Next.Result));
+      }
+      m_EndOfInput = true;
+      break;
+    }
+
+    // Prepend unconsumed tail of the current block to the next block
+    uint8_t* ReadArea = Next.Buffer + m_BlockSize;
+    uint8_t* NewData  = ReadArea - m_Available;
+    if(m_Available > 0) memcpy(NewData, m_Data, m_Available);
+
+    // Current slot is free now - queue the next read into it (into a fresh buffer if the old one is still referenced)
+    if(m_Started)
+    {
+      if(m_Slots[m_CurrentSlot].BufferRef.use_count() == 1 || xAllocateBuffer(m_CurrentSlot)) xSubmitRead(m_CurrentSlot);
+      else m_Slots[m_CurrentSlot].Used = false;
+    }
+
+    m_CurrentSlot = NextSlot;
+    m_Started     = true;
+    m_Data        = NewData;
+    m_Available  += static_cast<size_t>(Next.Result);
+    Next.Used     = false;
+
+    xFlushSubmissions(0);
+  }
+  return m_Available;
+#else
+  (void)MinBytes;
+  return 0;
+#endif
+}
+
+//=============================================================================================================================================================================
+
+/**
+ * @brief Creates the io_uring instance and maps its rings
+ * @return True on success
+ */
+bool xTS_UringInputSource::xSetupRing()
+{
+#if TS_HAS_URING
+  io_uring_params Params;
+  memset(&Params, 0, sizeof(Params));
+  m_RingFd = xSysUringSetup(m_QueueDepth, &Params);
+  if(m_RingFd < 0) return false;
+
+  m_SQ_RingSize = Params.sq_off.array + Params.sq_entries * sizeof(uint32_t);
+  m_CQ_RingSize = Params.cq_off.cqes  + Params.cq_entries * sizeof(io_uring_cqe);
+  const bool SingleMmap = (Params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if(SingleMmap) { m_SQ_RingSize = m_CQ_RingSize = std::max(m_SQ_RingSize, m_CQ_RingSize); }
+
+  m_SQ_Ring = mmap(nullptr, m_SQ_RingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQ_RING);
+  if(m_SQ_Ring == MAP_FAILED) { m_SQ_Ring = nullptr; xDestroyRing(); return false; }
+
+  if(SingleMmap)
+  {
+    m_CQ_Ring = m_SQ_Ring;
+  }
+  else
+  {
+    m_CQ_Ring = mmap(nullptr, m_CQ_RingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_CQ_RING);
+    if(m_CQ_Ring == MAP_FAILED) { m_CQ_Ring = nullptr; xDestroyRing(); return false; }
+  }
+
+  m_SQEsSize = Params.sq_entries * sizeof(io_uring_sqe);
+  m_SQEs = mmap(nullptr, m_SQEsSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, IORING_OFF_SQES);
+  if(m_SQEs == MAP_FAILED) { m_SQEs = nullptr; xDestroyRing(); return false; }
+
+  uint8_t* SQ = static_cast<uint8_t*>(m_SQ_Ring);
+  uint8_t* CQ = static_cast<uint8_t*>(m_CQ_Ring);
+  m_SQ_Head  = reinterpret_cast<uint32_t*>(SQ + Params.sq_off.head        );
+  m_SQ_Tail  = reinterpret_cast<uint32_t*>(SQ + Params.sq_off.tail        );
+  m_SQ_Mask  = reinterpret_cast<uint32_t*>(SQ + Params.sq_off.ring_mask   );
+  m_SQ_Array = reinterpret_cast<uint32_t*>(SQ + Params.sq_off.array       );
+  m_CQ_Head  = reinterpret_cast<uint32_t*>(CQ + Params.cq_off.head        );
+  m_CQ_Tail  = reinterpret_cast<uint32_t*>(CQ + Params.cq_off.tail        );
+  m_CQ_Mask  = reinterpret_cast<uint32_t*>(CQ + Params.cq_off.ring_mask   );
+  m_CQEs     = CQ + Params.cq_off.cqes;
+  m_NumToSubmit = 0;
+  return true;
+#else
+  return false;
+#endif
+}
+
+/**
+ * @brief Unmaps the rings and closes the io_uring instance
+ */
+void xTS_UringInputSource::xDestroyRing()
+{
+#if TS_HAS_URING
+  if(m_SQEs) { munmap(m_SQEs, m_SQEsSize); m_SQEs = nullptr; }
+  if(m_CQ_Ring && m_CQ_Ring != m_SQ_Ring) { munmap(m_CQ_Ring, m_CQ_RingSize); }
+  m_CQ_Ring = nullptr;
+  if(m_SQ_Ring) { munmap(m_SQ_Ring, m_SQ_RingSize); m_SQ_Ring = nullptr; }
+  if(m_RingFd >= 0) { close(m_RingFd); m_RingFd = -1; }
+#endif
+}
+
+/**
+ * @brief Queues a read of the next block into the given slot
+ *
+ * Nothing is queued once the whole file has been requested; the slot is then left
+ * unused, which Request() interprets as end of input.
+ *
+ * @param SlotIdx Queue slot receiving the data
+ */
+void xTS_UringInputSource::xSubmitRead(uint32_t SlotIdx)
+{
+#if TS_HAS_URING
+  xSlot& Slot = m_Slots[SlotIdx];
+  if(m_NextReadOffset >= m_FileSize)
+  {
+    Slot.Used = false;
+    return;
+  }
+
+  Slot.FileOffset = m_NextReadOffset;
+  Slot.Result     = 0;
+  Slot.Pending    = true;
+  Slot.Used       = true;
+  m_NextReadOffset += m_BlockSize;
+
+  // The iovec lives in the first bytes of the slot head room, which is only written again
+  // (by the tail copy in Request()) after this read has completed
+  iovec* IoVec    = reinterpret_cast<iovec*>(Slot.Buffer);
+  IoVec->iov_base = Slot.Buffer + m_BlockSize;
+  IoVec->iov_len  = m_BlockSize;
+
+  const uint32_t Tail  = *m_SQ_Tail;
+  const uint32_t Index = Tail & *m_SQ_Mask;
+  io_uring_sqe*  SQE   = static_cast<io_uring_sqe*>(m_SQEs) + Index;
+  memset(SQE, 0, sizeof(*SQE));
+  SQE->opcode    = IORING_OP_READV;
+  SQE->fd        = m_FileDescriptor;
+  SQE->off       = Slot.FileOffset;
+  SQE->addr      = reinterpret_cast<uint64_t>(IoVec);
+  SQE->len       = 1;
+  SQE->user_data = SlotIdx;
+  m_SQ_Array[Index] = Index;
+  __atomic_store_n(m_SQ_Tail, Tail + 1, __ATOMIC_RELEASE);
+  m_NumToSubmit++;
+#else
+  (void)SlotIdx;
+#endif
+}
+
+/**
+ * @brief Passes queued submissions to the kernel and optionally waits for completions
+ * @param MinComplete Number of completions to wait for
+ * @return False on io_uring_enter failure
+ */
+bool xTS_UringInputSource::xFlushSubmissions(uint32_t MinComplete)
+{
+#if TS_HAS_URING
+  if(m_NumToSubmit == 0 && MinComplete == 0) return true;
+  for(;;)
+  {
+    int Result = xSysUringEnter(m_RingFd, m_NumToSubmit, MinComplete, MinComplete ? IORING_ENTER_GETEVENTS : 0);
+    if(Result >= 0)
+    {
+      m_NumToSubmit -= std::min<uint32_t>(m_NumToSubmit, static_cast<uint32_t>(Result));
+      return true;
+    }
+    if(errno != EINTR) return false;
+  }
+#else
+  (void)MinComplete;
+  return false;
+#endif
+}
+
+/**
+ * @brief Drains the completion queue into slot results
+ */
+void xTS_UringInputSource::xReapCompletions()
+{
+#if TS_HAS_URING
+  uint32_t Head = *m_CQ_Head;
+  const uint32_t Tail = __atomic_load_n(m_CQ_Tail, __ATOMIC_ACQUIRE);
+  while(Head != Tail)
+  {
+    const io_uring_cqe* CQE = static_cast<const io_uring_cqe*>(m_CQEs) + (Head & *m_CQ_Mask);
+    if(CQE->user_data < m_Slots.size())
+    {
+      xSlot& Slot  = m_Slots[CQE->user_data];
+      Slot.Result  = CQE->res;
+      Slot.Pending = false;
+      m_NumReads++;
+    }
+    Head++;
+  }
+  __atomic_store_n(m_CQ_Head, Head, __ATOMIC_RELEASE);
+#endif
+}
+
+/**
+ * @brief Blocks until the read of the given slot has completed
+ *
+ * A short read before the end of file (which regular files practically never produce)
+ * is completed synchronously with pread(), so every block except the last one is full.
+ *
+ * @param SlotIdx Queue slot to wait for
+ * @return False if the ring failed
+ */
+bool xTS_UringInputSource::xWaitForSlot(uint32_t SlotIdx)
+{
+#if TS_HAS_URING
+  xSlot& Slot = m_Slots[SlotIdx];
+  xReapCompletions();
+  if(Slot.Pending) m_NumWaits++;
+  while(Slot.Pending)
+  {
+    if(!xFlushSubmissions(1)) return false;
+    xReapCompletions();
+  }
+
+  uint64_t Expected = std::min<uint64_t>(m_BlockSize, m_FileSize - Slot.FileOffset);
+  while(Slot.Result > 0 && static_cast<uint64_t>(Slot.Result) < Expected)
+  {
+    ssize_t NumRead = pread(m_FileDescriptor, Slot.Buffer + m_BlockSize + Slot.Result,
+                            Expected - Slot.Result, Slot.FileOffset + Slot.Result);
+    if(NumRead <= 0) break;
+    Slot.Result += static_cast<int32_t>(NumRead);
+  }
+  return true;
+#else
+  (void)SlotIdx;
+  return false;
+#endif
+}
+
+/**
+ * @brief Gives the slot a new page aligned buffer
+ *
+ * The previous buffer (if any) stays alive as long as block references to it are held.
+ *
+ * @param SlotIdx Queue slot
+ * @return False if the allocation failed
+ */
+bool xTS_UringInputSource::xAllocateBuffer(uint32_t SlotIdx)
+{
+#if TS_HAS_URING
+  void* Buffer = nullptr;
+  if(posix_memalign(&Buffer, 4096, 2 * m_BlockSize) != 0)
+  {
+    printf("Error: Could not allocate io_uring block buffer (%zu bytes)\n", 2 * m_BlockSize);
+    return false;
+  }
+  xSlot& Slot    = m_Slots[SlotIdx];
+  Slot.Buffer    = static_cast<uint8_t*>(Buffer);
+  Slot.BufferRef = xBlockRef(Slot.Buffer, [](const uint8_t* Block) { free(const_cast<uint8_t*>(Block)); });
+  return true;
+#else
+  (void)SlotIdx;
+  return false;
+#endif
+}